@@ -26,13 +26,19 @@
   *                     or set to '\/', begin the gimbal calibration
   *                     or set to /''\, begin the chassis calibration
   *
-  *             data in flash, include cali data and name[3] and cali_flag
-  *             for example, head_cali has 8 bytes, and it need 12 bytes in flash. if it starts in 0x080A0000
-  *             0x080A0000-0x080A0007: head_cali data
-  *             0x080A0008: name[0]
-  *             0x080A0009: name[1]
-  *             0x080A000A: name[2]
-  *             0x080A000B: cali_flag, when cali_flag == 0x55, means head_cali has been calibrated.
+  *             data in flash, include a descriptor word, cali data and name[3] and cali_flag
+  *             for example, head_cali has 8 bytes, and it need 16 bytes in flash. if it starts in 0x080A0004
+  *             0x080A0004-0x080A0007: descriptor, data lenght, schema version and CALI_RECORD_TAG
+  *             0x080A0008-0x080A000F: head_cali data
+  *             0x080A0010: name[0]
+  *             0x080A0011: name[1]
+  *             0x080A0012: name[2]
+  *             0x080A0013: cali_flag, when cali_flag == 0x55, means head_cali has been calibrated.
+  *             the first word is CALI_IMAGE_MAGIC, the word after the last device is the CRC32 of all devices.
+  *             devices are found by name, so a new device does not move the others. when xxx_cali_t changes,
+  *             add 1 to its version and add a converter in cali_migrate_table, old records are upgraded at boot.
+  *             an image without CALI_IMAGE_MAGIC is read with the old fixed layout and rewritten.
+  *             the reading and upgrading are checked on the host with a fake flash: make -C tools/cali_check check
   *             if add a sensor
   *             1.add cail sensro name in cali_id_e at calibrate_task.h, like
   *             typedef enum
@@ -50,10 +56,11 @@
   *                 uint16_t yyy;
   *                 fp32 zzz;
   *             } xxx_cali_t; //size: 8 bytes, must be 4, 8, 12, 16...
-  *             3.in "FLASH_WRITE_BUF_LENGHT", add "sizeof(xxx_cali_t)", and implement new function.
+  *             3.implement new function.
   *             bool_t cali_xxx_hook(uint32_t *cali, bool_t cmd), and add the name in "cali_name[CALI_LIST_LENGHT][3]"
   *             and declare variable xxx_cali_t xxx_cail, add the data address in cali_sensor_buf[CALI_LIST_LENGHT]
   *             and add the data lenght in cali_sensor_size, at last, add function in cali_hook_fun[CALI_LIST_LENGHT]
+  *             4.add the schema version in cali_version[CALI_LIST_LENGHT], starts at 1.
   *             ʹңпʼУ׼
   *             һ:ңض
   *             ڶ:ҡ˴\../,.\.ҡ´.
@@ -61,13 +68,18 @@
   *                    ҡ˴'\/' ʼ̨У׼
   *                    ҡ˴/''\ ʼУ׼
   *
-  *             flashУУ׼ݺ name[3]  У׼־λ cali_flag
-  *             head_caliа˸ֽ,Ҫ12ֽflash,0x080A0000ʼ
-  *             0x080A0000-0x080A0007: head_cali
-  *             0x080A0008: name[0]
-  *             0x080A0009: name[1]
-  *             0x080A000A: name[2]
-  *             0x080A000B: У׼־λ cali_flag,У׼־λΪ0x55,ζhead_caliѾУ׼
+  *             flashУ, У׼ݺ name[3]  У׼־λ cali_flag
+  *             head_caliа˸ֽ,Ҫ16ֽflash,0x080A0004ʼ
+  *             0x080A0004-0x080A0007: , ݳ, ṹ汾CALI_RECORD_TAG
+  *             0x080A0008-0x080A000F: head_cali
+  *             0x080A0010: name[0]
+  *             0x080A0011: name[1]
+  *             0x080A0012: name[2]
+  *             0x080A0013: У׼־λ cali_flag,У׼־λΪ0x55,ζhead_caliѾУ׼
+  *             һCALI_IMAGE_MAGIC, һ豸֮һ豸CRC32.
+  *             豸ֲ, 豸ƶ豸. ޸xxx_cali_tʱ, 汾1cali_migrate_table
+  *             ת, ϵʱɼ¼. ûCALI_IMAGE_MAGICľݰɵĹ̶ֶȡд.
+  *             ȡüflash: make -C tools/cali_check check
   *             豸
   *             1.豸calibrate_task.hcali_id_e, 
   *             typedef enum
@@ -85,10 +97,11 @@
   *                 uint16_t yyy;
   *                 fp32 zzz;
   *             } xxx_cali_t; //:8ֽ 8 bytes,  4, 8, 12, 16...
-  *             3. "FLASH_WRITE_BUF_LENGHT","sizeof(xxx_cali_t)", ʵº
+  *             3.ʵº
   *             bool_t cali_xxx_hook(uint32_t *cali, bool_t cmd),  "cali_name[CALI_LIST_LENGHT][3]"
   *              xxx_cali_t xxx_cail, ӱַcali_sensor_buf[CALI_LIST_LENGHT]
   *             cali_sensor_size[CALI_LIST_LENGHT]ݳ, cali_hook_fun[CALI_LIST_LENGHT]Ӻ
+  *             4.cali_version[CALI_LIST_LENGHT]ӽṹ汾, 1ʼ
   *
   ==============================================================================
   @endverbatim
@@ -107,11 +120,11 @@
 #include "remote_control.h"
 #include "INS_task.h"
 #include "gimbal_task.h"
+#include "profile.h"
+#include "referee.h"
+#include "supercap_efficiency.h"
 
 
-//include head,gimbal,gyro,accel,mag. gyro,accel and mag have the same data struct. total 5(CALI_LIST_LENGHT) devices, need data lenght + 5 * 4 bytes(name[3]+cali)
-#define FLASH_WRITE_BUF_LENGHT  (sizeof(head_cali_t) + sizeof(gimbal_cali_t) + sizeof(imu_cali_t) * 3  + CALI_LIST_LENGHT * 4)
-
 
 
 
@@ -151,6 +164,63 @@ static void cali_data_read(void);
   */
 static void cali_data_write(void);
 
+/**
+  * @brief          read the records of an image with descriptors, find devices by name
+  * @param[in]      none
+  * @retval         1: some records are upgraded, need to write back
+  */
+/**
+  * @brief          ȡֵ, ֲ豸
+  * @param[in]      none
+  * @retval         1: м¼, Ҫд
+  */
+static uint8_t cali_image_read(void);
+
+/**
+  * @brief          read an image without descriptors in the old fixed layout
+  * @param[in]      none
+  * @retval         1: some records are found, need to write back
+  */
+/**
+  * @brief          ɵĹ̶ֶȡûֵ
+  * @param[in]      none
+  * @retval         1: ҵ˼¼, Ҫд
+  */
+static uint8_t cali_legacy_read(void);
+
+/**
+  * @brief          upgrade the record in cali_record_buf to the current schema, and copy it to the device data,
+  *                 only after the image CRC matches
+  * @param[in]      id: device
+  * @param[in]      version: schema version in flash
+  * @param[in]      len: data lenght in flash, unit: word
+  * @retval         1: loaded, 0: the device needs to calibrate again
+  */
+/**
+  * @brief          cali_record_bufеļ¼ǰṹ, Ƶ豸, ֻCRC֮ͨ
+  * @param[in]      id: 豸
+  * @param[in]      version: flashеĽṹ汾
+  * @param[in]      len: flashеݳ, λ: 
+  * @retval         1: , 0: 豸ҪУ׼
+  */
+static uint8_t cali_record_load(uint8_t id, uint8_t version, uint8_t len);
+
+/**
+  * @brief          update the running CRC32 with words, the same result as the STM32 CRC unit
+  * @param[in]      crc: last CRC value, CALI_CRC_INIT at the beginning
+  * @param[in]      buf: data
+  * @param[in]      len: data lenght, unit: word(4 bytes)
+  * @retval         new CRC value
+  */
+/**
+  * @brief          ָCRC32, STM32ӲCRCһ
+  * @param[in]      crc: ϴεCRCֵ, ʼʱΪCALI_CRC_INIT
+  * @param[in]      buf: 
+  * @param[in]      len: ݳ, λ: (4ֽ)
+  * @retval         µCRCֵ
+  */
+static uint32_t cali_crc32_update(uint32_t crc, const uint32_t *buf, uint16_t len);
+
 
 /**
   * @brief          "head" sensor cali function
@@ -212,6 +282,130 @@ static bool_t cali_gyro_hook(uint32_t *cali, bool_t cmd);   //gyro device cali f
   */
 static bool_t cali_gimbal_hook(uint32_t *cali, bool_t cmd); //gimbal device cali function
 
+/**
+  * @brief          supercap efficiency map store function, the map is learned online, no calibration action
+  * @param[in][out] cali:the point to efficiency data, when cmd == CALI_FUNC_CMD_INIT, param is [in],cmd == CALI_FUNC_CMD_ON, param is [out]
+  * @param[in]      cmd: 
+                    CALI_FUNC_CMD_INIT: means to load the map into the learner
+                    CALI_FUNC_CMD_ON: means to export the learned map for saving
+  * @retval         0:means cali task has not been done
+                    1:means cali task has been done
+  */
+/**
+  * @brief          Чʱ洢, Чʱѧϰ, ûУ׼
+  * @param[in][out] cali:ָָЧ,cmdΪCALI_FUNC_CMD_INIT, ,CALI_FUNC_CMD_ON,
+  * @param[in]      cmd: 
+                    CALI_FUNC_CMD_INIT: Чʱѧϰ
+                    CALI_FUNC_CMD_ON: ѧϰЧʱڱ
+  * @retval         0:У׼û
+                    1:У׼Ѿ
+  */
+static bool_t cali_supercap_eff_hook(uint32_t *cali, bool_t cmd); //supercap efficiency store function
+
+/**
+  * @brief          supercap efficiency map store function of board 1, the same as cali_supercap_eff_hook
+  * @param[in][out] cali:the point to efficiency data of board 1
+  * @param[in]      cmd: CALI_FUNC_CMD_INIT or CALI_FUNC_CMD_ON
+  * @retval         0:means cali task has not been done
+                    1:means cali task has been done
+  */
+/**
+  * @brief          1鳬Чʱ洢, cali_supercap_eff_hookͬ
+  * @param[in][out] cali:ָָ1Ч
+  * @param[in]      cmd: CALI_FUNC_CMD_INIT  CALI_FUNC_CMD_ON
+  * @retval         0:У׼û
+                    1:У׼Ѿ
+  */
+static bool_t cali_supercap_eff1_hook(uint32_t *cali, bool_t cmd);
+
+/**
+  * @brief          load the last gimbal calibration checkpoint, and find the next free slot
+  * @param[out]     ckpt: checkpoint
+  * @retval         1: found, 0: no checkpoint
+  */
+/**
+  * @brief          ȡһ̨У׼, ҵһλ
+  * @param[out]     ckpt: 
+  * @retval         1: ҵ, 0: ûм
+  */
+static bool_t cali_gimbal_ckpt_load(gimbal_cali_ckpt_t *ckpt);
+
+/**
+  * @brief          at boot, append a boot mark behind a pending checkpoint. a checkpoint with more than
+  *                 CALI_CKPT_MAX_BOOTS marks behind it is stale, an abandoned calibration is not resumed later
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          ϵʱδɵļ׷һ. ֮ıǳCALI_CKPT_MAX_BOOTS
+  *                 Ϊ, У׼ںܾԺ󱻼
+  * @param[in]      none
+  * @retval         none
+  */
+static void cali_gimbal_ckpt_boot(void);
+
+/**
+  * @brief          append a gimbal calibration checkpoint, no erase
+  * @param[in]      ckpt: checkpoint
+  * @retval         none
+  */
+/**
+  * @brief          ׷һ̨У׼, 
+  * @param[in]      ckpt: 
+  * @retval         none
+  */
+static void cali_gimbal_ckpt_save(const gimbal_cali_ckpt_t *ckpt);
+
+/**
+  * @brief          check the stored gimbal limits, the axis which still checks out need not be swept again
+  * @param[in]      cali: stored gimbal data
+  * @retval         GIMBAL_CALI_AXIS_PITCH | GIMBAL_CALI_AXIS_YAW of the valid axes
+  */
+/**
+  * @brief          鱣̨λ, ȻЧ᲻Ҫɨ
+  * @param[in]      cali: ̨
+  * @retval         Ч GIMBAL_CALI_AXIS_PITCH | GIMBAL_CALI_AXIS_YAW
+  */
+static uint8_t cali_gimbal_axis_check(const gimbal_cali_t *cali);
+
+/**
+  * @brief          track the gyro bias while the robot is still, refine gyro_cali.offset and
+  *                 feed it to INS task, save to flash rarely
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          ˾ֹʱƯ, gyro_cali.offsetõINS task,
+  *                 дflash
+  * @param[in]      none
+  * @retval         none
+  */
+static void cali_gyro_bias_track(void);
+
+/**
+  * @brief          upgrade a gyro record from v1 (imu_cali_t) to v2, the calibration baseline is the stored offset
+  * @param[in][out] buf: record, CALI_RECORD_MAX_LENGHT words
+  * @retval         none
+  */
+/**
+  * @brief          Ǽ¼v1 (imu_cali_t) v2, У׼׼ȡƯ
+  * @param[in][out] buf: ¼, CALI_RECORD_MAX_LENGHT
+  * @retval         none
+  */
+static void cali_gyro_migrate_v1(uint32_t *buf);
+
+/**
+  * @brief          check whether a gimbal motor is turning
+  * @param[in]      motor: gimbal motor feedback
+  * @retval         1: turning, 0: at rest
+  */
+/**
+  * @brief          ж̨Ƿת
+  * @param[in]      motor: ̨
+  * @retval         1: ת, 0: ֹ
+  */
+static bool_t cali_gimbal_motor_moving(const motor_measure_t *motor);
+
 
 
 #if INCLUDE_uxTaskGetStackHighWaterMark
@@ -223,29 +417,69 @@ static const RC_ctrl_t *calibrate_RC;   //remote control point
 static head_cali_t     head_cali;       //head cali data
 static gimbal_cali_t   gimbal_cali;     //gimbal cali data
 static imu_cali_t      accel_cali;      //accel cali data
-static imu_cali_t      gyro_cali;       //gyro cali data
+static gyro_cali_t     gyro_cali;       //gyro cali data
 static imu_cali_t      mag_cali;        //mag cali data
+static SuperCap_EffStore supercap_eff_cali[SUPERCAP_MAX_INSTANCES]; //supercap efficiency map of every board
 
+static gimbal_cali_ckpt_t gimbal_ckpt;      //last saved gimbal checkpoint
+static uint32_t gimbal_ckpt_tick;           //time of last saved gimbal checkpoint
+static uint16_t gimbal_ckpt_slot;           //next free checkpoint slot
+static uint8_t  gimbal_ckpt_boots;          //boot marks behind the last checkpoint
+static uint8_t  gimbal_cali_running = 0;    //1: gimbal calibration has been started or resumed
 
-static uint8_t flash_write_buf[FLASH_WRITE_BUF_LENGHT];
+static fp32     gyro_saved_offset[3];       //gyro offset in flash, a save is needed when moved far from it
+static uint8_t  gyro_saved_valid = 0;       //1: gyro_saved_offset is loaded
+static uint32_t gyro_save_tick = 0;         //time of last bias save
+static uint32_t gyro_still_tick = 0;        //start time of the current stationary period, 0: moving
 
 cali_sensor_t cali_sensor[CALI_LIST_LENGHT]; 
 
-static const uint8_t cali_name[CALI_LIST_LENGHT][3] = {"HD", "GM", "GYR", "ACC", "MAG"};
+static const uint8_t cali_name[CALI_LIST_LENGHT][3] = {"HD", "GM", "GYR", "ACC", "MAG", "EFF", "EF1"};
 
 //cali data address
 static uint32_t *cali_sensor_buf[CALI_LIST_LENGHT] = {
         (uint32_t *)&head_cali, (uint32_t *)&gimbal_cali,
         (uint32_t *)&gyro_cali, (uint32_t *)&accel_cali,
-        (uint32_t *)&mag_cali};
+        (uint32_t *)&mag_cali, (uint32_t *)&supercap_eff_cali[0],
+        (uint32_t *)&supercap_eff_cali[1]};
 
 
 static uint8_t cali_sensor_size[CALI_LIST_LENGHT] =
     {
         sizeof(head_cali_t) / 4, sizeof(gimbal_cali_t) / 4,
-        sizeof(imu_cali_t) / 4, sizeof(imu_cali_t) / 4, sizeof(imu_cali_t) / 4};
+        sizeof(gyro_cali_t) / 4, sizeof(imu_cali_t) / 4, sizeof(imu_cali_t) / 4,
+        sizeof(SuperCap_EffStore) / 4, sizeof(SuperCap_EffStore) / 4};
+
+void *cali_hook_fun[CALI_LIST_LENGHT] = {cali_head_hook, cali_gimbal_hook, cali_gyro_hook, NULL, NULL,
+                                         cali_supercap_eff_hook, cali_supercap_eff1_hook};
+
+//schema version of every device
+//豸ݽṹ汾
+static const uint8_t cali_version[CALI_LIST_LENGHT] =
+    {
+        CALI_HEAD_VERSION, CALI_GIMBAL_VERSION,
+        CALI_GYRO_VERSION, CALI_IMU_VERSION, CALI_IMU_VERSION,
+        CALI_SUPERCAP_EFF_VERSION, CALI_SUPERCAP_EFF_VERSION};
+
+//converters, ordered by from_version. for example, if gimbal_cali_t v2 adds a word:
+//ת, from_version. gimbal_cali_t v2 һ:
+//    {CALI_GIMBAL, 1, 5, 6, cali_gimbal_migrate_v1},
+static const cali_migrate_t cali_migrate_table[] =
+    {
+        {CALI_GYRO, 1, sizeof(imu_cali_t) / 4, sizeof(gyro_cali_t) / 4, cali_gyro_migrate_v1},
+        //add more...
+        {CALI_LIST_LENGHT, 0, 0, 0, NULL},
+};
 
-void *cali_hook_fun[CALI_LIST_LENGHT] = {cali_head_hook, cali_gimbal_hook, cali_gyro_hook, NULL, NULL};
+//a record is read here and upgraded before it is copied to the device
+//¼ȶ, ٸƵ豸
+static uint32_t cali_record_buf[CALI_RECORD_MAX_LENGHT];
+
+typedef char cali_record_lenght_check[(sizeof(SuperCap_EffStore) / 4 <= CALI_RECORD_MAX_LENGHT) ? 1 : -1];
+typedef char cali_supercap_eff_num_check[(CALI_SUPERCAP_EFF1 - CALI_SUPERCAP_EFF + 1 == SUPERCAP_MAX_INSTANCES) ? 1 : -1];
+typedef char cali_image_size_check[((1 + CALI_LIST_LENGHT * (1 + CALI_SENSOR_HEAD_LEGHT) + 1) * 4 +
+                                    sizeof(head_cali_t) + sizeof(gimbal_cali_t) + sizeof(gyro_cali_t) + sizeof(imu_cali_t) * 2 +
+                                    sizeof(SuperCap_EffStore) * SUPERCAP_MAX_INSTANCES <= CALI_CKPT_OFFSET) ? 1 : -1];
 
 static uint32_t calibrate_systemTick;
 
@@ -262,42 +496,98 @@ static uint32_t calibrate_systemTick;
   */
 void calibrate_task(void const *pvParameters)
 {
-    static uint8_t i = 0;
-    
-    calibrate_RC = get_remote_ctrl_point_cali();
-
     while (1)
     {
+        cali_lowrate_job();
 
-        RC_cmd_to_calibrate();
+        osDelay(CALIBRATE_CONTROL_TIME);
+#if INCLUDE_uxTaskGetStackHighWaterMark
+        calibrate_task_stack = uxTaskGetStackHighWaterMark(NULL);
+        PROFILE_STACK(PROFILE_TASK_CALIBRATE, calibrate_task_stack);
+#endif
+    }
+}
 
-        for (i = 0; i < CALI_LIST_LENGHT; i++)
+/**
+  * @brief          one step of calibration: scan the remote control gesture and run the
+  *                 cali hook of the device which needs calibration. called every 1ms by
+  *                 calibrate_task or by the low-rate executor
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          У׼: ɨң, ҪУ׼豸hook.
+  *                 calibrate_taskִÿ1msһ
+  * @param[in]      none
+  * @retval         none
+  */
+void cali_lowrate_job(void)
+{
+    static uint8_t i = 0;
+    uint8_t write = 0;
+
+    PROFILE_BEGIN(PROFILE_RC_CMD_TO_CALIBRATE);
+    RC_cmd_to_calibrate();
+    PROFILE_END(PROFILE_RC_CMD_TO_CALIBRATE);
+
+    cali_gyro_bias_track();
+
+    for (i = 0; i < CALI_LIST_LENGHT; i++)
+    {
+        if (cali_sensor[i].cali_cmd)
         {
-            if (cali_sensor[i].cali_cmd)
+            if (cali_sensor[i].cali_hook != NULL)
             {
-                if (cali_sensor[i].cali_hook != NULL)
-                {
+                bool_t cali_finish;
 
-                    if (cali_sensor[i].cali_hook(cali_sensor_buf[i], CALI_FUNC_CMD_ON))
-                    {
-                        //done
-                        cali_sensor[i].name[0] = cali_name[i][0];
-                        cali_sensor[i].name[1] = cali_name[i][1];
-                        cali_sensor[i].name[2] = cali_name[i][2];
-                        //set 0x55
-                        cali_sensor[i].cali_done = CALIED_FLAG;
-
-                        cali_sensor[i].cali_cmd = 0;
-                        //write
-                        cali_data_write();
-                    }
+                PROFILE_BEGIN(PROFILE_CALI_HOOK);
+                cali_finish = cali_sensor[i].cali_hook(cali_sensor_buf[i], CALI_FUNC_CMD_ON);
+                PROFILE_END(PROFILE_CALI_HOOK);
+
+                if (cali_finish)
+                {
+                    //done
+                    cali_sensor[i].name[0] = cali_name[i][0];
+                    cali_sensor[i].name[1] = cali_name[i][1];
+                    cali_sensor[i].name[2] = cali_name[i][2];
+                    //set 0x55
+                    cali_sensor[i].cali_done = CALIED_FLAG;
+
+                    cali_sensor[i].cali_cmd = 0;
+                    write = 1;
                 }
             }
         }
-        osDelay(CALIBRATE_CONTROL_TIME);
-#if INCLUDE_uxTaskGetStackHighWaterMark
-        calibrate_task_stack = uxTaskGetStackHighWaterMark(NULL);
-#endif
+    }
+
+    //devices finished in the same pass share one erase, e.g. the efficiency maps of all boards
+    //ͬһɵ豸ֻдһ, аЧʱ
+    if (write)
+    {
+        cali_data_write();
+    }
+}
+
+/**
+  * @brief          save the learned supercap efficiency map to flash. it erases the flash page,
+  *                 call between matches only
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          ѧϰĳЧʱflash. flashҳ, ֻڱ϶
+  * @param[in]      none
+  * @retval         none
+  */
+void cali_supercap_eff_save(void)
+{
+    uint8_t i;
+
+    //the hooks export the maps and return done at once, then cali_lowrate_job writes flash once
+    //hookЧʱ, cali_lowrate_jobдһflash
+    for (i = CALI_SUPERCAP_EFF; i <= CALI_SUPERCAP_EFF1; i++)
+    {
+        cali_sensor[i].cali_cmd = 1;
     }
 }
 
@@ -499,6 +789,10 @@ void cali_param_init(void)
 {
     uint8_t i = 0;
 
+    PROFILE_INIT();
+
+    calibrate_RC = get_remote_ctrl_point_cali();
+
     for (i = 0; i < CALI_LIST_LENGHT; i++)
     {
         cali_sensor[i].flash_len = cali_sensor_size[i];
@@ -507,6 +801,7 @@ void cali_param_init(void)
     }
 
     cali_data_read();
+    cali_gimbal_ckpt_boot();
 
     for (i = 0; i < CALI_LIST_LENGHT; i++)
     {
@@ -533,119 +828,389 @@ void cali_param_init(void)
   */
 static void cali_data_read(void)
 {
-    uint8_t flash_read_buf[CALI_SENSOR_HEAD_LEGHT * 4];
+    uint32_t magic;
+    uint8_t upgrade;
     uint8_t i = 0;
-    uint16_t offset = 0;
+
     for (i = 0; i < CALI_LIST_LENGHT; i++)
     {
+        cali_sensor[i].name[0] = cali_name[i][0];
+        cali_sensor[i].name[1] = cali_name[i][1];
+        cali_sensor[i].name[2] = cali_name[i][2];
+        cali_sensor[i].cali_done = 0;
+    }
 
-        //read the data in flash, 
-        cali_flash_read(FLASH_USER_ADDR + offset, cali_sensor[i].flash_buf, cali_sensor[i].flash_len);
-        
-        offset += cali_sensor[i].flash_len * 4;
-
-        //read the name and cali flag,
-        cali_flash_read(FLASH_USER_ADDR + offset, (uint32_t *)flash_read_buf, CALI_SENSOR_HEAD_LEGHT);
-        
-        cali_sensor[i].name[0] = flash_read_buf[0];
-        cali_sensor[i].name[1] = flash_read_buf[1];
-        cali_sensor[i].name[2] = flash_read_buf[2];
-        cali_sensor[i].cali_done = flash_read_buf[3];
-        
-        offset += CALI_SENSOR_HEAD_LEGHT * 4;
+    cali_flash_read(FLASH_USER_ADDR, &magic, 1);
+    if (magic == CALI_IMAGE_MAGIC)
+    {
+        upgrade = cali_image_read();
+    }
+    else
+    {
+        upgrade = cali_legacy_read();
+    }
 
+    for (i = 0; i < CALI_LIST_LENGHT; i++)
+    {
         if (cali_sensor[i].cali_done != CALIED_FLAG && cali_sensor[i].cali_hook != NULL)
         {
             cali_sensor[i].cali_cmd = 1;
         }
     }
-}
 
+    //write the upgraded records back once, the next boot reads them directly
+    //ļ¼дһ, ´ϵֱӶȡ
+    if (upgrade)
+    {
+        cali_data_write();
+    }
+}
 
 /**
-  * @brief          write the data to flash
+  * @brief          read the records of an image with descriptors, find devices by name
   * @param[in]      none
-  * @retval         none
+  * @retval         1: some records are upgraded or come from an old image, need to write back
   */
 /**
-  * @brief          flashдУ׼
+  * @brief          ȡֵ, ֲ豸
   * @param[in]      none
-  * @retval         none
+  * @retval         1: м¼, Ҫд
   */
-static void cali_data_write(void)
+static uint8_t cali_image_read(void)
 {
-    uint8_t i = 0;
-    uint16_t offset = 0;
-
-
-    for (i = 0; i < CALI_LIST_LENGHT; i++)
+    cali_record_desc_t desc;
+    cali_record_desc_t found_desc[CALI_LIST_LENGHT] = {0};
+    uint32_t found_offset[CALI_LIST_LENGHT];
+    uint8_t head[CALI_SENSOR_HEAD_LEGHT * 4];
+    uint8_t upgrade = 0;
+    uint32_t offset = 4;
+    uint32_t crc = CALI_CRC_INIT;
+    uint32_t flash_crc;
+    uint8_t n, i;
+
+    //bounded by the record number and the checkpoint area
+    //ܼ¼ͼ
+    for (n = 0; n < CALI_RECORD_MAX_NUM; n++)
     {
-        //copy the data of device calibration data
-        memcpy((void *)(flash_write_buf + offset), (void *)cali_sensor[i].flash_buf, cali_sensor[i].flash_len * 4);
-        offset += cali_sensor[i].flash_len * 4;
+        cali_flash_read(FLASH_USER_ADDR + offset, (uint32_t *)&desc, 1);
+        if (desc.tag != CALI_RECORD_TAG || desc.len > CALI_RECORD_MAX_LENGHT ||
+            offset + (desc.len + 1 + CALI_SENSOR_HEAD_LEGHT) * 4 > CALI_CKPT_OFFSET)
+        {
+            break;
+        }
+        crc = cali_crc32_update(crc, (uint32_t *)&desc, 1);
+        offset += 4;
+
+        cali_flash_read(FLASH_USER_ADDR + offset, cali_record_buf, desc.len);
+        crc = cali_crc32_update(crc, cali_record_buf, desc.len);
+        offset += desc.len * 4;
 
-        //copy the name and "CALI_FLAG" of device
-        memcpy((void *)(flash_write_buf + offset), (void *)cali_sensor[i].name, CALI_SENSOR_HEAD_LEGHT * 4);
+        cali_flash_read(FLASH_USER_ADDR + offset, (uint32_t *)head, CALI_SENSOR_HEAD_LEGHT);
+        crc = cali_crc32_update(crc, (uint32_t *)head, CALI_SENSOR_HEAD_LEGHT);
         offset += CALI_SENSOR_HEAD_LEGHT * 4;
+
+        //a device unknown to this firmware is skipped
+        //̼ʶ豸
+        for (i = 0; i < CALI_LIST_LENGHT; i++)
+        {
+            if (memcmp(head, cali_name[i], 3) == 0)
+            {
+                break;
+            }
+        }
+        //only remember where the record is, the device data is not touched before the CRC matches
+        //ֻ¼¼λ, CRC֮ͨǰ޸豸
+        if (i < CALI_LIST_LENGHT && head[3] == CALIED_FLAG)
+        {
+            found_desc[i] = desc;
+            found_offset[i] = offset - (desc.len + CALI_SENSOR_HEAD_LEGHT) * 4;
+        }
     }
 
-    //erase the page
-    cali_flash_erase(FLASH_USER_ADDR,1);
-    //write data
-    cali_flash_write(FLASH_USER_ADDR, (uint32_t *)flash_write_buf, (FLASH_WRITE_BUF_LENGHT + 3) / 4);
-}
+    //the data is broken, calibrate all devices again
+    //, 豸У׼
+    cali_flash_read(FLASH_USER_ADDR + offset, &flash_crc, 1);
+    if (flash_crc != crc)
+    {
+        return 0;
+    }
 
+    for (i = 0; i < CALI_LIST_LENGHT; i++)
+    {
+        if (found_desc[i].tag != CALI_RECORD_TAG)
+        {
+            continue;
+        }
+        cali_flash_read(FLASH_USER_ADDR + found_offset[i], cali_record_buf, found_desc[i].len);
+        if (cali_record_load(i, found_desc[i].version, found_desc[i].len))
+        {
+            cali_sensor[i].cali_done = CALIED_FLAG;
+            if (found_desc[i].version != cali_version[i])
+            {
+                upgrade = 1;
+            }
+        }
+    }
+    return upgrade;
+}
 
 /**
-  * @brief          "head" sensor cali function
-  * @param[in][out] cali:the point to head data. when cmd == CALI_FUNC_CMD_INIT, param is [in],cmd == CALI_FUNC_CMD_ON, param is [out]
-  * @param[in]      cmd: 
-                    CALI_FUNC_CMD_INIT: means to use cali data to initialize original data
-                    CALI_FUNC_CMD_ON: means need to calibrate
-  * @retval         0:means cali task has not been done
-                    1:means cali task has been done
+  * @brief          read an image without descriptors, the records are in the old fixed order with
+  *                 the old fixed lenghts, and the CRC is after the last record found
+  * @param[in]      none
+  * @retval         1: some records are found, need to write back
   */
 /**
-  * @brief          "head"豸У׼
-  * @param[in][out] cali:ָָhead,cmdΪCALI_FUNC_CMD_INIT, ,CALI_FUNC_CMD_ON,
-  * @param[in]      cmd: 
-                    CALI_FUNC_CMD_INIT: У׼ݳʼԭʼ
-                    CALI_FUNC_CMD_ON: ҪУ׼
-  * @retval         0:У׼û
-                    1:У׼Ѿ
+  * @brief          ȡûֵľ, ¼ɵĹ̶˳ͳ, CRCҵһ¼֮
+  * @param[in]      none
+  * @retval         1: ҵ˼¼, Ҫд
   */
-static bool_t cali_head_hook(uint32_t *cali, bool_t cmd)
+static uint8_t cali_legacy_read(void)
 {
-    head_cali_t *local_cali_t = (head_cali_t *)cali;
-    if (cmd == CALI_FUNC_CMD_INIT)
+    //lenght of "HD", "GM", "GYR", "ACC", "MAG", "EFF" before the descriptors, never change
+    //֮ǰ "HD", "GM", "GYR", "ACC", "MAG", "EFF" ĳ, ޸
+    static const uint8_t legacy_len[] = {2, 5, 6, 6, 6, 64};
+    uint8_t head[CALI_SENSOR_HEAD_LEGHT * 4];
+    uint8_t calied[CALI_LIST_LENGHT] = {0};
+    uint32_t found_offset[CALI_LIST_LENGHT];
+    uint8_t found = 0;
+    uint32_t offset = 0;
+    uint32_t crc = CALI_CRC_INIT;
+    uint32_t flash_crc;
+    uint8_t i;
+
+    for (i = 0; i < sizeof(legacy_len) && i < CALI_LIST_LENGHT; i++)
     {
-//        memcpy(&head_cali, local_cali_t, sizeof(head_cali_t));
-
-        return 1;
+        cali_flash_read(FLASH_USER_ADDR + offset, cali_record_buf, legacy_len[i]);
+        cali_flash_read(FLASH_USER_ADDR + offset + legacy_len[i] * 4, (uint32_t *)head, CALI_SENSOR_HEAD_LEGHT);
+        //an old image ends before the devices added later
+        //֮ӵ豸֮ǰ
+        if (memcmp(head, cali_name[i], 3) != 0)
+        {
+            break;
+        }
+        crc = cali_crc32_update(crc, cali_record_buf, legacy_len[i]);
+        crc = cali_crc32_update(crc, (uint32_t *)head, CALI_SENSOR_HEAD_LEGHT);
+        found_offset[i] = offset;
+        calied[i] = head[3] == CALIED_FLAG;
+        offset += (legacy_len[i] + CALI_SENSOR_HEAD_LEGHT) * 4;
+        found = 1;
     }
-    // self id
-    local_cali_t->self_id = SELF_ID;
-    //imu control temperature
-    local_cali_t->temperature = (int8_t)(cali_get_mcu_temperature()) + 10;
-    //head_cali.temperature = (int8_t)(cali_get_mcu_temperature()) + 10;
-    if (local_cali_t->temperature > (int8_t)(GYRO_CONST_MAX_TEMP))
+
+    //an image before the CRC keeps the erased value
+    //ûCRCľΪֵ
+    cali_flash_read(FLASH_USER_ADDR + offset, &flash_crc, 1);
+    if (!found || (flash_crc != CALI_CRC_EMPTY && flash_crc != crc))
     {
-        local_cali_t->temperature = (int8_t)(GYRO_CONST_MAX_TEMP);
+        return 0;
     }
-    
-    local_cali_t->firmware_version = FIRMWARE_VERSION;
-    //shenzhen latitude 
-    local_cali_t->latitude = 22.0f;
 
+    //the device data is only changed after the CRC matches
+    //CRC֮ͨ޸豸
+    for (i = 0; i < sizeof(legacy_len) && i < CALI_LIST_LENGHT; i++)
+    {
+        if (!calied[i])
+        {
+            continue;
+        }
+        cali_flash_read(FLASH_USER_ADDR + found_offset[i], cali_record_buf, legacy_len[i]);
+        if (cali_record_load(i, CALI_LEGACY_VERSION, legacy_len[i]))
+        {
+            cali_sensor[i].cali_done = CALIED_FLAG;
+        }
+    }
     return 1;
 }
 
 /**
-  * @brief          gyro cali function
-  * @param[in][out] cali:the point to gyro data, when cmd == CALI_FUNC_CMD_INIT, param is [in],cmd == CALI_FUNC_CMD_ON, param is [out]
-  * @param[in]      cmd: 
-                    CALI_FUNC_CMD_INIT: means to use cali data to initialize original data
-                    CALI_FUNC_CMD_ON: means need to calibrate
+  * @brief          upgrade the record in cali_record_buf to the current schema with one pass of
+  *                 cali_migrate_table, and copy it to the device data. only called after the CRC
+  *                 of the whole image matches
+  * @param[in]      id: device
+  * @param[in]      version: schema version in flash
+  * @param[in]      len: data lenght in flash, unit: word
+  * @retval         1: loaded, 0: no converter, the device needs to calibrate again
+  */
+/**
+  * @brief          cali_migrate_tableһ, cali_record_bufеļ¼ǰṹ, Ƶ豸.
+  *                 ֻݵCRC֮ͨ
+  * @param[in]      id: 豸
+  * @param[in]      version: flashеĽṹ汾
+  * @param[in]      len: flashеݳ, λ: 
+  * @retval         1: , 0: ûת, 豸ҪУ׼
+  */
+static uint8_t cali_record_load(uint8_t id, uint8_t version, uint8_t len)
+{
+    const cali_migrate_t *migrate;
+
+    //the table is ordered by version, one pass upgrades any old version
+    //汾, һμɴɰ汾
+    for (migrate = cali_migrate_table; migrate->migrate != NULL; migrate++)
+    {
+        if (migrate->id == id && migrate->from_version == version && migrate->from_len == len)
+        {
+            migrate->migrate(cali_record_buf);
+            version++;
+            len = migrate->to_len;
+        }
+    }
+
+    //a newer version from a newer firmware is not loaded
+    //¹̼дĸ߰汾
+    if (version != cali_version[id] || len != cali_sensor[id].flash_len)
+    {
+        return 0;
+    }
+
+    memcpy(cali_sensor[id].flash_buf, cali_record_buf, len * 4);
+    return 1;
+}
+
+
+/**
+  * @brief          write the data to flash
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          flashдУ׼
+  * @param[in]      none
+  * @retval         none
+  */
+static void cali_data_write(void)
+{
+    uint8_t i = 0;
+    uint32_t offset = 0;
+    uint32_t head[CALI_SENSOR_HEAD_LEGHT];
+    cali_record_desc_t desc;
+    uint32_t magic = CALI_IMAGE_MAGIC;
+    uint32_t crc = CALI_CRC_INIT;
+
+    PROFILE_BEGIN(PROFILE_CALI_DATA_WRITE);
+
+    //erase the page
+    cali_flash_erase(FLASH_USER_ADDR,1);
+
+    cali_flash_write(FLASH_USER_ADDR, &magic, 1);
+    offset += 4;
+
+    //program every device straight from its data, no staging buffer
+    //ֱӴӸ豸дflash, 
+    for (i = 0; i < CALI_LIST_LENGHT; i++)
+    {
+        //write the descriptor
+        desc.len = cali_sensor[i].flash_len;
+        desc.version = cali_version[i];
+        desc.tag = CALI_RECORD_TAG;
+        cali_flash_write(FLASH_USER_ADDR + offset, (uint32_t *)&desc, 1);
+        crc = cali_crc32_update(crc, (uint32_t *)&desc, 1);
+        offset += 4;
+
+        //write the data of device calibration data
+        cali_flash_write(FLASH_USER_ADDR + offset, cali_sensor[i].flash_buf, cali_sensor[i].flash_len);
+        crc = cali_crc32_update(crc, cali_sensor[i].flash_buf, cali_sensor[i].flash_len);
+        offset += cali_sensor[i].flash_len * 4;
+
+        //write the name and "CALI_FLAG" of device
+        memcpy((void *)head, (void *)cali_sensor[i].name, CALI_SENSOR_HEAD_LEGHT * 4);
+        cali_flash_write(FLASH_USER_ADDR + offset, head, CALI_SENSOR_HEAD_LEGHT);
+        crc = cali_crc32_update(crc, head, CALI_SENSOR_HEAD_LEGHT);
+        offset += CALI_SENSOR_HEAD_LEGHT * 4;
+    }
+
+    //write the CRC at last, a power cut before this leaves a CRC mismatch
+    //дCRC, ڴ֮ǰᵼCRCƥ
+    cali_flash_write(FLASH_USER_ADDR + offset, &crc, 1);
+
+    PROFILE_END(PROFILE_CALI_DATA_WRITE);
+}
+
+/**
+  * @brief          update the running CRC32 with words, the same result as the STM32 CRC unit
+  * @param[in]      crc: last CRC value, CALI_CRC_INIT at the beginning
+  * @param[in]      buf: data
+  * @param[in]      len: data lenght, unit: word(4 bytes)
+  * @retval         new CRC value
+  */
+/**
+  * @brief          ָCRC32, STM32ӲCRCһ
+  * @param[in]      crc: ϴεCRCֵ, ʼʱΪCALI_CRC_INIT
+  * @param[in]      buf: 
+  * @param[in]      len: ݳ, λ: (4ֽ)
+  * @retval         µCRCֵ
+  */
+static uint32_t cali_crc32_update(uint32_t crc, const uint32_t *buf, uint16_t len)
+{
+    uint8_t bit;
+    while (len--)
+    {
+        crc ^= *buf++;
+        for (bit = 0; bit < 32; bit++)
+        {
+            if (crc & 0x80000000)
+            {
+                crc = (crc << 1) ^ CALI_CRC_POLY;
+            }
+            else
+            {
+                crc <<= 1;
+            }
+        }
+    }
+    return crc;
+}
+
+
+/**
+  * @brief          "head" sensor cali function
+  * @param[in][out] cali:the point to head data. when cmd == CALI_FUNC_CMD_INIT, param is [in],cmd == CALI_FUNC_CMD_ON, param is [out]
+  * @param[in]      cmd: 
+                    CALI_FUNC_CMD_INIT: means to use cali data to initialize original data
+                    CALI_FUNC_CMD_ON: means need to calibrate
+  * @retval         0:means cali task has not been done
+                    1:means cali task has been done
+  */
+/**
+  * @brief          "head"豸У׼
+  * @param[in][out] cali:ָָhead,cmdΪCALI_FUNC_CMD_INIT, ,CALI_FUNC_CMD_ON,
+  * @param[in]      cmd: 
+                    CALI_FUNC_CMD_INIT: У׼ݳʼԭʼ
+                    CALI_FUNC_CMD_ON: ҪУ׼
+  * @retval         0:У׼û
+                    1:У׼Ѿ
+  */
+static bool_t cali_head_hook(uint32_t *cali, bool_t cmd)
+{
+    head_cali_t *local_cali_t = (head_cali_t *)cali;
+    if (cmd == CALI_FUNC_CMD_INIT)
+    {
+//        memcpy(&head_cali, local_cali_t, sizeof(head_cali_t));
+
+        return 1;
+    }
+    // self id
+    local_cali_t->self_id = SELF_ID;
+    //imu control temperature
+    local_cali_t->temperature = (int8_t)(cali_get_mcu_temperature()) + 10;
+    //head_cali.temperature = (int8_t)(cali_get_mcu_temperature()) + 10;
+    if (local_cali_t->temperature > (int8_t)(GYRO_CONST_MAX_TEMP))
+    {
+        local_cali_t->temperature = (int8_t)(GYRO_CONST_MAX_TEMP);
+    }
+    
+    local_cali_t->firmware_version = FIRMWARE_VERSION;
+    //shenzhen latitude 
+    local_cali_t->latitude = 22.0f;
+
+    return 1;
+}
+
+/**
+  * @brief          gyro cali function
+  * @param[in][out] cali:the point to gyro data, when cmd == CALI_FUNC_CMD_INIT, param is [in],cmd == CALI_FUNC_CMD_ON, param is [out]
+  * @param[in]      cmd: 
+                    CALI_FUNC_CMD_INIT: means to use cali data to initialize original data
+                    CALI_FUNC_CMD_ON: means need to calibrate
   * @retval         0:means cali task has not been done
                     1:means cali task has been done
   */
@@ -660,7 +1225,8 @@ static bool_t cali_head_hook(uint32_t *cali, bool_t cmd)
   */
 static bool_t cali_gyro_hook(uint32_t *cali, bool_t cmd)
 {
-    imu_cali_t *local_cali_t = (imu_cali_t *)cali;
+    gyro_cali_t *local_cali_t = (gyro_cali_t *)cali;
+    uint8_t i;
     if (cmd == CALI_FUNC_CMD_INIT)
     {
         gyro_set_cali(local_cali_t->scale, local_cali_t->offset);
@@ -674,6 +1240,13 @@ static bool_t cali_gyro_hook(uint32_t *cali, bool_t cmd)
         if (count_time > GYRO_CALIBRATE_TIME)
         {
             count_time = 0;
+            //new calibration is the new bound of bias tracking, a lazy save keeps it
+            //µУ׼ֵΪƯٵĻ׼, ٱʱı
+            for (i = 0; i < 3; i++)
+            {
+                local_cali_t->cali_offset[i] = local_cali_t->offset[i];
+            }
+            gyro_saved_valid = 0;
             cali_buzzer_off();
             gyro_cali_enable_control();
             return 1;
@@ -690,6 +1263,27 @@ static bool_t cali_gyro_hook(uint32_t *cali, bool_t cmd)
     return 0;
 }
 
+/**
+  * @brief          upgrade a gyro record from v1 (imu_cali_t) to v2, the calibration baseline is the stored offset
+  * @param[in][out] buf: record, CALI_RECORD_MAX_LENGHT words
+  * @retval         none
+  */
+/**
+  * @brief          Ǽ¼v1 (imu_cali_t) v2, У׼׼ȡƯ
+  * @param[in][out] buf: ¼, CALI_RECORD_MAX_LENGHT
+  * @retval         none
+  */
+static void cali_gyro_migrate_v1(uint32_t *buf)
+{
+    gyro_cali_t *gyro = (gyro_cali_t *)buf;
+    uint8_t i;
+
+    for (i = 0; i < 3; i++)
+    {
+        gyro->cali_offset[i] = gyro->offset[i];
+    }
+}
+
 /**
   * @brief          gimbal cali function
   * @param[in][out] cali:the point to gimbal data, when cmd == CALI_FUNC_CMD_INIT, param is [in],cmd == CALI_FUNC_CMD_ON, param is [out]
@@ -722,16 +1316,49 @@ static bool_t cali_gimbal_hook(uint32_t *cali, bool_t cmd)
     }
     else if (cmd == CALI_FUNC_CMD_ON)
     {
+        if (!gimbal_cali_running)
+        {
+            //resume from the last checkpoint, or skip the stored axes which still check out
+            //һ, ֵȻЧ
+            if (!cali_gimbal_ckpt_load(&gimbal_ckpt))
+            {
+                memset(&gimbal_ckpt, 0, sizeof(gimbal_cali_ckpt_t));
+                if (cali_sensor[CALI_GIMBAL].cali_done == CALIED_FLAG)
+                {
+                    gimbal_ckpt.axis_done = cali_gimbal_axis_check(local_cali_t);
+                    gimbal_ckpt.cali = *local_cali_t;
+                }
+            }
+            gimbal_cali_resume(&gimbal_ckpt);
+            gimbal_ckpt_tick = xTaskGetTickCount();
+            gimbal_cali_running = 1;
+        }
+
         if (cmd_cali_gimbal_hook(&local_cali_t->yaw_offset, &local_cali_t->pitch_offset,
                                  &local_cali_t->yaw_max_angle, &local_cali_t->yaw_min_angle,
                                  &local_cali_t->pitch_max_angle, &local_cali_t->pitch_min_angle))
         {
+            //cali_data_write erases the page, the checkpoints are cleared
+            //cali_data_writeҳ, ֮
+            gimbal_cali_running = 0;
             cali_buzzer_off();
             
             return 1;
         }
         else
         {
+            gimbal_cali_ckpt_t progress;
+
+            gimbal_cali_get_progress(&progress);
+            if (progress.step != gimbal_ckpt.step || progress.axis_done != gimbal_ckpt.axis_done ||
+                (xTaskGetTickCount() - gimbal_ckpt_tick > CALI_CKPT_PERIOD &&
+                 memcmp(&progress, &gimbal_ckpt, sizeof(gimbal_cali_ckpt_t)) != 0))
+            {
+                cali_gimbal_ckpt_save(&progress);
+                gimbal_ckpt = progress;
+                gimbal_ckpt_tick = xTaskGetTickCount();
+            }
+
             gimbal_start_buzzer();
             
             return 0;
@@ -740,3 +1367,445 @@ static bool_t cali_gimbal_hook(uint32_t *cali, bool_t cmd)
     
     return 0;
 }
+
+/**
+  * @brief          load the last gimbal calibration checkpoint, and find the next free slot
+  * @param[out]     ckpt: checkpoint
+  * @retval         1: found, 0: no checkpoint
+  */
+/**
+  * @brief          ȡһ̨У׼, ҵһλ
+  * @param[out]     ckpt: 
+  * @retval         1: ҵ, 0: ûм
+  */
+static bool_t cali_gimbal_ckpt_load(gimbal_cali_ckpt_t *ckpt)
+{
+    const uint16_t ckpt_len = sizeof(gimbal_cali_ckpt_t) / 4;
+    const uint16_t slot_len = (ckpt_len + CALI_SENSOR_HEAD_LEGHT) * 4;
+    uint8_t head[CALI_SENSOR_HEAD_LEGHT * 4];
+    bool_t found = 0;
+    uint16_t slot;
+
+    gimbal_ckpt_boots = 0;
+
+    for (slot = 0; slot < CALI_CKPT_SIZE / slot_len; slot++)
+    {
+        uint32_t address = FLASH_USER_ADDR + CALI_CKPT_OFFSET + slot * slot_len;
+
+        cali_flash_read(address + ckpt_len * 4, (uint32_t *)head, CALI_SENSOR_HEAD_LEGHT);
+        if (head[0] == 'G' && head[1] == 'C' && head[2] == 'P' && head[3] == CALIED_FLAG)
+        {
+            //the latest complete checkpoint wins
+            //һļЧ
+            cali_flash_read(address, (uint32_t *)ckpt, ckpt_len);
+            found = 1;
+            gimbal_ckpt_boots = 0;
+        }
+        else if (head[0] == 'G' && head[1] == 'C' && head[2] == 'B' && head[3] == CALIED_FLAG)
+        {
+            //boot mark, only the header is written
+            //, ֻдͷ
+            if (gimbal_ckpt_boots < 0xFF)
+            {
+                gimbal_ckpt_boots++;
+            }
+        }
+        else if (head[0] == 0xFF && head[1] == 0xFF && head[2] == 0xFF && head[3] == 0xFF)
+        {
+            //the header is written last, an erased header is a free slot or a power cut in writing
+            //ͷд, ͷΪֵǿλдʱ
+            uint32_t word;
+            cali_flash_read(address, &word, 1);
+            if (word == 0xFFFFFFFF)
+            {
+                break;
+            }
+        }
+    }
+
+    gimbal_ckpt_slot = slot;
+    return found && gimbal_ckpt_boots <= CALI_CKPT_MAX_BOOTS;
+}
+
+/**
+  * @brief          at boot, append a boot mark behind a pending checkpoint
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          ϵʱδɵļ׷һ
+  * @param[in]      none
+  * @retval         none
+  */
+static void cali_gimbal_ckpt_boot(void)
+{
+    const uint16_t ckpt_len = sizeof(gimbal_cali_ckpt_t) / 4;
+    const uint16_t slot_len = (ckpt_len + CALI_SENSOR_HEAD_LEGHT) * 4;
+    uint8_t head[CALI_SENSOR_HEAD_LEGHT * 4] = {'G', 'C', 'B', CALIED_FLAG};
+    gimbal_cali_ckpt_t ckpt;
+
+    //no checkpoint, or already stale
+    //ûм, Ѿ
+    if (!cali_gimbal_ckpt_load(&ckpt) || gimbal_ckpt_slot >= CALI_CKPT_SIZE / slot_len)
+    {
+        return;
+    }
+
+    cali_flash_write(FLASH_USER_ADDR + CALI_CKPT_OFFSET + gimbal_ckpt_slot * slot_len + ckpt_len * 4,
+                     (uint32_t *)head, CALI_SENSOR_HEAD_LEGHT);
+    gimbal_ckpt_slot++;
+}
+
+/**
+  * @brief          weak default when gimbal task has no checkpoint support: report the last saved
+  *                 checkpoint, so nothing new is saved
+  * @param[out]     ckpt: sweep progress
+  * @retval         none
+  */
+/**
+  * @brief          ּ̨֧ʱ: ϴαļ, ᱣ¼
+  * @param[out]     ckpt: ɨ
+  * @retval         none
+  */
+__weak void get_cali_gimbal_progress(gimbal_cali_ckpt_t *ckpt)
+{
+    *ckpt = gimbal_ckpt;
+}
+
+/**
+  * @brief          weak default when gimbal task has no checkpoint support: ignore the checkpoint,
+  *                 gimbal task sweeps every axis as before
+  * @param[in]      ckpt: checkpoint
+  * @retval         none
+  */
+/**
+  * @brief          ּ̨֧ʱ: Լ, ̨վɨ
+  * @param[in]      ckpt: 
+  * @retval         none
+  */
+__weak void set_cali_gimbal_progress(const gimbal_cali_ckpt_t *ckpt)
+{
+}
+
+/**
+  * @brief          append a gimbal calibration checkpoint, no erase
+  * @param[in]      ckpt: checkpoint
+  * @retval         none
+  */
+/**
+  * @brief          ׷һ̨У׼, 
+  * @param[in]      ckpt: 
+  * @retval         none
+  */
+static void cali_gimbal_ckpt_save(const gimbal_cali_ckpt_t *ckpt)
+{
+    const uint16_t ckpt_len = sizeof(gimbal_cali_ckpt_t) / 4;
+    const uint16_t slot_len = (ckpt_len + CALI_SENSOR_HEAD_LEGHT) * 4;
+    uint32_t address = FLASH_USER_ADDR + CALI_CKPT_OFFSET + gimbal_ckpt_slot * slot_len;
+    uint8_t head[CALI_SENSOR_HEAD_LEGHT * 4] = {'G', 'C', 'P', CALIED_FLAG};
+
+    //checkpoint area is full, keep calibrating without checkpoints
+    //, ٱ
+    if (gimbal_ckpt_slot >= CALI_CKPT_SIZE / slot_len)
+    {
+        return;
+    }
+
+    cali_flash_write(address, (uint32_t *)ckpt, ckpt_len);
+    cali_flash_write(address + ckpt_len * 4, (uint32_t *)head, CALI_SENSOR_HEAD_LEGHT);
+    gimbal_ckpt_slot++;
+}
+
+/**
+  * @brief          check the stored gimbal limits, the axis which still checks out need not be swept again
+  * @param[in]      cali: stored gimbal data
+  * @retval         GIMBAL_CALI_AXIS_PITCH | GIMBAL_CALI_AXIS_YAW of the valid axes
+  */
+/**
+  * @brief          鱣̨λ, ȻЧ᲻Ҫɨ
+  * @param[in]      cali: ̨
+  * @retval         Ч GIMBAL_CALI_AXIS_PITCH | GIMBAL_CALI_AXIS_YAW
+  */
+static uint8_t cali_gimbal_axis_check(const gimbal_cali_t *cali)
+{
+    uint8_t axis_done = 0;
+    fp32 span;
+
+    //NaN fails every comparison
+    //NaNκαȽ϶Ϊ
+    span = cali->pitch_max_angle - cali->pitch_min_angle;
+    if (cali->pitch_offset < GIMBAL_CALI_ECD_RANGE && span > GIMBAL_CALI_MIN_SPAN && span < GIMBAL_CALI_MAX_SPAN)
+    {
+        axis_done |= GIMBAL_CALI_AXIS_PITCH;
+    }
+
+    span = cali->yaw_max_angle - cali->yaw_min_angle;
+    if (cali->yaw_offset < GIMBAL_CALI_ECD_RANGE && span > GIMBAL_CALI_MIN_SPAN && span < GIMBAL_CALI_MAX_SPAN)
+    {
+        axis_done |= GIMBAL_CALI_AXIS_YAW;
+    }
+
+    return axis_done;
+}
+
+/**
+  * @brief          supercap efficiency map store function, the map is learned online, no calibration action
+  * @param[in][out] cali:the point to efficiency data, when cmd == CALI_FUNC_CMD_INIT, param is [in],cmd == CALI_FUNC_CMD_ON, param is [out]
+  * @param[in]      cmd: 
+                    CALI_FUNC_CMD_INIT: means to load the map into the learner
+                    CALI_FUNC_CMD_ON: means to export the learned map for saving
+  * @retval         0:means cali task has not been done
+                    1:means cali task has been done
+  */
+/**
+  * @brief          Чʱ洢, Чʱѧϰ, ûУ׼
+  * @param[in][out] cali:ָָЧ,cmdΪCALI_FUNC_CMD_INIT, ,CALI_FUNC_CMD_ON,
+  * @param[in]      cmd: 
+                    CALI_FUNC_CMD_INIT: Чʱѧϰ
+                    CALI_FUNC_CMD_ON: ѧϰЧʱڱ
+  * @retval         0:У׼û
+                    1:У׼Ѿ
+  */
+static bool_t cali_supercap_eff_hook(uint32_t *cali, bool_t cmd)
+{
+    SuperCap_EffStore *local_cali_t = (SuperCap_EffStore *)cali;
+    uint8_t board;
+
+    if (cmd == CALI_FUNC_CMD_INIT)
+    {
+        //board 0 seeds every board, a board with its own record loads it later
+        //0Ϊаĳֵ, Լ¼İ
+        for (board = 0; board < SUPERCAP_MAX_INSTANCES; board++)
+        {
+            SuperCapEffLoad(board, local_cali_t);
+        }
+
+        return 0;
+    }
+    else if (cmd == CALI_FUNC_CMD_ON)
+    {
+        SuperCapEffStore(0, local_cali_t);
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief          supercap efficiency map store function of board 1
+  * @param[in][out] cali:the point to efficiency data of board 1
+  * @param[in]      cmd: CALI_FUNC_CMD_INIT or CALI_FUNC_CMD_ON
+  * @retval         0:means cali task has not been done
+                    1:means cali task has been done
+  */
+/**
+  * @brief          1鳬Чʱ洢
+  * @param[in][out] cali:ָָ1Ч
+  * @param[in]      cmd: CALI_FUNC_CMD_INIT  CALI_FUNC_CMD_ON
+  * @retval         0:У׼û
+                    1:У׼Ѿ
+  */
+static bool_t cali_supercap_eff1_hook(uint32_t *cali, bool_t cmd)
+{
+    SuperCap_EffStore *local_cali_t = (SuperCap_EffStore *)cali;
+
+    if (cmd == CALI_FUNC_CMD_INIT)
+    {
+        //called after the board 0 hook, overrides its seed
+        //ڵ0hook֮, ֵ
+        SuperCapEffLoad(1, local_cali_t);
+
+        return 0;
+    }
+    else if (cmd == CALI_FUNC_CMD_ON)
+    {
+        SuperCapEffStore(1, local_cali_t);
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief          track the gyro bias while the robot is still. a window of GYRO_BIAS_WINDOW
+  *                 samples is still when chassis motors are at rest and gyro variance is low,
+  *                 then a part of the window mean is moved into gyro_cali.offset, bounded
+  *                 around gyro_cali.cali_offset from the last explicit calibration, so lazy saves
+  *                 cannot walk it further. flash is written only after a long stationary
+  *                 period and at most once per GYRO_BIAS_SAVE_PERIOD to avoid wear.
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          ˾ֹʱƯ. ̵ֹǷСʱ, һ
+  *                 (GYRO_BIAS_WINDOW)Ϊֹ, Ѵھֵһgyro_cali.offset,
+  *                 ϴֶУ׼Ưgyro_cali.cali_offset, αҲۻƫ.
+  *                 ʱ侲ֹдflash, ÿGYRO_BIAS_SAVE_PERIODһ, ĥ.
+  * @param[in]      none
+  * @retval         none
+  */
+static void cali_gyro_bias_track(void)
+{
+    static fp32     sum[3];
+    static fp32     sum_sq[3];
+    static uint16_t count = 0;
+    const fp32 *gyro;
+    uint32_t now;
+    uint8_t game_progress;
+    uint8_t i;
+
+    //not during calibration, and only refine a calibrated gyro
+    //У׼в, ֻУ׼
+    for (i = 0; i < CALI_LIST_LENGHT; i++)
+    {
+        if (cali_sensor[i].cali_cmd)
+        {
+            count = 0;
+            gyro_still_tick = 0;
+            return;
+        }
+    }
+    if (cali_sensor[CALI_GYRO].cali_done != CALIED_FLAG)
+    {
+        return;
+    }
+
+    now = xTaskGetTickCount();
+    if (!gyro_saved_valid)
+    {
+        for (i = 0; i < 3; i++)
+        {
+            gyro_saved_offset[i] = gyro_cali.offset[i];
+        }
+        gyro_save_tick = now;
+        gyro_saved_valid = 1;
+    }
+
+    //any chassis motor turning means moving, restart the window
+    //һ̵תΪ˶, ¿ʼ
+    for (i = 0; i < GYRO_BIAS_MOTOR_NUM; i++)
+    {
+        const motor_measure_t *motor = cali_get_chassis_motor_point(i);
+        if (motor->speed_rpm > GYRO_BIAS_MOTOR_RPM || motor->speed_rpm < -GYRO_BIAS_MOTOR_RPM)
+        {
+            count = 0;
+            gyro_still_tick = 0;
+            return;
+        }
+    }
+
+    //the gyro is on the gimbal, a turning gimbal motor means the gyro is moving
+    //̨, ̨תΪ˶
+    if (cali_gimbal_motor_moving(cali_get_yaw_motor_point()) || cali_gimbal_motor_moving(cali_get_pitch_motor_point()))
+    {
+        count = 0;
+        gyro_still_tick = 0;
+        return;
+    }
+
+    //the gyro data has been corrected by the current offset, the mean is the residual bias
+    //ѾǰƯ, ֵΪʣƯ
+    gyro = cali_get_gyro_point();
+    if (count == 0)
+    {
+        for (i = 0; i < 3; i++)
+        {
+            sum[i] = 0.0f;
+            sum_sq[i] = 0.0f;
+        }
+    }
+    for (i = 0; i < 3; i++)
+    {
+        sum[i] += gyro[i];
+        sum_sq[i] += gyro[i] * gyro[i];
+    }
+    count++;
+    if (count < GYRO_BIAS_WINDOW)
+    {
+        return;
+    }
+    count = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+        fp32 mean = sum[i] / GYRO_BIAS_WINDOW;
+        fp32 var = sum_sq[i] / GYRO_BIAS_WINDOW - mean * mean;
+
+        //NaN fails the comparison and is treated as moving
+        //NaNȽΪ, Ϊ˶
+        if (!(var < GYRO_BIAS_VAR_MAX && mean * mean < GYRO_BIAS_MEAN_MAX * GYRO_BIAS_MEAN_MAX))
+        {
+            gyro_still_tick = 0;
+            return;
+        }
+    }
+
+    if (gyro_still_tick == 0)
+    {
+        gyro_still_tick = now;
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        fp32 offset = gyro_cali.offset[i] - GYRO_BIAS_GAIN * sum[i] / GYRO_BIAS_WINDOW;
+
+        if (offset > gyro_cali.cali_offset[i] + GYRO_BIAS_DRIFT_MAX)
+        {
+            offset = gyro_cali.cali_offset[i] + GYRO_BIAS_DRIFT_MAX;
+        }
+        else if (offset < gyro_cali.cali_offset[i] - GYRO_BIAS_DRIFT_MAX)
+        {
+            offset = gyro_cali.cali_offset[i] - GYRO_BIAS_DRIFT_MAX;
+        }
+        gyro_cali.offset[i] = offset;
+    }
+    gyro_set_cali(gyro_cali.scale, gyro_cali.offset);
+
+    //flash erase stalls the core, save only when still for long and not in a match, e.g. in the pit
+    //flashʹںͣ, ֻڳʱ侲ֹҲڱʱ, ά
+    if (now - gyro_save_tick < GYRO_BIAS_SAVE_PERIOD || now - gyro_still_tick < GYRO_BIAS_SAVE_STILL_TIME)
+    {
+        return;
+    }
+    game_progress = cali_get_game_progress();
+    if (game_progress != GYRO_BIAS_GAME_NOT_STARTED && game_progress != GYRO_BIAS_GAME_SETTLEMENT)
+    {
+        return;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        fp32 delta = gyro_cali.offset[i] - gyro_saved_offset[i];
+        if (delta > GYRO_BIAS_SAVE_DELTA || delta < -GYRO_BIAS_SAVE_DELTA)
+        {
+            break;
+        }
+    }
+    if (i == 3)
+    {
+        return;
+    }
+
+    cali_data_write();
+    for (i = 0; i < 3; i++)
+    {
+        gyro_saved_offset[i] = gyro_cali.offset[i];
+    }
+    gyro_save_tick = now;
+}
+
+/**
+  * @brief          check whether a gimbal motor is turning
+  * @param[in]      motor: gimbal motor feedback
+  * @retval         1: turning, 0: at rest
+  */
+/**
+  * @brief          ж̨Ƿת
+  * @param[in]      motor: ̨
+  * @retval         1: ת, 0: ֹ
+  */
+static bool_t cali_gimbal_motor_moving(const motor_measure_t *motor)
+{
+    return motor->speed_rpm > GYRO_BIAS_GIMBAL_RPM || motor->speed_rpm < -GYRO_BIAS_GIMBAL_RPM;
+}
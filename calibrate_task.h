@@ -26,13 +26,18 @@
   *                     or set to '\/', begin the gimbal calibration
   *                     or set to /''\, begin the chassis calibration
   *
-  *             data in flash, include cali data and name[3] and cali_flag
-  *             for example, head_cali has 8 bytes, and it need 12 bytes in flash. if it starts in 0x080A0000
-  *             0x080A0000-0x080A0007: head_cali data
-  *             0x080A0008: name[0]
-  *             0x080A0009: name[1]
-  *             0x080A000A: name[2]
-  *             0x080A000B: cali_flag, when cali_flag == 0x55, means head_cali has been calibrated.
+  *             data in flash, include a descriptor word, cali data and name[3] and cali_flag
+  *             for example, head_cali has 8 bytes, and it need 16 bytes in flash. if it starts in 0x080A0004
+  *             0x080A0004-0x080A0007: descriptor, data lenght, schema version and CALI_RECORD_TAG
+  *             0x080A0008-0x080A000F: head_cali data
+  *             0x080A0010: name[0]
+  *             0x080A0011: name[1]
+  *             0x080A0012: name[2]
+  *             0x080A0013: cali_flag, when cali_flag == 0x55, means head_cali has been calibrated.
+  *             the first word is CALI_IMAGE_MAGIC, the word after the last device is the CRC32 of all devices.
+  *             devices are found by name, so a new device does not move the others. when xxx_cali_t changes,
+  *             add 1 to its version and add a converter in cali_migrate_table, old records are upgraded at boot.
+  *             an image without CALI_IMAGE_MAGIC is read with the old fixed layout and rewritten.
   *             if add a sensor
   *             1.add cail sensro name in cali_id_e at calibrate_task.h, like
   *             typedef enum
@@ -50,10 +55,11 @@
   *                 uint16_t yyy;
   *                 fp32 zzz;
   *             } xxx_cali_t; //size: 8 bytes, must be 4, 8, 12, 16...
-  *             3.in "FLASH_WRITE_BUF_LENGHT", add "sizeof(xxx_cali_t)", and implement new function.
+  *             3.implement new function.
   *             bool_t cali_xxx_hook(uint32_t *cali, bool_t cmd), and add the name in "cali_name[CALI_LIST_LENGHT][3]"
   *             and declare variable xxx_cali_t xxx_cail, add the data address in cali_sensor_buf[CALI_LIST_LENGHT]
   *             and add the data lenght in cali_sensor_size, at last, add function in cali_hook_fun[CALI_LIST_LENGHT]
+  *             4.add the schema version in cali_version[CALI_LIST_LENGHT], starts at 1.
   *             ʹңпʼУ׼
   *             һ:ңض
   *             ڶ:ҡ˴\../,.\.ҡ´.
@@ -61,13 +67,17 @@
   *                    ҡ˴'\/' ʼ̨У׼
   *                    ҡ˴/''\ ʼУ׼
   *
-  *             flashУУ׼ݺ name[3]  У׼־λ cali_flag
-  *             head_caliа˸ֽ,Ҫ12ֽflash,0x080A0000ʼ
-  *             0x080A0000-0x080A0007: head_cali
-  *             0x080A0008: name[0]
-  *             0x080A0009: name[1]
-  *             0x080A000A: name[2]
-  *             0x080A000B: У׼־λ cali_flag,У׼־λΪ0x55,ζhead_caliѾУ׼
+  *             flashУ, У׼ݺ name[3]  У׼־λ cali_flag
+  *             head_caliа˸ֽ,Ҫ16ֽflash,0x080A0004ʼ
+  *             0x080A0004-0x080A0007: , ݳ, ṹ汾CALI_RECORD_TAG
+  *             0x080A0008-0x080A000F: head_cali
+  *             0x080A0010: name[0]
+  *             0x080A0011: name[1]
+  *             0x080A0012: name[2]
+  *             0x080A0013: У׼־λ cali_flag,У׼־λΪ0x55,ζhead_caliѾУ׼
+  *             һCALI_IMAGE_MAGIC, һ豸֮һ豸CRC32.
+  *             豸ֲ, 豸ƶ豸. ޸xxx_cali_tʱ, 汾1cali_migrate_table
+  *             ת, ϵʱɼ¼. ûCALI_IMAGE_MAGICľݰɵĹ̶ֶȡд.
   *             豸
   *             1.豸calibrate_task.hcali_id_e, 
   *             typedef enum
@@ -85,10 +95,11 @@
   *                 uint16_t yyy;
   *                 fp32 zzz;
   *             } xxx_cali_t; //:8ֽ 8 bytes,  4, 8, 12, 16...
-  *             3. "FLASH_WRITE_BUF_LENGHT","sizeof(xxx_cali_t)", ʵº
+  *             3.ʵº
   *             bool_t cali_xxx_hook(uint32_t *cali, bool_t cmd),  "cali_name[CALI_LIST_LENGHT][3]"
   *              xxx_cali_t xxx_cail, ӱַcali_sensor_buf[CALI_LIST_LENGHT]
   *             cali_sensor_size[CALI_LIST_LENGHT]ݳ, cali_hook_fun[CALI_LIST_LENGHT]Ӻ
+  *             4.cali_version[CALI_LIST_LENGHT]ӽṹ汾, 1ʼ
   *
   ==============================================================================
   @endverbatim
@@ -127,6 +138,21 @@
 //set the zero drift to the INS task, INS taskڵƯ
 #define gyro_set_cali(cali_scale, cali_offset)              INS_set_cali_gyro((cali_scale), (cali_offset))
 
+//get the gyro data after calibration (rad/s), ȡУ׼
+#define cali_get_gyro_point()                               get_gyro_data_point()
+//get the chassis motor feedback, ȡ̵
+#define cali_get_chassis_motor_point(i)                     get_chassis_motor_measure_point((i))
+//get the gimbal motor feedback, ȡ̨
+#define cali_get_yaw_motor_point()                          get_yaw_gimbal_motor_measure_point()
+#define cali_get_pitch_motor_point()                        get_pitch_gimbal_motor_measure_point()
+//get the game progress from referee, ȡϵͳ׶
+#define cali_get_game_progress()                            get_game_progress()
+
+//read the sweep progress of gimbal calibration, ȡ̨У׼ɨ
+#define gimbal_cali_get_progress(ckpt)                      get_cali_gimbal_progress((ckpt))
+//resume gimbal calibration from a checkpoint, axes in axis_done are skipped. Ӽ̨У׼, axis_doneе
+#define gimbal_cali_resume(ckpt)                            set_cali_gimbal_progress((ckpt))
+
 
 
 #define FLASH_USER_ADDR         ADDR_FLASH_SECTOR_9 //write flash page 9,flashҳַ
@@ -140,6 +166,40 @@
 
 #define CALI_SENSOR_HEAD_LEGHT  1
 
+#define CALI_CRC_POLY           0x04C11DB7          //CRC32 poly, same as the STM32 CRC unit. CRC32ʽ, STM32ӲCRCһ
+#define CALI_CRC_INIT           0xFFFFFFFF          //CRC32 init value. CRC32ʼֵ
+#define CALI_CRC_EMPTY          0xFFFFFFFF          //erased flash, no CRC has been written. flashֵ, δдCRC
+
+#define CALI_IMAGE_MAGIC        0x32494C43          //"CLI2", first word of an image with record descriptors. ݵ
+#define CALI_RECORD_TAG         0xCA1B              //descriptor tag, the records end at the first word without it. ֱ, ûбǼ¼
+#define CALI_RECORD_MAX_LENGHT  64                  //max data lenght of a record, unit: word. ¼ݳ, λ: 
+#define CALI_RECORD_MAX_NUM     16                  //max records read at boot. ϵȡļ¼
+#define CALI_LEGACY_VERSION     1                   //records of an image without CALI_IMAGE_MAGIC. ûCALI_IMAGE_MAGICľݵĽṹ汾
+
+//schema version of every device, add 1 and a converter in cali_migrate_table when the struct changes
+//豸ݽṹ汾, ޸Ľṹʱ1cali_migrate_tableת
+#define CALI_HEAD_VERSION       1
+#define CALI_GIMBAL_VERSION     1
+#define CALI_IMU_VERSION        1
+#define CALI_GYRO_VERSION       2                   //v2 adds cali_offset. v2cali_offset
+#define CALI_SUPERCAP_EFF_VERSION 1
+
+//gimbal calibration checkpoints are appended behind the cali data in the same page, without erasing.
+//cali_data_write erases the page, so a finished calibration clears them.
+//inactive until gimbal_task.c implements get_cali_gimbal_progress/set_cali_gimbal_progress: with the weak
+//defaults no checkpoint is saved and every axis is swept again.
+//̨У׼׷дͬһҳУ׼֮, . cali_data_writeҳ, У׼ɼ
+//gimbal_task.cʵget_cali_gimbal_progress/set_cali_gimbal_progress֮ǰЧ: ², ɨ
+#define CALI_CKPT_OFFSET        0x1000              //checkpoint area offset from FLASH_USER_ADDR. FLASH_USER_ADDRƫ
+#define CALI_CKPT_SIZE          0x1000              //checkpoint area size. С
+#define CALI_CKPT_PERIOD        1000                //save at least every 1s while sweeping. ɨÿ1sһ
+#define GIMBAL_CALI_AXIS_PITCH  0x01                //axis_done bit, pitch
+#define GIMBAL_CALI_AXIS_YAW    0x02                //axis_done bit, yaw
+#define CALI_CKPT_MAX_BOOTS     1                   //a checkpoint is resumed after at most 1 reboot. 1
+#define GIMBAL_CALI_MIN_SPAN    0.1f                //stored limits with a smaller span are invalid (rad). λСڸֵЧ
+#define GIMBAL_CALI_MAX_SPAN    6.2831853f          //stored limits with a bigger span are invalid (rad). λȴڸֵЧ
+#define GIMBAL_CALI_ECD_RANGE   8192                //motor encoder range. Χ
+
 #define SELF_ID                 0                   //ID 
 #define FIRMWARE_VERSION        12345               //handware version.
 #define CALIED_FLAG             0x55                // means it has been calibrated
@@ -162,6 +222,21 @@
 
 #define GYRO_CALIBRATE_TIME         20000   //gyro calibrate time,У׼ʱ
 
+//runtime gyro bias tracking while the robot is still, ֹʱ߸Ư
+#define GYRO_BIAS_WINDOW            500     //samples of a stationary window (ms). ֹжϴ
+#define GYRO_BIAS_MOTOR_NUM         4       //chassis motors which must be at rest. 農ֹĵ̵
+#define GYRO_BIAS_MOTOR_RPM         30      //motor speed below this is at rest (rpm). תٵڸֵΪֹ
+#define GYRO_BIAS_GIMBAL_RPM        2       //gimbal motor speed below this is at rest (rpm). ̨תٵڸֵΪֹ
+#define GYRO_BIAS_VAR_MAX           1.0e-5f //gyro variance in a window below this is still ((rad/s)^2). ڷڸֵΪֹ
+#define GYRO_BIAS_MEAN_MAX          0.005f  //a window mean above this is motion, not bias (rad/s). ھֵֵΪ˶Ư
+#define GYRO_BIAS_GAIN              0.1f    //part of the window mean moved into offset. ÿֵı
+#define GYRO_BIAS_DRIFT_MAX         0.003f  //offset may move at most this far from the last explicit calibration (rad/s). ϴֶУ׼Ư
+#define GYRO_BIAS_SAVE_DELTA        0.002f  //save when offset moved this far from the saved one (rad/s). ֵű
+#define GYRO_BIAS_SAVE_STILL_TIME   30000   //save only after being still this long, e.g. in the pit (ms). ֹʱű, ά
+#define GYRO_BIAS_SAVE_PERIOD       1800000 //at most one save every 30 min (ms). ÿ30ӱһ
+#define GYRO_BIAS_GAME_NOT_STARTED  0       //referee game progress, no match. ϵͳ׶: δʼ
+#define GYRO_BIAS_GAME_SETTLEMENT   5       //referee game progress, match is over. ϵͳ׶: 
+
 //cali device name
 typedef enum
 {
@@ -170,6 +245,9 @@ typedef enum
     CALI_GYRO = 2,
     CALI_ACC = 3,
     CALI_MAG = 4,
+    //supercap efficiency map, one record per board. Чʱ, ÿһ¼
+    CALI_SUPERCAP_EFF = 5,
+    CALI_SUPERCAP_EFF1 = 6,
     //add more...
     CALI_LIST_LENGHT,
 } cali_id_e;
@@ -185,6 +263,26 @@ typedef __packed struct
     bool_t (*cali_hook)(uint32_t *point, bool_t cmd);   //cali function
 } cali_sensor_t;
 
+//the word before the data of every device in flash
+//flashÿ豸ǰ
+typedef __packed struct
+{
+    uint8_t len;                                        //data lenght, unit: word
+    uint8_t version;                                    //schema version of the data
+    uint16_t tag;                                       //CALI_RECORD_TAG
+} cali_record_desc_t;
+
+//converter from one schema version to the next
+//һṹ汾һ汾ת
+typedef struct
+{
+    uint8_t id;                                         //cali_id_e
+    uint8_t from_version;                               //upgrade from this version to from_version + 1
+    uint8_t from_len;                                   //data lenght of from_version, unit: word
+    uint8_t to_len;                                     //data lenght of from_version + 1, unit: word
+    void (*migrate)(uint32_t *buf);                     //convert in place, buf has CALI_RECORD_MAX_LENGHT words
+} cali_migrate_t;
+
 //header device
 typedef __packed struct
 {
@@ -205,12 +303,29 @@ typedef struct
     fp32 pitch_max_angle;
     fp32 pitch_min_angle;
 } gimbal_cali_t;
+//gimbal calibration checkpoint
+//̨У׼
+typedef struct
+{
+    gimbal_cali_t cali;         // values found so far. ҵֵ
+    uint16_t sweep_ecd;         // encoder position of the running sweep. ǰɨıλ
+    uint8_t step;               // sweep step of gimbal task. ̨ɨ貽
+    uint8_t axis_done;          // GIMBAL_CALI_AXIS_PITCH | GIMBAL_CALI_AXIS_YAW
+} gimbal_cali_ckpt_t;
 //gyro, accel, mag device
 typedef struct
 {
     fp32 offset[3]; //x,y,z
     fp32 scale[3];  //x,y,z
 } imu_cali_t;
+//gyro device, starts like imu_cali_t
+//豸, ǰimu_cali_tͬ
+typedef struct
+{
+    fp32 offset[3];         //x,y,z, refined by bias tracking. Ưֵ
+    fp32 scale[3];          //x,y,z
+    fp32 cali_offset[3];    //offset of the last explicit calibration, the bound of bias tracking. ϴֶУ׼Ư, ƯٵĻ׼
+} gyro_cali_t;
 
 
 /**
@@ -260,5 +375,68 @@ extern void get_flash_latitude(float *latitude);
   */
 extern void calibrate_task(void const *pvParameters);
 
+/**
+  * @brief          one step of calibration, call every 1ms. used by calibrate_task or
+  *                 the low-rate executor when calibrate_task is not created
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          У׼, ÿ1msһ. calibrate_task, ڲ
+  *                 calibrate_taskʱɵִ
+  * @param[in]      none
+  * @retval         none
+  */
+extern void cali_lowrate_job(void);
+
+/**
+  * @brief          save the learned supercap efficiency map to flash. it erases the flash page,
+  *                 call between matches only
+  * @param[in]      none
+  * @retval         none
+  */
+/**
+  * @brief          ѧϰĳЧʱflash. flashҳ, ֻڱ϶
+  * @param[in]      none
+  * @retval         none
+  */
+extern void cali_supercap_eff_save(void);
+
+/**
+  * @brief          read the sweep progress of gimbal calibration, provided by gimbal task.
+  *                 the weak default in calibrate_task.c reports no progress, nothing is saved.
+  *                 gimbal_task.c does not implement it yet, so checkpointing is inactive.
+  *                 an implementation fills cali with the limits found so far, step/sweep_ecd with
+  *                 the running sweep and sets the axis_done bit once an axis is finished
+  * @param[out]     ckpt: sweep progress
+  * @retval         none
+  */
+/**
+  * @brief          ȡ̨У׼ɨ, ̨ṩ.
+  *                 calibrate_task.cе岻, .
+  *                 gimbal_task.cδʵ, 㹦ܲЧ.
+  *                 ʵʱcaliҵλ, step/sweep_ecdǰɨ, һɺaxis_doneӦλ
+  * @param[out]     ckpt: ɨ
+  * @retval         none
+  */
+extern void get_cali_gimbal_progress(gimbal_cali_ckpt_t *ckpt);
+
+/**
+  * @brief          resume gimbal calibration from a checkpoint, provided by gimbal task.
+  *                 the weak default in calibrate_task.c ignores it, every axis is swept.
+  *                 gimbal_task.c does not implement it yet. an implementation copies the limits of
+  *                 the axes in axis_done, skips their sweep and continues the other axis from step/sweep_ecd
+  * @param[in]      ckpt: checkpoint
+  * @retval         none
+  */
+/**
+  * @brief          Ӽ̨У׼, ̨ṩ.
+  *                 calibrate_task.cеԼ, ɨ.
+  *                 gimbal_task.cδʵ. ʵʱaxis_doneиλɨ, һstep/sweep_ecd
+  * @param[in]      ckpt: 
+  * @retval         none
+  */
+extern void set_cali_gimbal_progress(const gimbal_cali_ckpt_t *ckpt);
+
 
 #endif
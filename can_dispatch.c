@@ -0,0 +1,114 @@
+/**
+ * @file can_dispatch.c
+ * @brief CAN接收O(1)分发表
+ */
+
+#include "can_dispatch.h"
+#include "profile.h"
+
+typedef void (*can_rx_handler_t)(uint32_t std_id, uint8_t *data);
+
+// ID -> 路由, 编译期由 CAN_RX_ROUTE_LIST 生成 (GCC范围初始化)
+static const uint8_t can_rx_route[CAN_STD_ID_NUM] = {
+#define CAN_ROUTE_TABLE(name, base, count, handler) [(base) ... ((base) + (count) - 1)] = CAN_ROUTE_##name,
+    CAN_RX_ROUTE_LIST(CAN_ROUTE_TABLE)
+#undef CAN_ROUTE_TABLE
+};
+
+// 路由 -> 处理函数
+static const can_rx_handler_t can_rx_handler[CAN_ROUTE_NUM] = {
+    NULL,
+#define CAN_ROUTE_HANDLER(name, base, count, handler) handler,
+    CAN_RX_ROUTE_LIST(CAN_ROUTE_HANDLER)
+#undef CAN_ROUTE_HANDLER
+};
+
+// 路由 -> ID范围, 用于配置过滤器
+static const uint16_t can_rx_route_base[CAN_ROUTE_NUM] = {
+    0,
+#define CAN_ROUTE_BASE(name, base, count, handler) (base),
+    CAN_RX_ROUTE_LIST(CAN_ROUTE_BASE)
+#undef CAN_ROUTE_BASE
+};
+
+static const uint16_t can_rx_route_count[CAN_ROUTE_NUM] = {
+    0,
+#define CAN_ROUTE_COUNT(name, base, count, handler) (count),
+    CAN_RX_ROUTE_LIST(CAN_ROUTE_COUNT)
+#undef CAN_ROUTE_COUNT
+};
+
+/**
+ * @brief 超电接收处理
+ */
+void can_supercap_rx_handler(uint32_t std_id, uint8_t *data)
+{
+    SuperCapCanRxHandler(std_id, data);
+}
+
+/**
+ * @brief 按路由表配置硬件过滤器
+ */
+int8_t can_dispatch_filter_init(CAN_HandleTypeDef *hcan, uint8_t bank_start)
+{
+    CAN_FilterTypeDef can_filter_st;
+    uint8_t route;
+
+    if (bank_start + CAN_ROUTE_NUM - 1 > CAN_FILTER_BANK_MAX)
+    {
+        return -1;
+    }
+
+    for (route = 1; route < CAN_ROUTE_NUM; route++)
+    {
+        uint16_t first = can_rx_route_base[route];
+        uint16_t last = first + can_rx_route_count[route] - 1;
+        uint16_t mask = 0x7FF;
+
+        // 找到同时覆盖first和last的最小对齐块
+        while ((first & mask) != (last & mask))
+        {
+            mask = (mask << 1) & 0x7FF;
+        }
+
+        can_filter_st.FilterActivation = ENABLE;
+        can_filter_st.FilterMode = CAN_FILTERMODE_IDMASK;
+        can_filter_st.FilterScale = CAN_FILTERSCALE_32BIT;
+        can_filter_st.FilterIdHigh = (uint32_t)(first & mask) << 5;
+        can_filter_st.FilterIdLow = 0x0000;
+        can_filter_st.FilterMaskIdHigh = (uint32_t)mask << 5;
+        can_filter_st.FilterMaskIdLow = 0x0004; // IDE=0, 只收标准帧
+        can_filter_st.FilterBank = bank_start + route - 1;
+        can_filter_st.FilterFIFOAssignment = CAN_RX_FIFO0;
+        can_filter_st.SlaveStartFilterBank = CAN_SLAVE_START_BANK;
+        if (HAL_CAN_ConfigFilter(hcan, &can_filter_st) != HAL_OK)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief CAN接收分发
+ */
+void can_dispatch(uint32_t std_id, uint8_t *data)
+{
+    uint8_t route;
+
+    // 先判断范围再开始计时, 提前返回不会留下未结束的探针
+    if (std_id >= CAN_STD_ID_NUM)
+    {
+        return;
+    }
+
+    PROFILE_BEGIN(PROFILE_CAN_DISPATCH);
+    route = can_rx_route[std_id];
+    PROFILE_END(PROFILE_CAN_DISPATCH);
+
+    if (route != CAN_ROUTE_NONE)
+    {
+        can_rx_handler[route](std_id, data);
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * @file can_dispatch.h
+ * @brief CAN接收O(1)分发表
+ * @note 路由表由 CAN_RX_ROUTE_LIST 在编译期生成: 11位标准ID直接下标查表得到处理函数,
+ *       硬件过滤器也由同一张表配置. CAN接收中断里只需调用 can_dispatch().
+ *       新增ID在 CAN_RX_ROUTE_LIST 中加一行. 过滤器按覆盖该范围的最小 2^n 对齐块放行,
+ *       块内不属于路由的ID由查表丢弃.
+ */
+
+#ifndef CAN_DISPATCH_H
+#define CAN_DISPATCH_H
+#include "struct_typedef.h"
+#include "main.h"
+#include "super_cap.h"
+
+#define CAN_STD_ID_NUM          0x800   // 11位标准ID数量
+#define CAN_FILTER_BANK_MAX     28      // 过滤器组总数
+#define CAN_SLAVE_START_BANK    14      // CAN2起始过滤器组, CAN1用0-13, CAN2用14-27
+
+// 底盘/云台电机反馈处理 (实现在 CAN_receive.c, 解析到对应 motor_measure_t)
+extern void CAN_motor_rx_handler(uint32_t std_id, uint8_t *data);
+
+// 路由表: X(名字, 起始ID, ID数量, 处理函数)
+#define CAN_RX_ROUTE_LIST(X)                                                                \
+    X(SUPERCAP, SUPERCAP_RX_ID_BASE, SUPERCAP_RX_ID_GROUP_SIZE * 3, can_supercap_rx_handler) \
+    X(MOTOR,    0x201,               8,                             CAN_motor_rx_handler)    \
+    //add more...
+
+typedef enum
+{
+    CAN_ROUTE_NONE = 0,
+#define CAN_ROUTE_ENUM(name, base, count, handler) CAN_ROUTE_##name,
+    CAN_RX_ROUTE_LIST(CAN_ROUTE_ENUM)
+#undef CAN_ROUTE_ENUM
+    CAN_ROUTE_NUM,
+} can_route_e;
+
+/**
+ * @brief 超电接收处理, 适配分发表的函数签名
+ * @param std_id CAN标准ID
+ * @param data 8字节数据
+ */
+extern void can_supercap_rx_handler(uint32_t std_id, uint8_t *data);
+
+/**
+ * @brief 按路由表配置硬件过滤器, 每条路由占用一个32位掩码过滤器组
+ * @param hcan CAN句柄
+ * @param bank_start 起始过滤器组
+ * @retval 0=成功, -1=过滤器组不足或配置失败
+ */
+extern int8_t can_dispatch_filter_init(CAN_HandleTypeDef *hcan, uint8_t bank_start);
+
+/**
+ * @brief CAN接收分发, 在接收中断中调用, 查表时间与路由数量无关
+ * @param std_id CAN标准ID
+ * @param data 8字节数据
+ */
+extern void can_dispatch(uint32_t std_id, uint8_t *data);
+
+#endif
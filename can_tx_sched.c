@@ -0,0 +1,309 @@
+/**
+ * @file can_tx_sched.c
+ * @brief CAN发送软件队列
+ * @note 队列由任务和发送完成中断共同访问, 操作时关中断, 临界区只有一次线性扫描.
+ */
+
+#include "can_tx_sched.h"
+#include <string.h>
+
+typedef struct
+{
+    uint32_t std_id;
+    uint32_t submit_tick;       // 首次提交时刻 (ms), 合并时保留
+    uint32_t deadline;          // 截止时刻 (ms)
+    uint8_t data[8];
+    uint8_t dlc;
+    uint8_t prio;
+    uint8_t used;
+} can_tx_item_t;
+
+typedef struct
+{
+    CAN_HandleTypeDef *hcan;
+    can_tx_item_t item[CAN_TX_QUEUE_LEN];
+    can_tx_stats_t stats;
+} can_tx_queue_t;
+
+static can_tx_queue_t can_tx_queue[CAN_TX_HANDLE_NUM];
+
+/**
+ * @brief 按句柄查找队列
+ */
+static can_tx_queue_t *can_tx_find(CAN_HandleTypeDef *hcan)
+{
+    uint8_t i;
+
+    for (i = 0; i < CAN_TX_HANDLE_NUM; i++)
+    {
+        if (can_tx_queue[i].hcan == hcan)
+        {
+            return &can_tx_queue[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief a比b更应先发: 优先级高者先, 同优先级截止时间早者先
+ */
+static uint8_t can_tx_before(const can_tx_item_t *a, const can_tx_item_t *b)
+{
+    if (a->prio != b->prio)
+    {
+        return a->prio < b->prio;
+    }
+    return (int32_t)(a->deadline - b->deadline) < 0;
+}
+
+/**
+ * @brief 把队列中的帧装入空闲邮箱, 调用时已关中断
+ */
+static void can_tx_refill(can_tx_queue_t *queue)
+{
+    CAN_TxHeaderTypeDef tx_header;
+    uint32_t mailbox;
+    uint32_t now = HAL_GetTick();
+
+    tx_header.IDE = CAN_ID_STD;
+    tx_header.RTR = CAN_RTR_DATA;
+    tx_header.ExtId = 0;
+    tx_header.TransmitGlobalTime = DISABLE;
+
+    while (queue->stats.depth != 0)
+    {
+        uint32_t free_level = HAL_CAN_GetTxMailboxesFreeLevel(queue->hcan);
+        can_tx_item_t *best = NULL;
+        uint32_t wait;
+        uint8_t i;
+
+        if (free_level == 0)
+        {
+            return;
+        }
+
+        for (i = 0; i < CAN_TX_QUEUE_LEN; i++)
+        {
+            if (queue->item[i].used && (best == NULL || can_tx_before(&queue->item[i], best)))
+            {
+                best = &queue->item[i];
+            }
+        }
+
+        // 普通帧不占用预留邮箱
+        if (best->prio != CAN_TX_PRIO_URGENT && free_level <= CAN_TX_RESERVED_MAILBOX)
+        {
+            return;
+        }
+
+        tx_header.StdId = best->std_id;
+        tx_header.DLC = best->dlc;
+        if (HAL_CAN_AddTxMessage(queue->hcan, &tx_header, best->data, &mailbox) != HAL_OK)
+        {
+            return;
+        }
+
+        wait = now - best->submit_tick;
+        if (wait > queue->stats.wait_max[best->prio])
+        {
+            queue->stats.wait_max[best->prio] = wait;
+        }
+        if ((int32_t)(now - best->deadline) > 0)
+        {
+            queue->stats.deadline_miss[best->prio]++;
+        }
+        best->used = 0;
+        queue->stats.depth--;
+        queue->stats.sent++;
+    }
+}
+
+/**
+ * @brief 初始化一路CAN的发送队列
+ */
+int8_t can_tx_init(CAN_HandleTypeDef *hcan)
+{
+    can_tx_queue_t *queue = can_tx_find(hcan);
+
+    if (queue == NULL)
+    {
+        queue = can_tx_find(NULL);
+        if (queue == NULL)
+        {
+            return -1;
+        }
+    }
+
+    memset(queue, 0, sizeof(can_tx_queue_t));
+    queue->hcan = hcan;
+    HAL_CAN_ActivateNotification(hcan, CAN_IT_TX_MAILBOX_EMPTY);
+    return 0;
+}
+
+/**
+ * @brief 提交一帧
+ */
+int8_t can_tx_submit(CAN_HandleTypeDef *hcan, uint32_t std_id, const uint8_t *data, uint8_t dlc,
+                     can_tx_prio_e prio, uint16_t deadline)
+{
+    can_tx_queue_t *queue = can_tx_find(hcan);
+    can_tx_item_t *slot = NULL;
+    uint32_t now = HAL_GetTick();
+    uint32_t primask;
+    int8_t ret = 0;
+    uint8_t i;
+
+    if (queue == NULL || hcan == NULL || dlc > 8 || prio >= CAN_TX_PRIO_NUM)
+    {
+        return -1;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    queue->stats.submitted++;
+
+    // 同ID合并
+    for (i = 0; i < CAN_TX_QUEUE_LEN; i++)
+    {
+        if (queue->item[i].used && queue->item[i].std_id == std_id)
+        {
+            slot = &queue->item[i];
+            queue->stats.merged++;
+            if ((int32_t)(now + deadline - slot->deadline) < 0)
+            {
+                slot->deadline = now + deadline;
+            }
+            if (prio < slot->prio)
+            {
+                slot->prio = prio;
+            }
+            break;
+        }
+    }
+
+    if (slot == NULL)
+    {
+        for (i = 0; i < CAN_TX_QUEUE_LEN; i++)
+        {
+            if (!queue->item[i].used)
+            {
+                slot = &queue->item[i];
+                break;
+            }
+        }
+
+        // 队列满时紧急帧挤掉截止时间最晚的普通帧
+        if (slot == NULL && prio == CAN_TX_PRIO_URGENT)
+        {
+            for (i = 0; i < CAN_TX_QUEUE_LEN; i++)
+            {
+                if (queue->item[i].prio != CAN_TX_PRIO_URGENT &&
+                    (slot == NULL || (int32_t)(queue->item[i].deadline - slot->deadline) > 0))
+                {
+                    slot = &queue->item[i];
+                }
+            }
+            if (slot != NULL)
+            {
+                slot->used = 0;
+                queue->stats.depth--;
+                queue->stats.overflow++;
+            }
+        }
+
+        if (slot == NULL)
+        {
+            queue->stats.overflow++;
+            ret = -1;
+        }
+        else
+        {
+            slot->std_id = std_id;
+            slot->submit_tick = now;
+            slot->deadline = now + deadline;
+            slot->prio = prio;
+            slot->used = 1;
+            queue->stats.depth++;
+            if (queue->stats.depth > queue->stats.depth_max)
+            {
+                queue->stats.depth_max = queue->stats.depth;
+            }
+        }
+    }
+
+    if (slot != NULL)
+    {
+        memcpy(slot->data, data, dlc);
+        slot->dlc = dlc;
+    }
+
+    can_tx_refill(queue);
+
+    __set_PRIMASK(primask);
+    return ret;
+}
+
+/**
+ * @brief 提交超电命令
+ */
+int8_t can_tx_supercap(CAN_HandleTypeDef *hcan, SuperCap_Instance *inst)
+{
+    if (inst == NULL)
+    {
+        return -1;
+    }
+
+    SuperCapInstanceTxPrepare(inst);
+    return can_tx_submit(hcan, SUPERCAP_TX_ID_BASE + inst->index, (const uint8_t *)&inst->tx,
+                         sizeof(SuperCap_TX_Msg_send), CAN_TX_PRIO_URGENT, CAN_TX_SUPERCAP_DEADLINE);
+}
+
+/**
+ * @brief 获取发送统计
+ */
+const can_tx_stats_t *can_tx_get_stats(CAN_HandleTypeDef *hcan)
+{
+    can_tx_queue_t *queue = can_tx_find(hcan);
+
+    if (queue == NULL || hcan == NULL)
+    {
+        return NULL;
+    }
+    return &queue->stats;
+}
+
+/**
+ * @brief 发送完成中断, 补充邮箱
+ */
+static void can_tx_complete(CAN_HandleTypeDef *hcan)
+{
+    can_tx_queue_t *queue = can_tx_find(hcan);
+    uint32_t primask;
+
+    if (queue == NULL || hcan == NULL)
+    {
+        return;
+    }
+
+    // 更高优先级的中断也可能提交
+    primask = __get_PRIMASK();
+    __disable_irq();
+    can_tx_refill(queue);
+    __set_PRIMASK(primask);
+}
+
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan)
+{
+    can_tx_complete(hcan);
+}
+
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan)
+{
+    can_tx_complete(hcan);
+}
+
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan)
+{
+    can_tx_complete(hcan);
+}
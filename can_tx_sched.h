@@ -0,0 +1,87 @@
+/**
+ * @file can_tx_sched.h
+ * @brief CAN发送软件队列, 按优先级和截止时间装入发送邮箱
+ * @note 发送不再直接调用 HAL_CAN_AddTxMessage, 先进入软件队列, 由提交时和发送完成中断
+ *       装入空闲邮箱. 同ID帧在队列中合并, 只保留最新数据 (电机电流与超电命令都是状态量).
+ *       CAN_TX_RESERVED_MAILBOX 个邮箱只给紧急帧使用, 普通帧占不满三个邮箱.
+ *       紧急帧 (超电0x061+n) 进入预留邮箱后, 最坏发送延迟为总线上正在发送的一帧
+ *       加上ID更小的待发帧, 与电机帧的负载无关.
+ *       集成要求:
+ *       1. CubeMX 中打开 CAN1_TX_IRQn / CAN2_TX_IRQn 中断, stm32f4xx_it.c 的
+ *          CAN1_TX_IRQHandler / CAN2_TX_IRQHandler 调用 HAL_CAN_IRQHandler, 否则发送完成
+ *          回调不会执行, 队列只在下次提交时才继续装邮箱.
+ *       2. 预留邮箱的保证只在所有发送都经过本队列时成立. CAN_receive.c 中直接调用
+ *          HAL_CAN_AddTxMessage 的 CAN_cmd_chassis / CAN_cmd_gimbal 等须改为 can_tx_submit,
+ *          否则绕过队列的帧可以占满三个邮箱.
+ */
+
+#ifndef CAN_TX_SCHED_H
+#define CAN_TX_SCHED_H
+#include "struct_typedef.h"
+#include "main.h"
+#include "super_cap.h"
+
+#define CAN_TX_HANDLE_NUM           2       // CAN1/CAN2
+#define CAN_TX_QUEUE_LEN            8       // 每路CAN软件队列长度
+#define CAN_TX_MAILBOX_NUM          3       // bxCAN发送邮箱数
+#define CAN_TX_RESERVED_MAILBOX     1       // 只给紧急帧使用的邮箱数
+
+#define CAN_TX_SUPERCAP_DEADLINE    2       // 超电命令截止时间 (ms)
+#define CAN_TX_MOTOR_DEADLINE       1       // 电机电流帧截止时间 (ms)
+
+typedef enum
+{
+    CAN_TX_PRIO_URGENT = 0,     // 紧急, 可使用预留邮箱
+    CAN_TX_PRIO_NORMAL,         // 普通
+    CAN_TX_PRIO_NUM,
+} can_tx_prio_e;
+
+// 发送统计
+typedef struct
+{
+    uint32_t submitted;                     // 提交帧数
+    uint32_t sent;                          // 装入邮箱帧数
+    uint32_t merged;                        // 未发出就被同ID新帧覆盖的帧数
+    uint32_t overflow;                      // 队列满丢弃的帧数
+    uint32_t deadline_miss[CAN_TX_PRIO_NUM];// 超过截止时间才装入邮箱的帧数
+    uint32_t wait_max[CAN_TX_PRIO_NUM];     // 最大排队时间 (ms)
+    uint8_t depth;                          // 当前队列深度
+    uint8_t depth_max;                      // 最大队列深度
+} can_tx_stats_t;
+
+/**
+ * @brief 初始化一路CAN的发送队列, 并打开发送邮箱空中断
+ * @param hcan CAN句柄
+ * @retval 0=成功, -1=已无空闲队列
+ */
+extern int8_t can_tx_init(CAN_HandleTypeDef *hcan);
+
+/**
+ * @brief 提交一帧, 队列中已有同ID帧时覆盖其数据, 截止时间取两者中较早的
+ * @param hcan CAN句柄
+ * @param std_id CAN标准ID
+ * @param data 数据
+ * @param dlc 数据长度 (0-8)
+ * @param prio 优先级
+ * @param deadline 截止时间, 相对当前时刻 (ms)
+ * @retval 0=成功, -1=未初始化或队列已满
+ */
+extern int8_t can_tx_submit(CAN_HandleTypeDef *hcan, uint32_t std_id, const uint8_t *data, uint8_t dlc,
+                            can_tx_prio_e prio, uint16_t deadline);
+
+/**
+ * @brief 提交超电实例的0x061命令 (紧急), 提交前调用 SuperCapInstanceTxPrepare
+ * @param hcan CAN句柄
+ * @param inst 超电实例
+ * @retval 0=成功, -1=失败
+ */
+extern int8_t can_tx_supercap(CAN_HandleTypeDef *hcan, SuperCap_Instance *inst);
+
+/**
+ * @brief 获取发送统计
+ * @param hcan CAN句柄
+ * @retval 统计指针, 未初始化返回NULL
+ */
+extern const can_tx_stats_t *can_tx_get_stats(CAN_HandleTypeDef *hcan);
+
+#endif
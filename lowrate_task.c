@@ -0,0 +1,131 @@
+/**
+ * @file lowrate_task.c
+ * @brief 低速协作执行器
+ */
+
+#include "lowrate_task.h"
+#include "cmsis_os.h"
+#include "calibrate_task.h"
+#include "super_cap.h"
+#include "profile.h"
+
+#define LOWRATE_US_TO_CYCLES(us)    ((us) * PROFILE_CYCLES_PER_US)
+
+// 任务表: 函数, 周期(ms), 预算, 原独立任务栈(字)
+// 校准写flash时会擦除扇区, 远超预算, 仅在场下校准时出现
+// 超电链路监控原先在其他任务循环中调用, 没有独立任务, 栈记为0
+static lowrate_job_t lowrate_job[LOWRATE_JOB_NUM] = {
+    {cali_lowrate_job, 1, LOWRATE_US_TO_CYCLES(200), 512},
+    {SuperCapLinkMonitor, 10, LOWRATE_US_TO_CYCLES(20), 0},
+};
+
+static uint32_t lowrate_wakeups;
+
+#if INCLUDE_uxTaskGetStackHighWaterMark
+uint32_t lowrate_task_stack;
+#endif
+
+#if LOWRATE_STACK_WORDS < 128
+#error "LOWRATE_STACK_WORDS below configMINIMAL_STACK_SIZE"
+#endif
+
+/**
+ * @brief 低速执行器任务
+ */
+void lowrate_task(void const *pvParameters)
+{
+    uint8_t i;
+
+    profile_init();
+
+    while (1)
+    {
+        uint32_t now = xTaskGetTickCount();
+
+        for (i = 0; i < LOWRATE_JOB_NUM; i++)
+        {
+            lowrate_job_t *job = &lowrate_job[i];
+            uint32_t start;
+            uint32_t cycles;
+
+            if ((int32_t)(now - job->next_tick) < 0)
+            {
+                continue;
+            }
+
+            start = profile_cycles();
+            job->run();
+            cycles = profile_cycles() - start;
+
+            job->runs++;
+            if (cycles > job->worst)
+            {
+                job->worst = cycles;
+            }
+            if (cycles > job->budget)
+            {
+                job->overruns++;
+            }
+
+            job->next_tick += job->period;
+            //fell behind (e.g. flash erase), skip the missed periods instead of bursting
+            if ((int32_t)(now - job->next_tick) >= 0)
+            {
+                job->next_tick = now + job->period;
+            }
+        }
+
+        lowrate_wakeups++;
+        osDelay(LOWRATE_TICK_TIME);
+#if INCLUDE_uxTaskGetStackHighWaterMark
+        lowrate_task_stack = uxTaskGetStackHighWaterMark(NULL);
+        PROFILE_STACK(PROFILE_TASK_LOWRATE, lowrate_task_stack);
+#endif
+    }
+}
+
+/**
+ * @brief 获取单个任务的运行统计
+ */
+const lowrate_job_t *lowrate_get_job(lowrate_job_e job)
+{
+    return &lowrate_job[job];
+}
+
+/**
+ * @brief 获取执行器统计
+ */
+void lowrate_get_stats(lowrate_stats_t *stats)
+{
+    int32_t replaced_bytes = 0;
+    uint32_t replaced_runs = 0;
+    uint8_t i;
+
+    stats->wakeups = lowrate_wakeups;
+    stats->job_runs = 0;
+
+    for (i = 0; i < LOWRATE_JOB_NUM; i++)
+    {
+        stats->job_runs += lowrate_job[i].runs;
+        //only jobs that used to own a task saved a stack, a TCB and their wakeups
+        if (lowrate_job[i].replaced_stack_words != 0)
+        {
+            replaced_bytes += lowrate_job[i].replaced_stack_words * 4 + LOWRATE_TCB_BYTES;
+            replaced_runs += lowrate_job[i].runs;
+        }
+    }
+
+    // 独立任务时每次运行都是一次唤醒
+    stats->switches_saved = replaced_runs > stats->wakeups ? replaced_runs - stats->wakeups : 0;
+
+    // 执行器自身的栈和TCB要扣除, 结果可能为负
+    stats->ram_saved = replaced_bytes - (int32_t)(LOWRATE_STACK_WORDS * 4 + LOWRATE_TCB_BYTES);
+
+#if INCLUDE_uxTaskGetStackHighWaterMark
+    stats->stack_free = lowrate_task_stack;
+    stats->stack_low = lowrate_task_stack != 0 && lowrate_task_stack < LOWRATE_STACK_MIN_FREE;
+#else
+    stats->stack_free = 0;
+    stats->stack_low = 0;
+#endif
+}
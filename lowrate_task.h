@@ -0,0 +1,70 @@
+/**
+ * @file lowrate_task.h
+ * @brief 低速协作执行器: 多个低频后台任务共用一个FreeRTOS任务和栈
+ * @note 代替单独的 calibrate_task, 并承接超电链路检查. 各任务按周期被调用,
+ *       运行时间超出预算只记录不抢占, 因此任务函数必须短小且不能阻塞.
+ *       启用方法: 在 freertos.c 中用 lowrate_task 代替 calibrate_task 创建任务, 栈取 LOWRATE_STACK_WORDS.
+ *       节省的RAM来自栈的重新定尺寸: 原 calibrate_task 沿用默认的512字, 执行器按实测水位定栈.
+ */
+
+#ifndef LOWRATE_TASK_H
+#define LOWRATE_TASK_H
+#include "struct_typedef.h"
+
+#define LOWRATE_TICK_TIME           1       // 执行器周期 (ms)
+#define LOWRATE_STACK_WORDS         256     // 执行器任务栈 (字), 需与 freertos.c 一致, 按 PROFILE_TASK_LOWRATE 水位确定:
+                                            // 场下完成一次全部校准并写flash (最深调用路径) 后, 剩余字数应不低于 LOWRATE_STACK_MIN_FREE
+#define LOWRATE_STACK_MIN_FREE      48      // 栈剩余下限 (字), 留给FPU上下文保存和中断嵌套, 低于此值需加大栈
+#define LOWRATE_TCB_BYTES           96      // 每个FreeRTOS任务控制块约占RAM (字节)
+
+// 任务编号, 新增任务在此添加并在 lowrate_task.c 的任务表中登记
+typedef enum
+{
+    LOWRATE_JOB_CALIBRATE = 0,      // 遥控手势扫描 + 校准hook
+    LOWRATE_JOB_SUPERCAP_LINK,      // 超电链路监控
+    //add more...
+    LOWRATE_JOB_NUM,
+} lowrate_job_e;
+
+typedef struct
+{
+    void (*run)(void);              // 任务函数
+    uint16_t period;                // 调用周期 (ms)
+    uint32_t budget;                // 单次运行时间预算 (周期数)
+    uint16_t replaced_stack_words;  // 原先独立任务的栈大小 (字), 用于统计节省的RAM, 0=原先不是独立任务
+    uint32_t next_tick;             // 下次运行时刻
+    uint32_t runs;                  // 运行次数
+    uint32_t overruns;              // 超预算次数
+    uint32_t worst;                 // 最长运行时间 (周期数)
+} lowrate_job_t;
+
+typedef struct
+{
+    uint32_t wakeups;               // 执行器被唤醒次数
+    uint32_t job_runs;              // 所有任务运行总次数
+    uint32_t switches_saved;        // 相比原独立任务少的上下文切换次数
+    int32_t ram_saved;              // 节省的RAM (字节), 扣除执行器自身栈和TCB, 负数表示多占用
+    uint32_t stack_free;            // 执行器栈历史最小剩余 (字), 0=未测得
+    uint8_t stack_low;              // 1=剩余低于 LOWRATE_STACK_MIN_FREE, 节省的RAM不可信, 需加大栈
+} lowrate_stats_t;
+
+/**
+ * @brief 低速执行器任务, 在 freertos.c 中创建
+ * @param pvParameters: null
+ */
+extern void lowrate_task(void const *pvParameters);
+
+/**
+ * @brief 获取单个任务的运行统计
+ * @param job 任务编号
+ * @return 统计数据指针
+ */
+extern const lowrate_job_t *lowrate_get_job(lowrate_job_e job);
+
+/**
+ * @brief 获取执行器统计, 包括节省的RAM和上下文切换
+ * @param stats 输出
+ */
+extern void lowrate_get_stats(lowrate_stats_t *stats);
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * @file profile.c
+ * @brief 运行时性能统计
+ */
+
+#include "profile.h"
+
+#if defined(__arm__)
+#include "main.h"
+#else
+#include <time.h>
+#endif
+
+static const char *const profile_name[PROFILE_PROBE_NUM] = {
+    "get_supercap", "can_dispatch", "rc_cmd_to_cali", "cali_hook", "cali_data_write", "supercap_gov"};
+
+static profile_probe_t profile_probe[PROFILE_PROBE_NUM];
+static uint32_t profile_stack_free[PROFILE_TASK_NUM];
+
+/**
+ * @brief 初始化周期计数器
+ */
+void profile_init(void)
+{
+#if defined(__arm__)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * @brief 读取当前周期数
+ */
+uint32_t profile_cycles(void)
+{
+#if defined(__arm__)
+    return DWT->CYCCNT;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+/**
+ * @brief 记录一次探针耗时
+ */
+void profile_record(profile_probe_e id, uint32_t cycles)
+{
+    profile_probe_t *probe = &profile_probe[id];
+    uint8_t bin = 0;
+
+    if (probe->count == 0 || cycles < probe->min)
+    {
+        probe->min = cycles;
+    }
+    if (cycles > probe->max)
+    {
+        probe->max = cycles;
+    }
+    probe->sum += cycles;
+    probe->count++;
+
+    cycles >>= 4;
+    while (cycles != 0 && bin < PROFILE_HIST_BINS - 1)
+    {
+        cycles >>= 1;
+        bin++;
+    }
+    probe->hist[bin]++;
+}
+
+/**
+ * @brief 登记任务栈水位
+ */
+void profile_stack_record(profile_task_e task, uint32_t free_words)
+{
+    profile_stack_free[task] = free_words;
+}
+
+/**
+ * @brief 获取探针统计
+ */
+const profile_probe_t *profile_get_probe(profile_probe_e id)
+{
+    return &profile_probe[id];
+}
+
+/**
+ * @brief 获取探针名
+ */
+const char *profile_get_name(profile_probe_e id)
+{
+    return profile_name[id];
+}
+
+/**
+ * @brief 周期数换算为us, 饱和到16位
+ */
+static uint16_t profile_to_us(uint64_t cycles)
+{
+    uint64_t us = cycles / PROFILE_CYCLES_PER_US;
+    return us > 0xFFFF ? 0xFFFF : (uint16_t)us;
+}
+
+/**
+ * @brief 将一个统计条目打包为8字节CAN数据
+ */
+uint8_t profile_pack_can(uint8_t item, uint8_t data[8])
+{
+    uint16_t min = 0;
+    uint16_t mean = 0;
+    uint16_t max = 0;
+    uint8_t count = 0;
+
+    if (item < PROFILE_PROBE_NUM)
+    {
+        const profile_probe_t *probe = &profile_probe[item];
+        count = (uint8_t)probe->count;
+        if (probe->count != 0)
+        {
+            min = profile_to_us(probe->min);
+            mean = profile_to_us(probe->sum / probe->count);
+            max = profile_to_us(probe->max);
+        }
+    }
+    else if (item < PROFILE_PROBE_NUM + PROFILE_TASK_NUM)
+    {
+        uint32_t free_words = profile_stack_free[item - PROFILE_PROBE_NUM];
+        min = free_words > 0xFFFF ? 0xFFFF : (uint16_t)free_words;
+    }
+    else
+    {
+        return 0;
+    }
+
+    data[0] = item;
+    data[1] = count;
+    data[2] = (uint8_t)(min & 0xFF);
+    data[3] = (uint8_t)(min >> 8);
+    data[4] = (uint8_t)(mean & 0xFF);
+    data[5] = (uint8_t)(mean >> 8);
+    data[6] = (uint8_t)(max & 0xFF);
+    data[7] = (uint8_t)(max >> 8);
+    return 1;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file profile.h
+ * @brief 运行时性能统计: 命名探针的周期数统计与任务栈水位
+ * @note PROFILE_ENABLE 为0时所有宏展开为空, 无任何开销.
+ *       统计数据放在全局表中, Ozone等调试器可在不停核的情况下读取,
+ *       也可用 profile_pack_can() 打包后经CAN发出. 调试时切勿停核, 会使超电保护失灵.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+#include "struct_typedef.h"
+
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE          0
+#endif
+
+#define PROFILE_HIST_BINS       16      // 直方图桶数, 第n桶为 [2^(n+3), 2^(n+4)) 周期, 首尾收尾
+#define PROFILE_CYCLES_PER_US   168     // 内核频率 (MHz), 用于CAN打包时换算为us
+
+// 探针编号, 新增探针在此添加并在 profile.c 的名字表中登记
+typedef enum
+{
+    PROFILE_GET_SUPERCAP = 0,       // 超电接收解析
+    PROFILE_CAN_DISPATCH,           // CAN接收查表分发
+    PROFILE_RC_CMD_TO_CALIBRATE,    // 遥控校准手势扫描
+    PROFILE_CALI_HOOK,              // 校准hook函数
+    PROFILE_CALI_DATA_WRITE,        // 校准数据写flash
+    PROFILE_SUPERCAP_GOVERNOR,      // 功率限制预测控制, 每个裁判系统功率帧一次
+    //add more...
+    PROFILE_PROBE_NUM,
+} profile_probe_e;
+
+// 任务编号, 用于登记栈水位
+typedef enum
+{
+    PROFILE_TASK_CALIBRATE = 0,
+    PROFILE_TASK_LOWRATE,
+    //add more...
+    PROFILE_TASK_NUM,
+} profile_task_e;
+
+typedef struct
+{
+    uint32_t count;                     // 采样次数
+    uint32_t min;                       // 最小周期数
+    uint32_t max;                       // 最大周期数
+    uint64_t sum;                       // 周期数累加, 用于求均值
+    uint32_t hist[PROFILE_HIST_BINS];   // 周期数直方图
+} profile_probe_t;
+
+#if PROFILE_ENABLE
+
+#define PROFILE_INIT()                  profile_init()
+#define PROFILE_BEGIN(id)               uint32_t profile_start_##id = profile_cycles()
+#define PROFILE_END(id)                 profile_record((id), profile_cycles() - profile_start_##id)
+#define PROFILE_STACK(task, free_words) profile_stack_record((task), (free_words))
+
+#else
+
+#define PROFILE_INIT()
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id)
+#define PROFILE_STACK(task, free_words)
+
+#endif
+
+/**
+ * @brief 初始化周期计数器 (目标板为DWT, 主机为clock_gettime)
+ */
+extern void profile_init(void);
+
+/**
+ * @brief 读取当前周期数
+ * @return 周期数 (主机上为ns)
+ */
+extern uint32_t profile_cycles(void);
+
+/**
+ * @brief 记录一次探针耗时
+ * @param id 探针编号
+ * @param cycles 耗时周期数
+ */
+extern void profile_record(profile_probe_e id, uint32_t cycles);
+
+/**
+ * @brief 登记任务栈水位
+ * @param task 任务编号
+ * @param free_words 栈剩余最小值 (uxTaskGetStackHighWaterMark)
+ */
+extern void profile_stack_record(profile_task_e task, uint32_t free_words);
+
+/**
+ * @brief 获取探针统计
+ * @param id 探针编号
+ * @return 统计数据指针
+ */
+extern const profile_probe_t *profile_get_probe(profile_probe_e id);
+
+/**
+ * @brief 获取探针名
+ * @param id 探针编号
+ * @return 名字字符串
+ */
+extern const char *profile_get_name(profile_probe_e id);
+
+/**
+ * @brief 将一个统计条目打包为8字节CAN数据
+ * @param item 条目序号, 0 ~ PROFILE_PROBE_NUM-1 为探针, 之后为任务栈
+ * @param data 输出8字节:
+ *             Byte 0: item
+ *             Byte 1: 采样次数低8位
+ *             Byte 2-3: 最小值 (us), 任务栈为剩余字数
+ *             Byte 4-5: 均值 (us)
+ *             Byte 6-7: 最大值 (us)
+ * @return 1=成功, 0=序号越界
+ */
+extern uint8_t profile_pack_can(uint8_t item, uint8_t data[8]);
+
+#endif
@@ -12,10 +12,20 @@
 #include "struct_typedef.h"
 #include "CAN_receive.h"
 #include "referee.h"
+#include "supercap_event.h"
+#include "supercap_energy_table.h"
+#include "supercap_telemetry.h"
+#include "supercap_match.h"
+#include "supercap_efficiency.h"
+#include "profile.h"
 #include <string.h>
 
-uint32_t LastCapTick = 0;  // 上一次收到超电信号的时间?
-uint32_t NowCapTick = 0;   // ?次收到超电信号的时间?
+// 超电实例表, 第n块板接收ID为 SUPERCAP_RX_ID_BASE + n
+static SuperCap_Instance supercap_instance[SUPERCAP_MAX_INSTANCES];
+
+#if SUPERCAP_MAX_INSTANCES > SUPERCAP_RX_ID_GROUP_SIZE
+#error "SUPERCAP_MAX_INSTANCES exceeds the CAN ID group size"
+#endif
 
 /**
  * @brief 获取超级电?在线状?
@@ -23,15 +33,41 @@ uint32_t NowCapTick = 0;   // 
  */
 uint8_t get_supercap_online_state(void)
 {
-    NowCapTick = HAL_GetTick();
-    uint32_t DeltaCapTick = NowCapTick - LastCapTick;
+    return SuperCapInstanceOnline(&supercap_instance[0]);
+}
 
-    if (DeltaCapTick > 1000) {
-        // 超过1s?收到数据，?线
-        return 0;
-    } else {
-        return 1;
+/**
+ * @brief 接收数据合理性检查, 统计异常
+ * @param inst 超电实例
+ * @param power 本帧 chassisPower (W)
+ * @param limit 本帧 chassisPowerLimit (W)
+ * @param energy 本帧 capEnergy
+ * @param tick 本帧时间戳 (ms)
+ * @retval 1=chassisPower可用, 0=chassisPower异常应丢弃
+ */
+static uint8_t supercap_check_frame(SuperCap_Instance *inst, fp32 power, uint16_t limit, uint8_t energy, uint32_t tick)
+{
+    uint8_t power_ok = 1;
+
+    // NaN 与任何数比较都为假
+    if (!(power > -SUPERCAP_POWER_ABS_MAX && power < SUPERCAP_POWER_ABS_MAX)) {
+        inst->anomaly.badPower++;
+        power_ok = 0;
+    }
+
+    if (limit < SUPERCAP_POWER_LIMIT_MIN || limit > SUPERCAP_POWER_LIMIT_MAX) {
+        inst->anomaly.badPowerLimit++;
     }
+
+    if (inst->lastTick != 0 && tick - inst->lastTick <= SUPERCAP_OFFLINE_TIME) {
+        uint32_t jump_max = SUPERCAP_ENERGY_JUMP_BASE + (tick - inst->lastTick) * SUPERCAP_ENERGY_JUMP_PER_100MS / 100;
+        uint8_t jump = energy > inst->rx.capEnergy ? energy - inst->rx.capEnergy : inst->rx.capEnergy - energy;
+        if (jump > jump_max) {
+            inst->anomaly.energyJump++;
+        }
+    }
+
+    return power_ok;
 }
 
 /**
@@ -44,9 +80,10 @@ uint8_t get_supercap_online_state(void)
  *       Byte 5-6: chassisPowerLimit (uint16, 小???)
  *       Byte 7: capEnergy (0-255)
  */
-void get_supercap(SuperCap_Msg_get *cap, uint8_t *data)
+static void supercap_decode(uint8_t board, SuperCap_Msg_get *cap, uint8_t *data, uint32_t tick)
 {
-    LastCapTick = HAL_GetTick();
+    // errorCode 跳变检测, 瞬态故障也能被记录
+    SuperCapEventDetect(board, cap->errorCode, data[0], tick);
 
     // 直接按协?格式解析
     cap->errorCode = data[0];
@@ -61,7 +98,12 @@ void get_supercap(SuperCap_Msg_get *cap, uint8_t *data)
     float_converter.bytes[1] = data[2];
     float_converter.bytes[2] = data[3];
     float_converter.bytes[3] = data[4];
-    cap->chassisPower = float_converter.f;
+
+    // 先与上一帧比较, 再覆盖
+    if (supercap_check_frame(&supercap_instance[board], float_converter.f,
+                             (uint16_t)data[5] | ((uint16_t)data[6] << 8), data[7], tick)) {
+        cap->chassisPower = float_converter.f;
+    }
 
     // 解析uint16 (小???)
     cap->chassisPowerLimit = (uint16_t)data[5] | ((uint16_t)data[6] << 8);
@@ -70,6 +112,532 @@ void get_supercap(SuperCap_Msg_get *cap, uint8_t *data)
     cap->capEnergy = data[7];
 }
 
+/**
+ * @brief 延迟 (ms) 对应的直方图桶
+ */
+static uint8_t supercap_latency_bin(uint32_t latency)
+{
+    uint8_t bin = 0;
+
+    while (bin < SUPERCAP_LIMIT_HIST_BINS - 1 && (latency >> bin) != 0) {
+        bin++;
+    }
+    return bin;
+}
+
+/**
+ * @brief 记录下发的功率限制, 开始计时
+ * @param cap 超电发送实例, 不属于任何已注册实例时忽略
+ * @param power_limit 新功率限制 (W)
+ */
+static void supercap_limit_command(SuperCap_TX_Msg_send *cap, uint16_t power_limit)
+{
+    SuperCap_LimitTrack *track;
+    uint8_t i;
+
+    if (cap->powerLimit == power_limit) {
+        return;
+    }
+
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        if (&supercap_instance[i].tx == cap && supercap_instance[i].registered) {
+            break;
+        }
+    }
+    if (i == SUPERCAP_MAX_INSTANCES) {
+        return;
+    }
+
+    track = &supercap_instance[i].limitTrack;
+    if (track->state != 0) {
+        track->superseded++;
+    }
+    track->target = power_limit;
+    track->state = 1;
+    track->settleFrames = 0;
+    track->commandTick = HAL_GetTick();
+    track->commands++;
+}
+
+/**
+ * @brief 收到新帧后跟踪功率限制是否回显、功率是否收敛
+ * @param inst 超电实例
+ * @param tick 本帧时间戳 (ms)
+ */
+static void supercap_limit_track(SuperCap_Instance *inst, uint32_t tick)
+{
+    SuperCap_LimitTrack *track = &inst->limitTrack;
+    fp32 power = inst->rx.chassisPower;
+    uint32_t latency = tick - track->commandTick;
+    fp32 delta = power - track->lastPower;
+
+    track->lastPower = power;
+
+    // 对时后 tick 为板端采样时刻, 下发后立刻收到的帧可能早于下发时刻, 按0计
+    if ((int32_t)latency < 0) {
+        latency = 0;
+    }
+
+    if (track->state == 1) {
+        if (inst->rx.chassisPowerLimit == track->target) {
+            track->echoHist[supercap_latency_bin(latency)]++;
+            if (latency > track->echoMax) {
+                track->echoMax = latency;
+            }
+            track->state = 2;
+            track->settleFrames = 0;
+        } else if (latency > SUPERCAP_OFFLINE_TIME) {
+            track->timeouts++;
+            track->state = 0;
+        }
+        return;
+    }
+
+    if (track->state == 2) {
+        // 功率平稳且不超过新限制才算收敛, 限制上调而负载不足时平稳即可
+        if (delta < SUPERCAP_LIMIT_SETTLE_BAND && delta > -SUPERCAP_LIMIT_SETTLE_BAND &&
+            power <= (fp32)track->target + SUPERCAP_LIMIT_SETTLE_BAND) {
+            track->settleFrames++;
+        } else {
+            track->settleFrames = 0;
+        }
+
+        if (track->settleFrames >= SUPERCAP_LIMIT_SETTLE_FRAMES) {
+            track->settleHist[supercap_latency_bin(latency)]++;
+            if (latency > track->settleMax) {
+                track->settleMax = latency;
+            }
+            track->state = 0;
+        }
+    }
+}
+
+/**
+ * @brief 收到新帧后完成状态握手, 上报状态已知事件
+ * @param inst 超电实例
+ * @param tick 本帧时间戳 (ms)
+ */
+static void supercap_state_known(SuperCap_Instance *inst, uint32_t tick)
+{
+    if (inst->stateKnown) {
+        return;
+    }
+
+    inst->stateKnown = 1;
+    inst->stateKnownTick = tick;
+    inst->handshakeTime = inst->requestTick != 0 ? tick - inst->requestTick : 0;
+    inst->tx.statusRequest = 0;
+    SuperCapEventStateKnown(inst->index, inst->rx.errorCode, tick);
+}
+
+/**
+ * @brief 新帧写入实例后的公共处理: 命令生效跟踪、状态握手、历史遥测、比赛统计
+ * @param inst 超电实例
+ * @param tick 本帧测量时刻 (ms)
+ */
+static void supercap_frame_done(SuperCap_Instance *inst, uint32_t tick)
+{
+    supercap_limit_track(inst, tick);
+    supercap_state_known(inst, tick);
+    SuperCapTelemetryPush(inst->index, &inst->rx, tick);
+    SuperCapMatchAccumulate(inst->index, &inst->rx, tick);
+    SuperCapEffUpdate(inst->index, &inst->rx, tick);
+}
+
+/**
+ * @brief 解析第0块超电板返回数据 (单板兼容接口)
+ * @param cap 超电接收数据结构
+ * @param data CAN接收的原始数据 (8字节)
+ */
+void get_supercap(SuperCap_Msg_get *cap, uint8_t *data)
+{
+    SuperCap_Instance *inst = &supercap_instance[0];
+    uint32_t tick = HAL_GetTick();
+    PROFILE_BEGIN(PROFILE_GET_SUPERCAP);
+
+    supercap_decode(0, cap, data, tick);
+    inst->lastTick = tick;
+    if (cap != &inst->rx) {
+        inst->rx = *cap;
+    }
+    supercap_frame_done(inst, tick);
+
+    PROFILE_END(PROFILE_GET_SUPERCAP);
+}
+
+/**
+ * @brief 注册超电实例
+ */
+SuperCap_Instance *SuperCapInstanceRegister(uint8_t index, fp32 full_energy)
+{
+    SuperCap_Instance *inst;
+
+    if (index >= SUPERCAP_MAX_INSTANCES) {
+        return NULL;
+    }
+
+    inst = &supercap_instance[index];
+    memset(inst, 0, sizeof(SuperCap_Instance));
+    inst->index = index;
+    inst->fullEnergy = full_energy;
+    // 先写默认值再置注册标志, 初始限制不算一次下发命令
+    SuperCapSetControl(&inst->tx, 1, SUPERCAP_DEFAULT_POWER_LIMIT, SUPERCAP_DEFAULT_ENERGY_BUFFER);
+    inst->registered = 1;
+    inst->tx.protocolV2 = 1;
+    inst->tx.statusRequest = 1;
+    inst->protocol = SUPERCAP_PROTOCOL_V1;
+    return inst;
+}
+
+/**
+ * @brief 按CAN ID查找超电实例, 直接下标, 与实例数量无关
+ */
+SuperCap_Instance *SuperCapInstanceFromCanId(uint32_t std_id)
+{
+    uint32_t offset = std_id - SUPERCAP_RX_ID_BASE;
+    uint32_t index = offset % SUPERCAP_RX_ID_GROUP_SIZE;
+
+    if (offset >= SUPERCAP_RX_V2_ID_BASE - SUPERCAP_RX_ID_BASE + SUPERCAP_RX_ID_GROUP_SIZE ||
+        index >= SUPERCAP_MAX_INSTANCES || !supercap_instance[index].registered) {
+        return NULL;
+    }
+    return &supercap_instance[index];
+}
+
+/**
+ * @brief 解析超电实例的接收帧
+ */
+void SuperCapInstanceDecode(SuperCap_Instance *inst, uint8_t *data)
+{
+    uint32_t tick = HAL_GetTick();
+
+    inst->protocol = SUPERCAP_PROTOCOL_V1;
+    supercap_decode(inst->index, &inst->rx, data, tick);
+    inst->lastTick = tick;
+    inst->sampleTick = tick;
+    supercap_frame_done(inst, tick);
+}
+
+/**
+ * @brief 解析v2接收帧, 序号判断新帧/丢帧/迟到/重复
+ * @return 1=新帧已解析, 0=迟到或重复帧已丢弃
+ */
+static uint8_t supercap_decode_v2(SuperCap_Instance *inst, uint8_t *data, uint32_t tick)
+{
+    SuperCap_LinkStats *link = &inst->link;
+    uint8_t seq = data[5];
+    uint8_t diff = (uint8_t)(seq - link->lastSeq);
+    fp32 power;
+
+    // 离线后 (如板子重启) 序号重新同步
+    if (tick - inst->lastTick > SUPERCAP_OFFLINE_TIME) {
+        link->seqValid = 0;
+    }
+
+    if (link->seqValid) {
+        if (diff == 0) {
+            link->duplicated++;
+            return 0;
+        } else if (diff >= 0x80) {
+            // 序号回退, 比已收到的帧还旧
+            link->reordered++;
+            return 0;
+        }
+        link->dropped += diff - 1;
+    }
+    link->seqValid = 1;
+    link->lastSeq = seq;
+    link->lastBoardTick = (uint16_t)data[6] | ((uint16_t)data[7] << 8);
+    link->received++;
+
+    power = (fp32)(int16_t)((uint16_t)data[1] | ((uint16_t)data[2] << 8)) * 0.1f;
+    supercap_check_frame(inst, power, data[3], data[4], tick);
+    inst->lastTick = tick;
+    inst->protocol = SUPERCAP_PROTOCOL_V2;
+    if (inst->sync.synced) {
+        uint32_t sample_tick = SuperCapTimeSyncToRobot(&inst->sync, link->lastBoardTick, tick);
+
+        // 对时修正可能让换算时刻早于上一帧, 采样时刻保持单调
+        if ((int32_t)(sample_tick - inst->sampleTick) >= 0) {
+            inst->sampleTick = sample_tick;
+        }
+    } else {
+        inst->sampleTick = tick;
+    }
+
+    SuperCapEventDetect(inst->index, inst->rx.errorCode, data[0], tick);
+    inst->rx.errorCode = data[0];
+    inst->rx.chassisPower = power;
+    inst->rx.chassisPowerLimit = data[3];
+    inst->rx.capEnergy = data[4];
+    supercap_frame_done(inst, inst->sampleTick);
+    return 1;
+}
+
+/**
+ * @brief CAN接收回调入口
+ */
+SuperCap_Instance *SuperCapCanRxHandler(uint32_t std_id, uint8_t *data)
+{
+    SuperCap_Instance *inst = SuperCapInstanceFromCanId(std_id);
+
+    // 先判断再开始计时, 提前返回不会留下未结束的探针
+    if (inst == NULL) {
+        return NULL;
+    }
+
+    PROFILE_BEGIN(PROFILE_GET_SUPERCAP);
+
+    if (std_id >= SUPERCAP_RX_V2_ID_BASE) {
+        supercap_decode_v2(inst, data, HAL_GetTick());
+    } else if (std_id >= SUPERCAP_RX_SYNC_ID_BASE) {
+        SuperCapTimeSyncResponse(&inst->sync, data, HAL_GetTick());
+    } else {
+        SuperCapInstanceDecode(inst, data);
+    }
+
+    PROFILE_END(PROFILE_GET_SUPERCAP);
+    return inst;
+}
+
+/**
+ * @brief 发送前写入对时请求
+ */
+void SuperCapInstanceTxPrepare(SuperCap_Instance *inst)
+{
+    uint32_t tick = HAL_GetTick();
+
+    // 状态未知时每帧都带请求位, 链路监控判定掉线后清除 stateKnown, 在这里重新置位;
+    // statusRequest 是独立的位, SuperCapSetControl 不会改动它
+    if (!inst->stateKnown) {
+        inst->tx.statusRequest = 1;
+        if (inst->requestTick == 0) {
+            inst->requestTick = tick ? tick : 1;
+        }
+    }
+
+    SuperCapTimeSyncPing(&inst->sync, inst->tx.resv1, tick);
+}
+
+/**
+ * @brief 获取v2链路丢帧率 (千分比)
+ */
+uint16_t SuperCapInstanceDropRate(const SuperCap_Instance *inst)
+{
+    uint32_t total = inst->link.received + inst->link.dropped;
+
+    if (total == 0) {
+        return 0;
+    }
+    return (uint16_t)((uint64_t)inst->link.dropped * 1000 / total);
+}
+
+/**
+ * @brief 获取数据年龄
+ */
+uint32_t SuperCapInstanceDataAge(const SuperCap_Instance *inst)
+{
+    if (inst->sync.synced) {
+        return HAL_GetTick() - inst->sampleTick;
+    }
+    return HAL_GetTick() - inst->lastTick;
+}
+
+/**
+ * @brief 获取超电实例状态是否已知
+ */
+uint8_t SuperCapInstanceStateKnown(const SuperCap_Instance *inst)
+{
+    return inst->stateKnown && SuperCapInstanceOnline(inst);
+}
+
+/**
+ * @brief 获取超电实例在线状态
+ */
+uint8_t SuperCapInstanceOnline(const SuperCap_Instance *inst)
+{
+    if (HAL_GetTick() - inst->lastTick > SUPERCAP_OFFLINE_TIME) {
+        // 超过1s未收到数据, 离线
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+/**
+ * @brief 链路监控
+ */
+void SuperCapLinkMonitor(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        SuperCap_Instance *inst = &supercap_instance[i];
+        uint8_t online;
+
+        if (!inst->registered) {
+            continue;
+        }
+
+        online = SuperCapInstanceOnline(inst);
+        if (inst->online && !online) {
+            inst->linkLost++;
+            // 超电板可能已重启, 重新握手
+            inst->stateKnown = 0;
+            inst->requestTick = 0;
+        }
+        inst->online = online;
+    }
+}
+
+/**
+ * @brief 获取功率限制的建议提前量
+ */
+uint32_t SuperCapLimitLeadTime(const SuperCap_Instance *inst)
+{
+    const SuperCap_LimitTrack *track = &inst->limitTrack;
+    uint32_t total = 0;
+    uint32_t count = 0;
+    uint8_t bin;
+
+    for (bin = 0; bin < SUPERCAP_LIMIT_HIST_BINS; bin++) {
+        total += track->settleHist[bin];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    for (bin = 0; bin < SUPERCAP_LIMIT_HIST_BINS - 1; bin++) {
+        count += track->settleHist[bin];
+        if (count * 100 >= total * SUPERCAP_LIMIT_LEAD_PERCENT) {
+            return 1UL << bin;
+        }
+    }
+    return track->settleMax;
+}
+
+/**
+ * @brief 计算所有在线超电的汇总数据
+ */
+void SuperCapGetAggregate(SuperCap_Aggregate *agg)
+{
+    fp32 full_energy_sum = 0.0f;
+    fp32 energy_sum = 0.0f;
+    uint8_t i;
+
+    agg->chassisPower = 0.0f;
+    agg->availableEnergy = 0.0f;
+    agg->capEnergy = 0;
+    agg->onlineCount = 0;
+
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        SuperCap_Instance *inst = &supercap_instance[i];
+        if (!inst->registered || !SuperCapInstanceOnline(inst)) {
+            continue;
+        }
+        agg->chassisPower += inst->rx.chassisPower;
+        full_energy_sum += inst->fullEnergy;
+        energy_sum += (fp32)inst->rx.capEnergy * inst->fullEnergy / 255.0f;
+        agg->onlineCount++;
+    }
+
+    agg->availableEnergy = energy_sum;
+    if (full_energy_sum > 0.0f) {
+        // 按容量加权, 折算回0-255
+        agg->capEnergy = (uint8_t)(energy_sum * 255.0f / full_energy_sum + 0.5f);
+    }
+}
+
+/**
+ * @brief 按各板可用能量比例分配总功率限制
+ */
+void SuperCapSplitPowerLimit(uint16_t total_limit)
+{
+    fp32 weight[SUPERCAP_MAX_INSTANCES];
+    uint16_t share[SUPERCAP_MAX_INSTANCES];
+    uint8_t clamped[SUPERCAP_MAX_INSTANCES];
+    fp32 weight_sum = 0.0f;
+    int32_t remaining = total_limit;
+    uint16_t assigned = 0;
+    uint8_t largest = SUPERCAP_MAX_INSTANCES;
+    uint8_t pass;
+    uint8_t i;
+
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        SuperCap_Instance *inst = &supercap_instance[i];
+        weight[i] = 0.0f;
+        if (inst->registered && SuperCapInstanceOnline(inst)) {
+            weight[i] = (fp32)inst->rx.capEnergy * inst->fullEnergy;
+            weight_sum += weight[i];
+        }
+    }
+
+    if (weight_sum <= 0.0f) {
+        // 电容全部放空, 按容量平分
+        for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+            SuperCap_Instance *inst = &supercap_instance[i];
+            if (inst->registered && SuperCapInstanceOnline(inst)) {
+                weight[i] = inst->fullEnergy;
+                weight_sum += weight[i];
+            }
+        }
+        if (weight_sum <= 0.0f) {
+            return;
+        }
+    }
+
+    // 按比例分到的份额低于协议下限的板固定为下限, 其余板按比例分剩下的部分,
+    // 每轮至少固定一块板, 最多 SUPERCAP_MAX_INSTANCES 轮
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        share[i] = 0;
+        clamped[i] = 0;
+    }
+    for (pass = 0; pass < SUPERCAP_MAX_INSTANCES; pass++) {
+        uint8_t changed = 0;
+
+        for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+            if (weight[i] > 0.0f && !clamped[i] &&
+                (fp32)remaining * weight[i] / weight_sum < (fp32)SUPERCAP_POWER_LIMIT_MIN) {
+                clamped[i] = 1;
+                share[i] = SUPERCAP_POWER_LIMIT_MIN;
+                remaining -= SUPERCAP_POWER_LIMIT_MIN;
+                weight_sum -= weight[i];
+                changed = 1;
+            }
+        }
+        if (!changed || weight_sum <= 0.0f) {
+            break;
+        }
+    }
+
+    // 总限制低于各板下限之和时, 每板只能下发下限
+    if (remaining < 0) {
+        remaining = 0;
+    }
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        if (weight[i] <= 0.0f || clamped[i]) {
+            continue;
+        }
+        share[i] = (uint16_t)((fp32)remaining * weight[i] / weight_sum);
+        assigned += share[i];
+        if (largest == SUPERCAP_MAX_INSTANCES || weight[i] > weight[largest]) {
+            largest = i;
+        }
+    }
+
+    // 取整余量给能量最多的板, 保证总和不变
+    if (largest < SUPERCAP_MAX_INSTANCES && assigned < remaining) {
+        share[largest] += remaining - assigned;
+    }
+
+    // 每板只下发一次, 避免生效延迟统计被中间值打断
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        if (weight[i] > 0.0f) {
+            SuperCapSetPowerLimit(&supercap_instance[i].tx, share[i]);
+        }
+    }
+}
+
 /**
  * @brief 设置超电完整控制参数
  */
@@ -78,6 +646,7 @@ void SuperCapSetControl(SuperCap_TX_Msg_send *cap, uint8_t enable, uint16_t powe
     cap->enableDCDC = enable ? 1 : 0;
     cap->systemRestart = 0;
     cap->resv0 = 0;
+    supercap_limit_command(cap, power_limit);
     cap->powerLimit = power_limit;
     cap->energyBuffer = energy_buffer;
     cap->resv1[0] = 0;
@@ -90,6 +659,7 @@ void SuperCapSetControl(SuperCap_TX_Msg_send *cap, uint8_t enable, uint16_t powe
  */
 void SuperCapSetPowerLimit(SuperCap_TX_Msg_send *cap, uint16_t power_limit)
 {
+    supercap_limit_command(cap, power_limit);
     cap->powerLimit = power_limit;
 }
 
@@ -144,3 +714,30 @@ float SuperCapGetEnergyPercent(SuperCap_Msg_get *cap)
 {
     return (float)cap->capEnergy * 100.0f / 255.0f;
 }
+
+/**
+ * @brief 获取电容电压
+ * @return 电容电压 (mV)
+ */
+uint16_t SuperCapGetVoltageMv(const SuperCap_Msg_get *cap)
+{
+    return SUPERCAP_VOLTAGE_MV(cap->capEnergy);
+}
+
+/**
+ * @brief 获取可用能量
+ * @return 截止电压以上可用能量 (0.1J)
+ */
+uint16_t SuperCapGetUsableEnergyDj(const SuperCap_Msg_get *cap)
+{
+    return SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy);
+}
+
+/**
+ * @brief 获取最大放电功率
+ * @return 最大放电功率 (0.1W)
+ */
+uint16_t SuperCapGetPeakPowerDw(const SuperCap_Msg_get *cap)
+{
+    return SUPERCAP_PEAK_POWER_DW(cap->capEnergy);
+}
@@ -4,6 +4,7 @@
 #include "stm32f4xx_it.h"
 #include "user_lib.h"
 #include "struct_typedef.h"
+#include "supercap_timesync.h"
 
 // 错误代码定义 (errorCode的bit0-6)
 #define SUPERCAP_ERROR_UNDER_VOLTAGE      0x01  // Bit 0: 欠压
@@ -18,6 +19,32 @@
 #define SUPERCAP_DEFAULT_POWER_LIMIT      37    // 默认功率限制 (W)
 #define SUPERCAP_DEFAULT_ENERGY_BUFFER    60    // 默认能量缓冲 (J)
 
+// CAN ID 与多实例配置 (第n块板: 接收 0x051+n, 发送 0x061+n)
+#define SUPERCAP_RX_ID_BASE               0x051 // 接收ID基址
+#define SUPERCAP_TX_ID_BASE               0x061 // 发送ID基址
+#define SUPERCAP_MAX_INSTANCES            2     // 最大超电板数量
+#define SUPERCAP_OFFLINE_TIME             1000  // 超过该时间未收到数据判为离线 (ms)
+
+// v2协议 (带序号和板端时间戳), 第n块板接收ID为 0x059+n, v1板不响应请求位, 仍按0x051+n解析
+#define SUPERCAP_RX_V2_ID_BASE            0x059 // v2接收ID基址
+#define SUPERCAP_RX_SYNC_ID_BASE          0x055 // 对时应答ID基址
+#define SUPERCAP_RX_ID_GROUP_SIZE         4     // 0x051/0x055/0x059 每组4个ID
+
+// 接收数据合理性检查
+#define SUPERCAP_POWER_ABS_MAX            10000.0f // chassisPower 绝对值超过该值 (或NaN/Inf) 视为异常 (W)
+#define SUPERCAP_POWER_LIMIT_MIN          30    // chassisPowerLimit 合理下限 (W)
+#define SUPERCAP_POWER_LIMIT_MAX          250   // chassisPowerLimit 合理上限 (W)
+#define SUPERCAP_ENERGY_JUMP_BASE         4     // capEnergy 单帧允许跳变 (量化余量)
+#define SUPERCAP_ENERGY_JUMP_PER_100MS    10    // capEnergy 每100ms允许额外变化量
+#define SUPERCAP_PROTOCOL_V1              1
+#define SUPERCAP_PROTOCOL_V2              2
+
+// 功率限制命令生效延迟统计
+#define SUPERCAP_LIMIT_HIST_BINS          12    // 延迟直方图桶数, 第n桶为 [2^(n-1), 2^n) ms, 最后一桶收尾
+#define SUPERCAP_LIMIT_SETTLE_BAND        3.0f  // 相邻两帧 chassisPower 变化小于该值视为平稳 (W)
+#define SUPERCAP_LIMIT_SETTLE_FRAMES      3     // 连续平稳且不超限的帧数, 达到即认为功率已收敛
+#define SUPERCAP_LIMIT_LEAD_PERCENT       95    // 提前量按收敛延迟的该百分位取
+
 // 接收数据结构 (从超电板接收, CAN ID: 0x051)
 typedef struct
 {
@@ -32,12 +59,91 @@ typedef struct
 {
     uint8_t enableDCDC : 1;      // bit0: DCDC使能标志 (1=使能, 0=禁用)
     uint8_t systemRestart : 1;   // bit1: 系统重启命令 (1=重启)
-    uint8_t resv0 : 6;           // bit2-7: 保留位
+    uint8_t protocolV2 : 1;      // bit2: 请求v2协议 (1=请求, v1板忽略)
+    uint8_t statusRequest : 1;   // bit3: 请求立即回复完整状态 (上电/重新上线握手)
+    uint8_t resv0 : 4;           // bit4-7: 保留位
     uint16_t powerLimit;         // 功率限制值 (单位: W, 范围: 30-250W)
     uint16_t energyBuffer;       // 能量缓冲值 (单位: J, 范围: 0-300J)
     uint8_t resv1[3];            // 3字节保留位
 } __attribute__((packed)) SuperCap_TX_Msg_send;
 
+// v2接收数据 (CAN ID: 0x059), 8字节
+//       Byte 0: errorCode
+//       Byte 1-2: chassisPower (int16, 0.1W, 小端)
+//       Byte 3: chassisPowerLimit (uint8, W)
+//       Byte 4: capEnergy (0-255)
+//       Byte 5: seq (滚动序号)
+//       Byte 6-7: boardTick (uint16, 板端ms时间戳, 小端)
+
+// 链路统计
+typedef struct
+{
+    uint32_t received;           // 收到的新帧数
+    uint32_t dropped;            // 序号跳变推算的丢帧数
+    uint32_t reordered;          // 迟到 (序号回退) 帧数
+    uint32_t duplicated;         // 重复序号帧数
+    uint16_t lastBoardTick;      // 最近一帧板端时间戳 (ms)
+    uint8_t lastSeq;             // 最近一帧序号
+    uint8_t seqValid;            // 1=已收到过v2帧
+} SuperCap_LinkStats;
+
+// 接收异常统计
+typedef struct
+{
+    uint32_t badPower;           // chassisPower 为NaN/Inf或超范围, 保留上一帧值
+    uint32_t badPowerLimit;      // chassisPowerLimit 超出 30-250W
+    uint32_t energyJump;         // capEnergy 变化快于物理可能
+} SuperCap_Anomaly;
+
+// 功率限制命令生效跟踪
+typedef struct
+{
+    uint16_t target;             // 最近一次下发的功率限制 (W)
+    uint8_t state;               // 0=空闲, 1=等待回显, 2=等待功率收敛
+    uint8_t settleFrames;        // 已连续平稳的帧数
+    uint32_t commandTick;        // 下发时刻 (ms)
+    fp32 lastPower;              // 上一帧 chassisPower (W)
+    uint32_t commands;           // 下发次数
+    uint32_t superseded;         // 未生效就被新命令覆盖的次数
+    uint32_t timeouts;           // 超时未回显次数
+    uint16_t echoHist[SUPERCAP_LIMIT_HIST_BINS];   // 下发到 chassisPowerLimit 回显的延迟直方图
+    uint16_t settleHist[SUPERCAP_LIMIT_HIST_BINS]; // 下发到 chassisPower 收敛的延迟直方图
+    uint32_t echoMax;            // 最大回显延迟 (ms)
+    uint32_t settleMax;          // 最大收敛延迟 (ms)
+} SuperCap_LimitTrack;
+
+// 超电实例 (每块超电板一个)
+typedef struct
+{
+    SuperCap_Msg_get rx;         // 最新接收帧
+    SuperCap_TX_Msg_send tx;     // 待发送命令
+    uint32_t lastTick;           // 最近一次收到数据的时间戳 (ms)
+    fp32 fullEnergy;             // 电容满电能量 (J), 用于加权汇总
+    uint8_t index;               // 实例序号, 对应CAN ID偏移
+    uint8_t registered;          // 1=已注册
+    uint8_t protocol;            // 最近一帧的协议版本
+    SuperCap_LinkStats link;     // v2链路统计
+    SuperCap_TimeSync sync;      // 板端时钟同步
+    uint32_t sampleTick;         // 最新数据的测量时刻 (机器人ms), 未对时则为接收时刻
+    SuperCap_Anomaly anomaly;    // 接收异常统计
+    uint8_t online;              // 链路监控维护的在线状态
+    uint32_t linkLost;           // 在线转离线次数
+    SuperCap_LimitTrack limitTrack; // 功率限制命令生效延迟
+    uint8_t stateKnown;          // 1=已收到握手后的首帧, 底盘可按实际状态使用电容
+    uint32_t requestTick;        // 首次发送状态请求的时刻 (ms), 0=尚未发送
+    uint32_t stateKnownTick;     // 状态已知时刻 (ms), 上电后首次即为复位到就绪的时间
+    uint32_t handshakeTime;      // 最近一次请求到状态已知的时间 (ms)
+} SuperCap_Instance;
+
+// 多板汇总数据
+typedef struct
+{
+    fp32 chassisPower;           // 各板底盘功率之和 (W)
+    fp32 availableEnergy;        // 各板电容能量之和 (J)
+    uint8_t capEnergy;           // 按容量加权的电容能量 (0-255)
+    uint8_t onlineCount;         // 在线板数
+} SuperCap_Aggregate;
+
 // 辅助函数：获取输出禁用状态
 #define SUPERCAP_OUTPUT_DISABLED(errorCode) (((errorCode) >> 7) & 0x01)
 // 辅助函数：获取错误码
@@ -51,6 +157,8 @@ extern void get_supercap(SuperCap_Msg_get *cap, uint8_t *data);
 
 /**
  * @brief 设置超电控制参数
+ * @note 仅当 cap 为已注册实例的 tx 时统计功率限制生效延迟 (见 SuperCapLimitLeadTime),
+ *       自行定义的发送结构不会被跟踪
  *
  * @param cap 超电发送实例
  * @param enable DCDC使能 (1=使能, 0=禁用)
@@ -75,6 +183,8 @@ extern void SuperCapDisable(SuperCap_TX_Msg_send *cap);
 
 /**
  * @brief 设置功率限制
+ * @note 仅当 cap 为已注册实例的 tx 时统计功率限制生效延迟 (见 SuperCapLimitLeadTime),
+ *       自行定义的发送结构不会被跟踪
  *
  * @param cap 超电发送实例
  * @param power_limit 功率限制值 (30-250W)
@@ -112,4 +222,133 @@ extern uint8_t SuperCapIsOutputDisabled(SuperCap_Msg_get *cap);
  */
 extern float SuperCapGetEnergyPercent(SuperCap_Msg_get *cap);
 
+/**
+ * @brief 获取电容电压 (查表, 无浮点运算)
+ *
+ * @param cap 超电接收实例
+ * @return 电容电压 (mV)
+ */
+extern uint16_t SuperCapGetVoltageMv(const SuperCap_Msg_get *cap);
+
+/**
+ * @brief 获取截止电压以上的可用能量 (查表, 无浮点运算)
+ *
+ * @param cap 超电接收实例
+ * @return 可用能量 (0.1J)
+ */
+extern uint16_t SuperCapGetUsableEnergyDj(const SuperCap_Msg_get *cap);
+
+/**
+ * @brief 获取当前电压下的最大放电功率 (查表, 无浮点运算)
+ *
+ * @param cap 超电接收实例
+ * @return 最大放电功率 (0.1W)
+ */
+extern uint16_t SuperCapGetPeakPowerDw(const SuperCap_Msg_get *cap);
+
+/**
+ * @brief 注册超电实例
+ *
+ * @param index 实例序号 (0 ~ SUPERCAP_MAX_INSTANCES-1)
+ * @param full_energy 电容满电能量 (J)
+ * @return 实例指针, 序号越界返回NULL
+ */
+extern SuperCap_Instance *SuperCapInstanceRegister(uint8_t index, fp32 full_energy);
+
+/**
+ * @brief 按CAN接收ID查找超电实例
+ *
+ * @param std_id CAN标准ID
+ * @return 实例指针, 非超电ID或未注册返回NULL
+ */
+extern SuperCap_Instance *SuperCapInstanceFromCanId(uint32_t std_id);
+
+/**
+ * @brief 解析超电实例的接收帧
+ *
+ * @param inst 超电实例
+ * @param data CAN接收的原始数据 (8字节)
+ */
+extern void SuperCapInstanceDecode(SuperCap_Instance *inst, uint8_t *data);
+
+/**
+ * @brief CAN接收回调入口, 按ID查找实例并按v1/v2格式解析
+ *
+ * @param std_id CAN标准ID
+ * @param data CAN接收的原始数据 (8字节)
+ * @return 实例指针, 非超电ID或未注册返回NULL
+ */
+extern SuperCap_Instance *SuperCapCanRxHandler(uint32_t std_id, uint8_t *data);
+
+/**
+ * @brief 获取v2链路丢帧率
+ *
+ * @param inst 超电实例
+ * @return 丢帧率 (千分比)
+ */
+extern uint16_t SuperCapInstanceDropRate(const SuperCap_Instance *inst);
+
+/**
+ * @brief 获取数据年龄 (距数据采样时刻的时间)
+ * @note 已对时则以板端采样时刻 sampleTick 计, 包含总线与排队延迟;
+ *       未对时退化为距最近一次收到新帧的时间
+ *
+ * @param inst 超电实例
+ * @return 数据年龄 (ms)
+ */
+extern uint32_t SuperCapInstanceDataAge(const SuperCap_Instance *inst);
+
+/**
+ * @brief 发送0x061前调用, 写入对时请求等附加字段
+ *
+ * @param inst 超电实例
+ */
+extern void SuperCapInstanceTxPrepare(SuperCap_Instance *inst);
+
+/**
+ * @brief 链路监控, 由低速执行器周期调用, 更新各实例在线状态并统计掉线次数
+ * @note 掉线后重新置位状态请求, 重新上线时再次握手
+ */
+extern void SuperCapLinkMonitor(void);
+
+/**
+ * @brief 获取超电实例状态是否已知 (握手完成)
+ *
+ * @param inst 超电实例
+ * @return 1=已知, 0=未知, 底盘应保持保守模式
+ */
+extern uint8_t SuperCapInstanceStateKnown(const SuperCap_Instance *inst);
+
+/**
+ * @brief 获取超电实例在线状态
+ *
+ * @param inst 超电实例
+ * @return 1=在线, 0=离线
+ */
+extern uint8_t SuperCapInstanceOnline(const SuperCap_Instance *inst);
+
+/**
+ * @brief 获取功率限制的建议提前量, 用于裁判系统升级前预先下发新限制
+ *
+ * @param inst 超电实例
+ * @return 下发到功率收敛延迟的 SUPERCAP_LIMIT_LEAD_PERCENT 百分位 (ms, 取桶上界), 无数据返回0
+ */
+extern uint32_t SuperCapLimitLeadTime(const SuperCap_Instance *inst);
+
+/**
+ * @brief 计算所有在线超电的汇总数据
+ *
+ * @param agg 汇总输出
+ */
+extern void SuperCapGetAggregate(SuperCap_Aggregate *agg);
+
+/**
+ * @brief 按各板可用能量比例分配总功率限制, 写入各实例发送命令
+ * @note 每块在线板不低于协议下限 SUPERCAP_POWER_LIMIT_MIN, 不足部分从其他板扣除;
+ *       总限制低于各板下限之和时每板下发下限, 总和会超过 total_limit
+ *
+ * @param total_limit 总功率限制 (W)
+ */
+extern void SuperCapSplitPowerLimit(uint16_t total_limit);
+
 #endif // !SUPER_CAP_H
@@ -0,0 +1,159 @@
+/**
+ * @file supercap_efficiency.c
+ * @brief 超级电容 buck-boost 放电效率表在线学习
+ * @note 每个格子保存指数遗忘的两项累加: 输出到底盘的能量 num 与电容能量减少量 den,
+ *       效率 = num / den, 即带遗忘因子的 out = eff * in 最小二乘解. 内存固定, 每帧O(1).
+ *       capEnergy 只有8位, 单帧能量差被量化, 累加后量化误差被平均掉.
+ *       每块板一张表, 各板变换器效率不同, 互不混合. 校准存储只保存第0块板,
+ *       上电时载入到所有板作为初值.
+ */
+
+#include "supercap_efficiency.h"
+#include "supercap_energy_table.h"
+
+static fp32 eff_num[SUPERCAP_MAX_INSTANCES][SUPERCAP_EFF_POWER_BINS][SUPERCAP_EFF_ENERGY_BINS];   // 输出能量 (J)
+static fp32 eff_den[SUPERCAP_MAX_INSTANCES][SUPERCAP_EFF_POWER_BINS][SUPERCAP_EFF_ENERGY_BINS];   // 电容能量减少 (J)
+
+static uint16_t eff_last_energy[SUPERCAP_MAX_INSTANCES];
+static uint32_t eff_last_tick[SUPERCAP_MAX_INSTANCES];
+static uint8_t eff_primed[SUPERCAP_MAX_INSTANCES];
+
+/**
+ * @brief 功率分档
+ */
+static uint8_t eff_power_bin(fp32 cap_power)
+{
+    uint8_t bin;
+
+    if (!(cap_power > 0.0f)) {
+        return 0;
+    }
+    bin = (uint8_t)(cap_power / SUPERCAP_EFF_POWER_STEP);
+    return bin < SUPERCAP_EFF_POWER_BINS ? bin : SUPERCAP_EFF_POWER_BINS - 1;
+}
+
+/**
+ * @brief capEnergy分档
+ */
+static uint8_t eff_energy_bin(uint8_t capEnergy)
+{
+    return capEnergy / (256 / SUPERCAP_EFF_ENERGY_BINS);
+}
+
+/**
+ * @brief 每帧学习一次
+ */
+void SuperCapEffUpdate(uint8_t board, const SuperCap_Msg_get *cap, uint32_t tick)
+{
+    uint16_t energy;
+    uint32_t dt;
+
+    if (board >= SUPERCAP_MAX_INSTANCES) {
+        return;
+    }
+
+    energy = SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy);
+    dt = tick - eff_last_tick[board];
+
+    if (eff_primed[board] && dt > 0 && dt <= SUPERCAP_EFF_MAX_DT) {
+        fp32 cap_power = cap->chassisPower - (fp32)cap->chassisPowerLimit;
+
+        // 只学习放电, 非有限值比较为假被跳过
+        if (cap_power > SUPERCAP_EFF_MIN_POWER && cap_power < SUPERCAP_POWER_ABS_MAX) {
+            uint8_t p = eff_power_bin(cap_power);
+            uint8_t e = eff_energy_bin(cap->capEnergy);
+            fp32 out = cap_power * (fp32)dt * 0.001f;
+            fp32 in = ((fp32)eff_last_energy[board] - (fp32)energy) * 0.1f;
+
+            eff_num[board][p][e] = SUPERCAP_EFF_FORGET * eff_num[board][p][e] + out;
+            eff_den[board][p][e] = SUPERCAP_EFF_FORGET * eff_den[board][p][e] + in;
+        }
+    }
+
+    eff_last_energy[board] = energy;
+    eff_last_tick[board] = tick;
+    eff_primed[board] = 1;
+}
+
+/**
+ * @brief 查询放电效率
+ */
+fp32 SuperCapEffGet(uint8_t board, fp32 cap_power, uint8_t capEnergy)
+{
+    uint8_t p = eff_power_bin(cap_power);
+    uint8_t e = eff_energy_bin(capEnergy);
+    fp32 eff;
+
+    if (board >= SUPERCAP_MAX_INSTANCES || eff_den[board][p][e] < SUPERCAP_EFF_MIN_WEIGHT) {
+        return SUPERCAP_EFF_DEFAULT;
+    }
+
+    eff = eff_num[board][p][e] / eff_den[board][p][e];
+    if (eff < SUPERCAP_EFF_MIN) {
+        eff = SUPERCAP_EFF_MIN;
+    } else if (eff > SUPERCAP_EFF_MAX) {
+        eff = SUPERCAP_EFF_MAX;
+    }
+    return eff;
+}
+
+/**
+ * @brief 底盘实际可得到的电容能量
+ */
+fp32 SuperCapEffDeliverableEnergy(uint8_t board, const SuperCap_Msg_get *cap, fp32 cap_power)
+{
+    return (fp32)SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy) * 0.1f * SuperCapEffGet(board, cap_power, cap->capEnergy);
+}
+
+/**
+ * @brief 从校准存储恢复一块板的效率表
+ */
+void SuperCapEffLoad(uint8_t board, const SuperCap_EffStore *store)
+{
+    uint8_t p, e;
+
+    if (board >= SUPERCAP_MAX_INSTANCES) {
+        return;
+    }
+
+    for (p = 0; p < SUPERCAP_EFF_POWER_BINS; p++) {
+        for (e = 0; e < SUPERCAP_EFF_ENERGY_BINS; e++) {
+            fp32 eff = (fp32)store->eff[p][e] * 0.0001f;
+            eff_den[board][p][e] = (fp32)store->weight[p][e] * 0.1f;
+            eff_num[board][p][e] = eff * eff_den[board][p][e];
+        }
+    }
+}
+
+/**
+ * @brief 导出效率表
+ */
+void SuperCapEffStore(uint8_t board, SuperCap_EffStore *store)
+{
+    uint8_t p, e;
+
+    if (board >= SUPERCAP_MAX_INSTANCES) {
+        return;
+    }
+
+    for (p = 0; p < SUPERCAP_EFF_POWER_BINS; p++) {
+        for (e = 0; e < SUPERCAP_EFF_ENERGY_BINS; e++) {
+            fp32 weight = eff_den[board][p][e] * 10.0f;
+            fp32 eff = eff_den[board][p][e] > 0.0f ? eff_num[board][p][e] / eff_den[board][p][e] : SUPERCAP_EFF_DEFAULT;
+
+            if (!(weight > 0.0f)) {
+                weight = 0.0f;
+            } else if (weight > 65535.0f) {
+                weight = 65535.0f;
+            }
+            if (!(eff > 0.0f)) {
+                eff = 0.0f;
+            } else if (eff > SUPERCAP_EFF_MAX) {
+                eff = SUPERCAP_EFF_MAX;
+            }
+
+            store->weight[p][e] = (uint16_t)weight;
+            store->eff[p][e] = (uint16_t)(eff * 10000.0f);
+        }
+    }
+}
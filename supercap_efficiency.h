@@ -0,0 +1,71 @@
+#ifndef SUPERCAP_EFFICIENCY_H
+#define SUPERCAP_EFFICIENCY_H
+#include "struct_typedef.h"
+#include "super_cap.h"
+
+#define SUPERCAP_EFF_POWER_BINS           8       // 电容放电功率分档数
+#define SUPERCAP_EFF_POWER_STEP           20.0f   // 每档功率 (W), 最后一档收尾
+#define SUPERCAP_EFF_ENERGY_BINS          8       // capEnergy 分档数, 每档 256/8
+#define SUPERCAP_EFF_DEFAULT              0.9f    // 样本不足时的效率
+#define SUPERCAP_EFF_MIN                  0.3f    // 效率输出下限
+#define SUPERCAP_EFF_MAX                  1.0f    // 效率输出上限
+#define SUPERCAP_EFF_FORGET               0.995f  // 每次更新的遗忘系数, 有效记忆约200帧
+#define SUPERCAP_EFF_MIN_WEIGHT           5.0f    // 格子累计能量低于该值 (J) 视为样本不足
+#define SUPERCAP_EFF_MIN_POWER            5.0f    // 电容放电功率低于该值的帧不学习 (W)
+#define SUPERCAP_EFF_MAX_DT               200     // 帧间隔超过该值不学习 (ms)
+
+// 持久化格式, 经校准存储保存, 长度必须为4字节倍数
+// 每块板一条记录 (CALI_SUPERCAP_EFF 为第0块, CALI_SUPERCAP_EFF1 为第1块),
+// 第0块的表同时作为没有自己记录的板的初值
+typedef struct
+{
+    uint16_t eff[SUPERCAP_EFF_POWER_BINS][SUPERCAP_EFF_ENERGY_BINS];     // 效率 (1/10000)
+    uint16_t weight[SUPERCAP_EFF_POWER_BINS][SUPERCAP_EFF_ENERGY_BINS];  // 累计能量 (0.1J), 饱和
+} SuperCap_EffStore;
+
+/**
+ * @brief 每帧学习一次, O(1) (在解码路径中调用)
+ *
+ * @param board 超电板序号
+ * @param cap 本帧接收数据
+ * @param tick 本帧测量时刻 (ms)
+ */
+extern void SuperCapEffUpdate(uint8_t board, const SuperCap_Msg_get *cap, uint32_t tick);
+
+/**
+ * @brief 查询放电效率 (电容输出到底盘的能量 / 电容能量减少量)
+ *
+ * @param board 超电板序号, 越界返回 SUPERCAP_EFF_DEFAULT
+ * @param cap_power 电容放电功率 (W), 即 chassisPower - chassisPowerLimit
+ * @param capEnergy 电容能量 (0-255)
+ * @return 效率 (SUPERCAP_EFF_MIN ~ SUPERCAP_EFF_MAX)
+ */
+extern fp32 SuperCapEffGet(uint8_t board, fp32 cap_power, uint8_t capEnergy);
+
+/**
+ * @brief 按当前效率折算底盘实际可得到的电容能量, 供功率限制器使用
+ *
+ * @param board 超电板序号
+ * @param cap 超电接收实例
+ * @param cap_power 预计电容放电功率 (W)
+ * @return 可输出到底盘的能量 (J)
+ */
+extern fp32 SuperCapEffDeliverableEnergy(uint8_t board, const SuperCap_Msg_get *cap, fp32 cap_power);
+
+/**
+ * @brief 从校准存储恢复一块板的效率表 (上电时由校准hook调用)
+ *
+ * @param board 超电板序号, 越界时不修改
+ * @param store 持久化数据
+ */
+extern void SuperCapEffLoad(uint8_t board, const SuperCap_EffStore *store);
+
+/**
+ * @brief 导出效率表到持久化格式 (保存时由校准hook调用)
+ *
+ * @param board 超电板序号
+ * @param store 持久化数据输出, 序号越界时不修改
+ */
+extern void SuperCapEffStore(uint8_t board, SuperCap_EffStore *store);
+
+#endif // !SUPERCAP_EFFICIENCY_H
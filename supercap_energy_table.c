@@ -0,0 +1,269 @@
+/**
+ * @file supercap_energy_table.c
+ * @brief capEnergy 定点查找表, 由 tools/gen_supercap_energy_table.py 生成, 请勿手改
+ */
+
+#include "supercap_energy_table.h"
+
+#if SUPERCAP_CAP_CAPACITANCE_MF != 6000 || SUPERCAP_CAP_MAX_VOLTAGE_MV != 28800 || SUPERCAP_CAP_CUTOFF_VOLTAGE_MV != 12000
+#error "supercap_energy_table.c is out of date, rerun tools/gen_supercap_energy_table.py"
+#endif
+
+const SuperCap_EnergyEntry supercap_energy_table[256] = {
+    {    0,     0,    0}, //   0
+    { 1804,     0,    2}, //   1
+    { 2551,     0,    3}, //   2
+    { 3124,     0,    3}, //   3
+    { 3607,     0,    4}, //   4
+    { 4033,     0,    4}, //   5
+    { 4418,     0,    4}, //   6
+    { 4772,     0,    5}, //   7
+    { 5101,     0,   22}, //   8
+    { 5411,     0,   76}, //   9
+    { 5703,     0,  134}, //  10
+    { 5982,     0,  194}, //  11
+    { 6248,     0,  256}, //  12
+    { 6503,     0,  319}, //  13
+    { 6748,     0,  384}, //  14
+    { 6985,     0,  451}, //  15
+    { 7214,     0,  518}, //  16
+    { 7436,     0,  587}, //  17
+    { 7652,     0,  657}, //  18
+    { 7861,     0,  728}, //  19
+    { 8066,     0,  799}, //  20
+    { 8265,     0,  872}, //  21
+    { 8459,     0,  945}, //  22
+    { 8649,     0, 1019}, //  23
+    { 8835,     0, 1093}, //  24
+    { 9018,     0, 1168}, //  25
+    { 9196,     0, 1244}, //  26
+    { 9371,     0, 1320}, //  27
+    { 9543,     0, 1397}, //  28
+    { 9712,     0, 1474}, //  29
+    { 9878,     0, 1552}, //  30
+    {10042,     0, 1630}, //  31
+    {10202,     0, 1709}, //  32
+    {10360,     0, 1788}, //  33
+    {10516,     0, 1867}, //  34
+    {10670,     0, 1947}, //  35
+    {10821,     0, 2027}, //  36
+    {10970,     0, 2107}, //  37
+    {11118,     0, 2188}, //  38
+    {11263,     0, 2269}, //  39
+    {11406,     0, 2350}, //  40
+    {11548,     0, 2431}, //  41
+    {11688,     0, 2513}, //  42
+    {11827,     0, 2595}, //  43
+    {11963,     0, 2678}, //  44
+    {12098,    71, 2722}, //  45
+    {12232,   169, 2752}, //  46
+    {12364,   266, 2782}, //  47
+    {12495,   364, 2811}, //  48
+    {12625,   461, 2841}, //  49
+    {12753,   559, 2869}, //  50
+    {12880,   657, 2898}, //  51
+    {13005,   754, 2926}, //  52
+    {13130,   852, 2954}, //  53
+    {13253,   949, 2982}, //  54
+    {13375,  1047, 3009}, //  55
+    {13496,  1145, 3037}, //  56
+    {13616,  1242, 3064}, //  57
+    {13735,  1340, 3090}, //  58
+    {13853,  1437, 3117}, //  59
+    {13970,  1535, 3143}, //  60
+    {14086,  1632, 3169}, //  61
+    {14201,  1730, 3195}, //  62
+    {14315,  1828, 3221}, //  63
+    {14428,  1925, 3246}, //  64
+    {14540,  2023, 3272}, //  65
+    {14652,  2120, 3297}, //  66
+    {14762,  2218, 3322}, //  67
+    {14872,  2316, 3346}, //  68
+    {14981,  2413, 3371}, //  69
+    {15089,  2511, 3395}, //  70
+    {15197,  2608, 3419}, //  71
+    {15303,  2706, 3443}, //  72
+    {15409,  2803, 3467}, //  73
+    {15515,  2901, 3491}, //  74
+    {15619,  2999, 3514}, //  75
+    {15723,  3096, 3538}, //  76
+    {15826,  3194, 3561}, //  77
+    {15928,  3291, 3584}, //  78
+    {16030,  3389, 3607}, //  79
+    {16131,  3486, 3630}, //  80
+    {16232,  3584, 3652}, //  81
+    {16332,  3682, 3675}, //  82
+    {16431,  3779, 3697}, //  83
+    {16530,  3877, 3719}, //  84
+    {16628,  3974, 3741}, //  85
+    {16725,  4072, 3763}, //  86
+    {16822,  4170, 3785}, //  87
+    {16919,  4267, 3807}, //  88
+    {17014,  4365, 3828}, //  89
+    {17110,  4462, 3850}, //  90
+    {17205,  4560, 3871}, //  91
+    {17299,  4657, 3892}, //  92
+    {17393,  4755, 3913}, //  93
+    {17486,  4853, 3934}, //  94
+    {17579,  4950, 3955}, //  95
+    {17671,  5048, 3976}, //  96
+    {17763,  5145, 3997}, //  97
+    {17854,  5243, 4017}, //  98
+    {17945,  5341, 4038}, //  99
+    {18035,  5438, 4058}, // 100
+    {18125,  5536, 4078}, // 101
+    {18215,  5633, 4098}, // 102
+    {18304,  5731, 4118}, // 103
+    {18392,  5828, 4138}, // 104
+    {18481,  5926, 4158}, // 105
+    {18568,  6024, 4178}, // 106
+    {18656,  6121, 4198}, // 107
+    {18743,  6219, 4217}, // 108
+    {18829,  6316, 4237}, // 109
+    {18916,  6414, 4256}, // 110
+    {19001,  6512, 4275}, // 111
+    {19087,  6609, 4295}, // 112
+    {19172,  6707, 4314}, // 113
+    {19256,  6804, 4333}, // 114
+    {19341,  6902, 4352}, // 115
+    {19425,  6999, 4371}, // 116
+    {19508,  7097, 4389}, // 117
+    {19591,  7195, 4408}, // 118
+    {19674,  7292, 4427}, // 119
+    {19757,  7390, 4445}, // 120
+    {19839,  7487, 4464}, // 121
+    {19921,  7585, 4482}, // 122
+    {20002,  7682, 4500}, // 123
+    {20083,  7780, 4519}, // 124
+    {20164,  7878, 4537}, // 125
+    {20245,  7975, 4555}, // 126
+    {20325,  8073, 4573}, // 127
+    {20405,  8170, 4591}, // 128
+    {20484,  8268, 4609}, // 129
+    {20563,  8366, 4627}, // 130
+    {20642,  8463, 4645}, // 131
+    {20721,  8561, 4662}, // 132
+    {20799,  8658, 4680}, // 133
+    {20877,  8756, 4697}, // 134
+    {20955,  8853, 4715}, // 135
+    {21033,  8951, 4732}, // 136
+    {21110,  9049, 4750}, // 137
+    {21187,  9146, 4767}, // 138
+    {21263,  9244, 4784}, // 139
+    {21340,  9341, 4801}, // 140
+    {21416,  9439, 4819}, // 141
+    {21491,  9537, 4836}, // 142
+    {21567,  9634, 4853}, // 143
+    {21642,  9732, 4870}, // 144
+    {21717,  9829, 4886}, // 145
+    {21792,  9927, 4903}, // 146
+    {21867, 10024, 4920}, // 147
+    {21941, 10122, 4937}, // 148
+    {22015, 10220, 4953}, // 149
+    {22089, 10317, 4970}, // 150
+    {22162, 10415, 4986}, // 151
+    {22235, 10512, 5003}, // 152
+    {22308, 10610, 5019}, // 153
+    {22381, 10708, 5036}, // 154
+    {22454, 10805, 5052}, // 155
+    {22526, 10903, 5068}, // 156
+    {22598, 11000, 5085}, // 157
+    {22670, 11098, 5101}, // 158
+    {22742, 11195, 5117}, // 159
+    {22813, 11293, 5133}, // 160
+    {22884, 11391, 5149}, // 161
+    {22955, 11488, 5165}, // 162
+    {23026, 11586, 5181}, // 163
+    {23096, 11683, 5197}, // 164
+    {23167, 11781, 5213}, // 165
+    {23237, 11878, 5228}, // 166
+    {23307, 11976, 5244}, // 167
+    {23376, 12074, 5260}, // 168
+    {23446, 12171, 5275}, // 169
+    {23515, 12269, 5291}, // 170
+    {23584, 12366, 5306}, // 171
+    {23653, 12464, 5322}, // 172
+    {23722, 12562, 5337}, // 173
+    {23790, 12659, 5353}, // 174
+    {23858, 12757, 5368}, // 175
+    {23926, 12854, 5383}, // 176
+    {23994, 12952, 5399}, // 177
+    {24062, 13049, 5414}, // 178
+    {24130, 13147, 5429}, // 179
+    {24197, 13245, 5444}, // 180
+    {24264, 13342, 5459}, // 181
+    {24331, 13440, 5474}, // 182
+    {24398, 13537, 5489}, // 183
+    {24464, 13635, 5504}, // 184
+    {24531, 13733, 5519}, // 185
+    {24597, 13830, 5534}, // 186
+    {24663, 13928, 5549}, // 187
+    {24729, 14025, 5564}, // 188
+    {24794, 14123, 5579}, // 189
+    {24860, 14220, 5593}, // 190
+    {24925, 14318, 5608}, // 191
+    {24990, 14416, 5623}, // 192
+    {25055, 14513, 5637}, // 193
+    {25120, 14611, 5652}, // 194
+    {25185, 14708, 5667}, // 195
+    {25249, 14806, 5681}, // 196
+    {25314, 14903, 5696}, // 197
+    {25378, 15001, 5710}, // 198
+    {25442, 15099, 5724}, // 199
+    {25506, 15196, 5739}, // 200
+    {25569, 15294, 5753}, // 201
+    {25633, 15391, 5767}, // 202
+    {25696, 15489, 5782}, // 203
+    {25760, 15587, 5796}, // 204
+    {25823, 15684, 5810}, // 205
+    {25885, 15782, 5824}, // 206
+    {25948, 15879, 5838}, // 207
+    {26011, 15977, 5852}, // 208
+    {26073, 16074, 5866}, // 209
+    {26136, 16172, 5881}, // 210
+    {26198, 16270, 5894}, // 211
+    {26260, 16367, 5908}, // 212
+    {26322, 16465, 5922}, // 213
+    {26383, 16562, 5936}, // 214
+    {26445, 16660, 5950}, // 215
+    {26506, 16758, 5964}, // 216
+    {26568, 16855, 5978}, // 217
+    {26629, 16953, 5991}, // 218
+    {26690, 17050, 6005}, // 219
+    {26751, 17148, 6019}, // 220
+    {26811, 17245, 6033}, // 221
+    {26872, 17343, 6046}, // 222
+    {26932, 17441, 6060}, // 223
+    {26993, 17538, 6073}, // 224
+    {27053, 17636, 6087}, // 225
+    {27113, 17733, 6100}, // 226
+    {27173, 17831, 6114}, // 227
+    {27233, 17929, 6127}, // 228
+    {27292, 18026, 6141}, // 229
+    {27352, 18124, 6154}, // 230
+    {27411, 18221, 6168}, // 231
+    {27470, 18319, 6181}, // 232
+    {27530, 18416, 6194}, // 233
+    {27589, 18514, 6207}, // 234
+    {27648, 18612, 6221}, // 235
+    {27706, 18709, 6234}, // 236
+    {27765, 18807, 6247}, // 237
+    {27823, 18904, 6260}, // 238
+    {27882, 19002, 6273}, // 239
+    {27940, 19099, 6287}, // 240
+    {27998, 19197, 6300}, // 241
+    {28056, 19295, 6313}, // 242
+    {28114, 19392, 6326}, // 243
+    {28172, 19490, 6339}, // 244
+    {28230, 19587, 6352}, // 245
+    {28287, 19685, 6365}, // 246
+    {28345, 19783, 6378}, // 247
+    {28402, 19880, 6390}, // 248
+    {28459, 19978, 6403}, // 249
+    {28516, 20075, 6416}, // 250
+    {28573, 20173, 6429}, // 251
+    {28630, 20270, 6442}, // 252
+    {28687, 20368, 6455}, // 253
+    {28743, 20466, 6467}, // 254
+    {28800, 20563, 6480}, // 255
+};
@@ -0,0 +1,28 @@
+#ifndef SUPERCAP_ENERGY_TABLE_H
+#define SUPERCAP_ENERGY_TABLE_H
+#include "struct_typedef.h"
+
+// 电容模型参数, 修改后需重新运行 tools/gen_supercap_energy_table.py
+#define SUPERCAP_CAP_CAPACITANCE_MF       6000    // 电容容量 (mF)
+#define SUPERCAP_CAP_MAX_VOLTAGE_MV       28800   // 满电电压 (mV), capEnergy=255
+#define SUPERCAP_CAP_CUTOFF_VOLTAGE_MV    12000   // 放电截止电压 (mV), 以下能量视为不可用
+
+// 查找表条目 (定点)
+typedef struct
+{
+    uint16_t voltage_mv;         // 电容电压 (mV)
+    uint16_t usable_dj;          // 截止电压以上可用能量 (0.1J)
+    uint16_t peak_power_dw;      // 当前电压下最大放电功率 (0.1W)
+} SuperCap_EnergyEntry;
+
+// 直接以 capEnergy 原始字节为下标
+extern const SuperCap_EnergyEntry supercap_energy_table[256];
+
+// 辅助宏：电容电压 (mV)
+#define SUPERCAP_VOLTAGE_MV(capEnergy)        (supercap_energy_table[(uint8_t)(capEnergy)].voltage_mv)
+// 辅助宏：可用能量 (0.1J)
+#define SUPERCAP_USABLE_ENERGY_DJ(capEnergy)  (supercap_energy_table[(uint8_t)(capEnergy)].usable_dj)
+// 辅助宏：最大放电功率 (0.1W)
+#define SUPERCAP_PEAK_POWER_DW(capEnergy)     (supercap_energy_table[(uint8_t)(capEnergy)].peak_power_dw)
+
+#endif // !SUPERCAP_ENERGY_TABLE_H
@@ -0,0 +1,149 @@
+/**
+ * @file supercap_event.c
+ * @brief 超级电容故障事件流与反应延迟统计
+ * @note 生产者为CAN接收中断 (get_supercap), 消费者为任务, 单生产单消费无锁队列.
+ *       任务中的记录 (SuperCapEventLog) 屏蔽中断后入队, 对接收中断而言仍只有一个生产者.
+ */
+
+#include "supercap_event.h"
+#include "super_cap.h"
+#include "main.h"
+
+static SuperCap_Event event_queue[SUPERCAP_EVENT_QUEUE_SIZE];
+static volatile uint16_t event_head = 0;   // 仅生产者写
+static volatile uint16_t event_tail = 0;   // 仅消费者写
+
+static SuperCap_EventStats event_stats;
+static volatile uint32_t fault_pending_tick[SUPERCAP_MAX_INSTANCES][SUPERCAP_EVENT_FAULT_BIT_NUM]; // 0=无未响应故障
+
+/**
+ * @brief 事件入队, 队列满则丢弃并计数
+ */
+static void event_push(uint32_t tick, uint8_t board, uint8_t bit, uint8_t rising, uint8_t error_code, uint16_t value)
+{
+    uint16_t head = event_head;
+
+    if ((uint16_t)(head - event_tail) >= SUPERCAP_EVENT_QUEUE_SIZE) {
+        event_stats.dropped++;
+        return;
+    }
+
+    event_queue[head & (SUPERCAP_EVENT_QUEUE_SIZE - 1)].tick = tick;
+    event_queue[head & (SUPERCAP_EVENT_QUEUE_SIZE - 1)].board = board;
+    event_queue[head & (SUPERCAP_EVENT_QUEUE_SIZE - 1)].bit = bit;
+    event_queue[head & (SUPERCAP_EVENT_QUEUE_SIZE - 1)].rising = rising;
+    event_queue[head & (SUPERCAP_EVENT_QUEUE_SIZE - 1)].errorCode = error_code;
+    event_queue[head & (SUPERCAP_EVENT_QUEUE_SIZE - 1)].value = value;
+
+    // 先写数据再发布下标
+    __DMB();
+    event_head = head + 1;
+}
+
+/**
+ * @brief 比较新旧 errorCode 并入队跳变事件
+ */
+void SuperCapEventDetect(uint8_t board, uint8_t last_code, uint8_t new_code, uint32_t tick)
+{
+    uint8_t changed = last_code ^ new_code;
+    uint8_t bit;
+
+    if (changed == 0) {
+        return;
+    }
+
+    for (bit = 0; bit < SUPERCAP_EVENT_BIT_NUM; bit++) {
+        if ((changed >> bit) & 0x01) {
+            uint8_t rising = (new_code >> bit) & 0x01;
+            event_push(tick, board, bit, rising, new_code, 0);
+
+            if (rising) {
+                event_stats.riseCount[bit]++;
+                // 输出禁用位不是故障, 只入队事件
+                if (bit < SUPERCAP_EVENT_FAULT_BIT_NUM && board < SUPERCAP_MAX_INSTANCES &&
+                    fault_pending_tick[board][bit] == 0) {
+                    // tick为0时记为1, 0保留表示无故障
+                    fault_pending_tick[board][bit] = tick ? tick : 1;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief 状态握手完成事件
+ */
+void SuperCapEventStateKnown(uint8_t board, uint8_t error_code, uint32_t tick)
+{
+    event_push(tick, board, SUPERCAP_EVENT_STATE_KNOWN, 1, error_code, 0);
+}
+
+/**
+ * @brief 任务中记录非errorCode事件
+ */
+void SuperCapEventLog(uint8_t board, uint8_t kind, uint8_t arg, uint8_t error_code, uint16_t value, uint32_t tick)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    event_push(tick, board, kind, arg, error_code, value);
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 取出一个事件
+ */
+uint8_t SuperCapEventPop(SuperCap_Event *evt)
+{
+    uint16_t tail = event_tail;
+
+    if (tail == event_head) {
+        return 0;
+    }
+
+    __DMB();
+    *evt = event_queue[tail & (SUPERCAP_EVENT_QUEUE_SIZE - 1)];
+    __DMB();
+    event_tail = tail + 1;
+    return 1;
+}
+
+/**
+ * @brief 记录未响应故障的反应延迟
+ */
+void SuperCapFaultReactionDone(uint32_t tick)
+{
+    uint8_t board;
+    uint8_t bit;
+
+    for (board = 0; board < SUPERCAP_MAX_INSTANCES; board++) {
+        for (bit = 0; bit < SUPERCAP_EVENT_FAULT_BIT_NUM; bit++) {
+            uint32_t start = fault_pending_tick[board][bit];
+            uint32_t latency;
+            uint8_t bin = 0;
+
+            if (start == 0) {
+                continue;
+            }
+
+            latency = tick - start;
+            while (bin < SUPERCAP_EVENT_HIST_BINS - 1 && (latency >> bin) != 0) {
+                bin++;
+            }
+            event_stats.reactionHist[bit][bin]++;
+            if (latency > event_stats.reactionMax[bit]) {
+                event_stats.reactionMax[bit] = latency;
+            }
+
+            fault_pending_tick[board][bit] = 0;
+        }
+    }
+}
+
+/**
+ * @brief 获取故障统计
+ */
+const SuperCap_EventStats *SuperCapEventGetStats(void)
+{
+    return &event_stats;
+}
@@ -0,0 +1,87 @@
+#ifndef SUPERCAP_EVENT_H
+#define SUPERCAP_EVENT_H
+#include "struct_typedef.h"
+
+#define SUPERCAP_EVENT_QUEUE_SIZE     32   // 事件队列长度, 必须为2的幂
+#define SUPERCAP_EVENT_BIT_NUM        8    // errorCode 位数 (bit0-6错误码, bit7输出禁用)
+#define SUPERCAP_EVENT_FAULT_BIT_NUM  7    // 计入反应延迟的故障位 (bit0-6, 即 SUPERCAP_GET_ERROR), bit7由操作手/待机置位, 不算故障
+#define SUPERCAP_EVENT_HIST_BINS      12   // 反应延迟直方图桶数, 第n桶为 [2^(n-1), 2^n) ms, 最后一桶收尾
+#define SUPERCAP_EVENT_STATE_KNOWN    SUPERCAP_EVENT_BIT_NUM // 事件bit取该值表示状态握手完成, 非errorCode位
+#define SUPERCAP_EVENT_RECOVERED      (SUPERCAP_EVENT_BIT_NUM + 1) // 故障恢复完成: rising=重启次数, errorCode=触发故障, value=恢复时间 (ms)
+#define SUPERCAP_EVENT_LOCKOUT        (SUPERCAP_EVENT_BIT_NUM + 2) // 故障恢复锁定: rising=重启次数, errorCode=触发故障
+#define SUPERCAP_EVENT_STANDBY        (SUPERCAP_EVENT_BIT_NUM + 3) // DCDC待机: rising=1进入, 0唤醒完成; value=唤醒延迟 (ms), 超时为0xFFFF
+
+// errorCode 单个位的跳变事件
+typedef struct
+{
+    uint32_t tick;       // 解码时刻 (HAL_GetTick, ms)
+    uint8_t board;       // 超电板序号
+    uint8_t bit;         // 跳变的位 (0-7), 或 SUPERCAP_EVENT_STATE_KNOWN 等非errorCode事件
+    uint8_t rising;      // 1=置位, 0=清除; 非errorCode事件见事件定义
+    uint8_t errorCode;   // 跳变后的完整 errorCode
+    uint16_t value;      // 非errorCode事件的附加值, 跳变事件为0
+} SuperCap_Event;
+
+// 故障统计
+typedef struct
+{
+    uint32_t dropped;                                                  // 队列满被丢弃的事件数
+    uint16_t riseCount[SUPERCAP_EVENT_BIT_NUM];                        // 各位置位次数
+    uint16_t reactionHist[SUPERCAP_EVENT_FAULT_BIT_NUM][SUPERCAP_EVENT_HIST_BINS]; // 故障到底盘降功率的延迟直方图
+    uint32_t reactionMax[SUPERCAP_EVENT_FAULT_BIT_NUM];                // 最大反应延迟 (ms)
+} SuperCap_EventStats;
+
+/**
+ * @brief 比较新旧 errorCode, 每个跳变位入队一个事件 (在解码路径中调用)
+ *
+ * @param board 超电板序号
+ * @param last_code 上一帧 errorCode
+ * @param new_code 本帧 errorCode
+ * @param tick 本帧时间戳 (ms)
+ */
+extern void SuperCapEventDetect(uint8_t board, uint8_t last_code, uint8_t new_code, uint32_t tick);
+
+/**
+ * @brief 状态握手完成, 入队一个 SUPERCAP_EVENT_STATE_KNOWN 事件 (在解码路径中调用)
+ *
+ * @param board 超电板序号
+ * @param error_code 首帧 errorCode
+ * @param tick 本帧时间戳 (ms)
+ */
+extern void SuperCapEventStateKnown(uint8_t board, uint8_t error_code, uint32_t tick);
+
+/**
+ * @brief 任务中记录非errorCode事件 (故障恢复, 待机等), 入队期间屏蔽中断, 与接收中断共用队列
+ *
+ * @param board 超电板序号
+ * @param kind 事件类型, 如 SUPERCAP_EVENT_RECOVERED
+ * @param arg 写入 rising 字段
+ * @param error_code 写入 errorCode 字段
+ * @param value 附加值
+ * @param tick 当前时刻 (ms)
+ */
+extern void SuperCapEventLog(uint8_t board, uint8_t kind, uint8_t arg, uint8_t error_code, uint16_t value, uint32_t tick);
+
+/**
+ * @brief 取出一个事件 (单消费者)
+ *
+ * @param evt 输出事件
+ * @return 1=取到事件, 0=队列为空
+ */
+extern uint8_t SuperCapEventPop(SuperCap_Event *evt);
+
+/**
+ * @brief 底盘完成降功率后调用, 记录所有未响应故障 (bit0-6) 的反应延迟
+ *
+ * @param tick 降功率生效时刻 (ms)
+ */
+extern void SuperCapFaultReactionDone(uint32_t tick);
+
+/**
+ * @brief 获取故障统计
+ *
+ * @return 统计数据指针
+ */
+extern const SuperCap_EventStats *SuperCapEventGetStats(void);
+
+#endif // !SUPERCAP_EVENT_H
@@ -0,0 +1,175 @@
+/**
+ * @file supercap_governor.c
+ * @brief 超级电容功率限制预测控制器
+ * @note 每个裁判系统功率帧, 在固定预测窗口内对候选功率限制做前向仿真,
+ *       二分搜索出缓冲能量不低于保留值的最大功率限制.
+ *       预测步数和搜索次数均为常数, 每帧计算量固定.
+ *       主机回放: make -C tools/supercap_replay governor
+ */
+
+#include "supercap_governor.h"
+#include "supercap_energy_table.h"
+#include "profile.h"
+#include "referee.h"
+
+/**
+ * @brief 按给定下发功率前向仿真, 返回缓冲能量最低点
+ * @param cmd_limit 候选下发功率限制 (W)
+ * @param referee_limit 裁判系统功率限制 (W)
+ * @param buffer 当前缓冲能量 (J)
+ * @param cap_joule 当前电容可用能量 (J)
+ * @param cap_full_joule 电容满电可用能量 (J)
+ * @param cap_max_power 电容最大放电功率 (W)
+ * @param demand 预测底盘功率 (W)
+ */
+static fp32 governor_predict_min_buffer(fp32 cmd_limit, fp32 referee_limit, fp32 buffer,
+                                        fp32 cap_joule, fp32 cap_full_joule, fp32 cap_max_power, fp32 demand)
+{
+    fp32 min_buffer = buffer;
+    uint8_t k;
+
+    for (k = 0; k < SUPERCAP_GOV_HORIZON; k++)
+    {
+        fp32 referee_draw;
+        fp32 cap_power = demand - cmd_limit; // >0 放电, <0 充电
+
+        if (cap_power > 0.0f)
+        {
+            fp32 cap_avail = cap_joule / SUPERCAP_GOV_FRAME_TIME;
+            if (cap_avail > cap_max_power)
+            {
+                cap_avail = cap_max_power;
+            }
+            if (cap_power > cap_avail)
+            {
+                cap_power = cap_avail;
+            }
+            // 电容供不上的部分直接从裁判系统取
+            referee_draw = demand - cap_power;
+            cap_joule -= cap_power * SUPERCAP_GOV_FRAME_TIME;
+        }
+        else if (cap_joule < cap_full_joule)
+        {
+            referee_draw = cmd_limit;
+            cap_joule -= cap_power * SUPERCAP_GOV_CHARGE_EFFICIENCY * SUPERCAP_GOV_FRAME_TIME;
+        }
+        else
+        {
+            // 电容已满, 板子只取底盘所需
+            referee_draw = demand;
+        }
+
+        buffer += (referee_limit - referee_draw) * SUPERCAP_GOV_FRAME_TIME;
+        if (buffer > SUPERCAP_GOV_BUFFER_MAX)
+        {
+            buffer = SUPERCAP_GOV_BUFFER_MAX;
+        }
+        if (buffer < min_buffer)
+        {
+            min_buffer = buffer;
+        }
+    }
+
+    return min_buffer;
+}
+
+/**
+ * @brief 初始化预测控制器
+ */
+void SuperCapGovernorInit(SuperCap_Governor *gov)
+{
+    gov->powerLimit = SUPERCAP_DEFAULT_POWER_LIMIT;
+    gov->energyBuffer = SUPERCAP_DEFAULT_ENERGY_BUFFER;
+    gov->predictedMinBuffer = SUPERCAP_GOV_BUFFER_MAX;
+    gov->bufferAtRisk = 0;
+    gov->frameCount = 0;
+}
+
+/**
+ * @brief 预测控制核心计算
+ */
+void SuperCapGovernorStep(SuperCap_Governor *gov, uint16_t referee_power_limit, fp32 referee_buffer,
+                          uint8_t cap_energy, fp32 chassis_power)
+{
+    fp32 cap_joule = (fp32)SUPERCAP_USABLE_ENERGY_DJ(cap_energy) * 0.1f;
+    fp32 cap_full_joule = (fp32)SUPERCAP_USABLE_ENERGY_DJ(255) * 0.1f;
+    fp32 cap_max_power = (fp32)SUPERCAP_PEAK_POWER_DW(cap_energy) * 0.1f;
+    fp32 demand = chassis_power;
+    fp32 lo = (fp32)SUPERCAP_GOV_MIN_POWER_LIMIT;
+    fp32 hi = (fp32)SUPERCAP_GOV_MAX_POWER_LIMIT;
+    fp32 lo_min_buffer;
+    uint8_t i;
+
+    PROFILE_BEGIN(PROFILE_SUPERCAP_GOVERNOR);
+
+    // 功率帧可能出现NaN或负值, 按0处理
+    if (!(demand > 0.0f))
+    {
+        demand = 0.0f;
+    }
+
+    lo_min_buffer = governor_predict_min_buffer(lo, (fp32)referee_power_limit, referee_buffer,
+                                                cap_joule, cap_full_joule, cap_max_power, demand);
+    gov->bufferAtRisk = lo_min_buffer < SUPERCAP_GOV_BUFFER_RESERVE;
+
+    if (gov->bufferAtRisk)
+    {
+        gov->powerLimit = SUPERCAP_GOV_MIN_POWER_LIMIT;
+        gov->predictedMinBuffer = lo_min_buffer;
+    }
+    else
+    {
+        // 预测缓冲最低点随下发功率单调不增, 二分即可
+        gov->predictedMinBuffer = lo_min_buffer;
+        for (i = 0; i < SUPERCAP_GOV_SEARCH_ITER; i++)
+        {
+            fp32 mid = 0.5f * (lo + hi);
+            fp32 mid_min_buffer = governor_predict_min_buffer(mid, (fp32)referee_power_limit, referee_buffer,
+                                                              cap_joule, cap_full_joule, cap_max_power, demand);
+            if (mid_min_buffer >= SUPERCAP_GOV_BUFFER_RESERVE)
+            {
+                lo = mid;
+                gov->predictedMinBuffer = mid_min_buffer;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        gov->powerLimit = (uint16_t)lo;
+    }
+
+    if (referee_buffer < 0.0f)
+    {
+        gov->energyBuffer = 0;
+    }
+    else if (referee_buffer > (fp32)SUPERCAP_GOV_MAX_ENERGY_BUFFER)
+    {
+        gov->energyBuffer = SUPERCAP_GOV_MAX_ENERGY_BUFFER;
+    }
+    else
+    {
+        gov->energyBuffer = (uint16_t)referee_buffer;
+    }
+
+    gov->frameCount++;
+
+    PROFILE_END(PROFILE_SUPERCAP_GOVERNOR);
+}
+
+/**
+ * @brief 读取裁判系统数据并更新超电发送实例
+ */
+void SuperCapGovernorUpdate(SuperCap_Governor *gov, SuperCap_TX_Msg_send *tx, const SuperCap_Msg_get *rx)
+{
+    fp32 referee_power = 0.0f;
+    fp32 referee_buffer = 0.0f;
+
+    supercap_gov_get_referee_buffer(&referee_power, &referee_buffer);
+
+    SuperCapGovernorStep(gov, supercap_gov_get_referee_power_limit(), referee_buffer,
+                         rx->capEnergy, rx->chassisPower);
+
+    SuperCapSetPowerLimit(tx, gov->powerLimit);
+    SuperCapSetEnergyBuffer(tx, gov->energyBuffer);
+}
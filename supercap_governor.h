@@ -0,0 +1,65 @@
+#ifndef SUPERCAP_GOVERNOR_H
+#define SUPERCAP_GOVERNOR_H
+#include "struct_typedef.h"
+#include "super_cap.h"
+
+// 裁判系统接口 (移植时只需修改这里)
+#define supercap_gov_get_referee_buffer(power, buffer)  get_chassis_power_and_buffer((power), (buffer))
+#define supercap_gov_get_referee_power_limit()          get_chassis_power_limit()
+
+// 预测控制参数
+#define SUPERCAP_GOV_FRAME_TIME           0.02f   // 裁判系统功率帧周期 (s), 50Hz
+#define SUPERCAP_GOV_HORIZON              10      // 预测步数 (固定, 每帧计算量恒定)
+#define SUPERCAP_GOV_SEARCH_ITER          8       // 功率限制二分搜索次数 (固定)
+#define SUPERCAP_GOV_CYCLE_BUDGET         16800   // 每帧计算预算 (周期), 100us @168MHz, 与 PROFILE_SUPERCAP_GOVERNOR 最大值对照
+#define SUPERCAP_GOV_BUFFER_MAX           60.0f   // 裁判系统缓冲能量上限 (J)
+#define SUPERCAP_GOV_BUFFER_RESERVE       10.0f   // 缓冲能量保留值, 预测最低点不得低于此值 (J)
+#define SUPERCAP_GOV_MIN_POWER_LIMIT      30      // 下发功率限制下限 (W)
+#define SUPERCAP_GOV_MAX_POWER_LIMIT      250     // 下发功率限制上限 (W)
+#define SUPERCAP_GOV_MAX_ENERGY_BUFFER    300     // 下发能量缓冲上限 (J)
+
+// 电容模型参数 (可用能量与最大放电功率查 supercap_energy_table)
+#define SUPERCAP_GOV_CHARGE_EFFICIENCY    0.9f    // 充电效率
+
+// 预测控制器状态
+typedef struct
+{
+    uint16_t powerLimit;         // 本帧下发功率限制 (W)
+    uint16_t energyBuffer;       // 本帧下发能量缓冲 (J)
+    fp32 predictedMinBuffer;     // 按下发值预测的缓冲能量最低点 (J)
+    uint8_t bufferAtRisk;        // 1=任何下发值都无法保住保留能量, 需底盘限功率
+    uint32_t frameCount;         // 已处理的裁判系统帧数
+} SuperCap_Governor;
+
+/**
+ * @brief 初始化预测控制器
+ *
+ * @param gov 控制器实例
+ */
+extern void SuperCapGovernorInit(SuperCap_Governor *gov);
+
+/**
+ * @brief 预测控制核心计算 (不访问裁判系统, 可离线回放)
+ *
+ * @param gov 控制器实例
+ * @param referee_power_limit 裁判系统底盘功率限制 (W)
+ * @param referee_buffer 裁判系统缓冲能量 (J)
+ * @param cap_energy 电容能量 (0-255)
+ * @param chassis_power 底盘功率 (W)
+ */
+extern void SuperCapGovernorStep(SuperCap_Governor *gov, uint16_t referee_power_limit, fp32 referee_buffer,
+                                 uint8_t cap_energy, fp32 chassis_power);
+
+/**
+ * @brief 每个裁判系统功率帧调用一次, 读取裁判数据并写入超电发送实例
+ * @note 在裁判系统任务解析完功率热量数据 (0x0202, 50Hz) 之后调用, 与该帧同步;
+ *       不要放在底盘任务的固定周期里, 否则同一帧会被重复计算或漏掉.
+ *       调用之后由超电发送任务照常发出 tx.
+ *
+ * @param gov 控制器实例
+ * @param tx 超电发送实例
+ * @param rx 超电接收实例
+ */
+extern void SuperCapGovernorUpdate(SuperCap_Governor *gov, SuperCap_TX_Msg_send *tx, const SuperCap_Msg_get *rx);
+
+#endif // !SUPERCAP_GOVERNOR_H
@@ -0,0 +1,232 @@
+/**
+ * @file supercap_match.c
+ * @brief 超级电容单场比赛能量统计与flash日志
+ * @note 日志为定长记录顺序追加, 每条与校准数据格式相同: 数据字 + {name[3], cali_flag}.
+ *       先写数据再写头, 头为擦除值的槽位视为未完成. 查找空位要求整槽为擦除值,
+ *       写入中途掉电的槽位会被跳过. 擦除会让内核停顿, 只在上电初始化时进行.
+ */
+
+#include "supercap_match.h"
+#include "supercap_energy_table.h"
+#include "bsp_flash.h"
+#include "calibrate_task.h"
+#include "referee.h"
+#include <stddef.h>
+#include <string.h>
+
+#define MATCH_DATA_WORDS      (sizeof(SuperCap_MatchSummary) / 4)
+#define MATCH_SLOT_WORDS      (MATCH_DATA_WORDS + CALI_SENSOR_HEAD_LEGHT)
+#define MATCH_SLOT_NUM        (SUPERCAP_MATCH_FLASH_SIZE / (MATCH_SLOT_WORDS * 4))
+#define MATCH_ERASED_WORD     0xFFFFFFFF
+#define MATCH_VERSION_WORD    (offsetof(SuperCap_MatchSummary, version) / 4)
+#define MATCH_VERSION_SHIFT   ((offsetof(SuperCap_MatchSummary, version) % 4) * 8)
+
+typedef char match_summary_size_check[(sizeof(SuperCap_MatchSummary) % 4 == 0) ? 1 : -1];
+typedef char match_version_offset_check[(offsetof(SuperCap_MatchSummary, version) == 31) ? 1 : -1];
+
+static SuperCap_MatchSummary match_summary[SUPERCAP_MAX_INSTANCES];
+static uint32_t match_last_tick[SUPERCAP_MAX_INSTANCES];
+static uint8_t match_ref_energy[SUPERCAP_MAX_INSTANCES];  // 上次计入充放电时的 capEnergy
+static uint8_t match_last_code[SUPERCAP_MAX_INSTANCES];
+static uint8_t match_primed[SUPERCAP_MAX_INSTANCES];
+static volatile uint8_t match_active = 0;
+static uint32_t match_next_slot = 0;      // 下一个空槽
+static uint32_t match_next_index = 0;     // 下一场比赛序号
+
+/**
+ * @brief 槽位地址
+ */
+static uint32_t match_slot_addr(uint32_t slot)
+{
+    return SUPERCAP_MATCH_FLASH_ADDR + slot * MATCH_SLOT_WORDS * 4;
+}
+
+/**
+ * @brief 槽位是否全为擦除值
+ */
+static uint8_t match_slot_erased(uint32_t slot)
+{
+    uint32_t word;
+    uint8_t i;
+
+    for (i = 0; i < MATCH_SLOT_WORDS; i++) {
+        cali_flash_read(match_slot_addr(slot) + i * 4, &word, 1);
+        if (word != MATCH_ERASED_WORD) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief 上电初始化, 查找日志空位
+ */
+void SuperCapMatchInit(void)
+{
+    uint32_t slot;
+    uint32_t head;
+    uint32_t index;
+    uint32_t word;
+
+    // 记录长度随版本变化, 旧版本日志无法按新布局分槽, 上电时擦除
+    if (!match_slot_erased(0)) {
+        cali_flash_read(SUPERCAP_MATCH_FLASH_ADDR + MATCH_VERSION_WORD * 4, &word, 1);
+        if (((word >> MATCH_VERSION_SHIFT) & 0xFF) != SUPERCAP_MATCH_VERSION) {
+            cali_flash_erase(SUPERCAP_MATCH_FLASH_ADDR, 1);
+        }
+    }
+
+    match_next_index = 0;
+    for (slot = 0; slot < MATCH_SLOT_NUM; slot++) {
+        if (match_slot_erased(slot)) {
+            break;
+        }
+
+        // 完整记录: 头的标志位有效, 接着其序号编号
+        cali_flash_read(match_slot_addr(slot) + MATCH_DATA_WORDS * 4, &head, 1);
+        if (((head >> 24) & 0xFF) == CALIED_FLAG) {
+            cali_flash_read(match_slot_addr(slot), &index, 1);
+            if (index + 1 > match_next_index) {
+                match_next_index = index + 1;
+            }
+        }
+    }
+
+    if (slot == MATCH_SLOT_NUM) {
+        // 日志已满, 上电时擦除重新开始, 比赛序号保持递增
+        cali_flash_erase(SUPERCAP_MATCH_FLASH_ADDR, 1);
+        slot = 0;
+    }
+    match_next_slot = slot;
+}
+
+/**
+ * @brief 比赛开始
+ */
+void SuperCapMatchStart(uint32_t tick)
+{
+    uint8_t robot_id = (uint8_t)supercap_match_get_robot_id();
+    uint8_t i;
+
+    match_active = 0;
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        memset(&match_summary[i], 0, sizeof(SuperCap_MatchSummary));
+        match_summary[i].matchIndex = match_next_index;
+        match_summary[i].board = i;
+        match_summary[i].version = SUPERCAP_MATCH_VERSION;
+        match_summary[i].robotId = robot_id;
+        match_last_tick[i] = tick;
+        match_primed[i] = 0;
+    }
+    match_active = 1;
+}
+
+/**
+ * @brief 每帧累加统计
+ */
+void SuperCapMatchAccumulate(uint8_t board, const SuperCap_Msg_get *cap, uint32_t tick)
+{
+    SuperCap_MatchSummary *sum;
+    uint8_t rising;
+    fp32 power_dw;
+    uint8_t bit;
+
+    if (!match_active || board >= SUPERCAP_MAX_INSTANCES) {
+        return;
+    }
+
+    sum = &match_summary[board];
+    sum->frames++;
+
+    power_dw = cap->chassisPower * 10.0f;
+    if (power_dw > (fp32)sum->peakPowerDw) {
+        sum->peakPowerDw = power_dw > 32767.0f ? 32767 : (int16_t)power_dw;
+    }
+
+    if (match_primed[board]) {
+        uint32_t dt = tick - match_last_tick[board];
+
+        // 离线期间不计时长
+        if (dt <= SUPERCAP_OFFLINE_TIME) {
+            sum->durationMs += dt;
+            if (cap->chassisPower > (fp32)cap->chassisPowerLimit) {
+                sum->boostMs += dt;
+            }
+            if (SUPERCAP_OUTPUT_DISABLED(cap->errorCode)) {
+                sum->disabledMs += dt;
+            }
+        }
+
+        // capEnergy 在相邻两级间跳动时逐帧差分会把充放电都累加上去, 超过死区才计入
+        if (cap->capEnergy >= match_ref_energy[board] + SUPERCAP_MATCH_ENERGY_DEADBAND) {
+            sum->chargedDj += SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy) - SUPERCAP_USABLE_ENERGY_DJ(match_ref_energy[board]);
+            match_ref_energy[board] = cap->capEnergy;
+        } else if (cap->capEnergy + SUPERCAP_MATCH_ENERGY_DEADBAND <= match_ref_energy[board]) {
+            sum->dischargedDj += SUPERCAP_USABLE_ENERGY_DJ(match_ref_energy[board]) - SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy);
+            match_ref_energy[board] = cap->capEnergy;
+        }
+
+        rising = cap->errorCode & ~match_last_code[board];
+        for (bit = 0; rising != 0; bit++, rising >>= 1) {
+            if (rising & 0x01) {
+                sum->errorRise[bit]++;
+            }
+        }
+    } else {
+        match_ref_energy[board] = cap->capEnergy;
+    }
+
+    match_last_tick[board] = tick;
+    match_last_code[board] = cap->errorCode;
+    match_primed[board] = 1;
+}
+
+/**
+ * @brief 比赛结束, 写入记录
+ */
+uint8_t SuperCapMatchEnd(void)
+{
+    uint32_t head;
+    uint8_t written = 0;
+    uint8_t i;
+
+    if (!match_active) {
+        return 0;
+    }
+    match_active = 0;
+
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        uint32_t addr;
+
+        if (match_summary[i].frames == 0) {
+            continue;
+        }
+        if (match_next_slot >= MATCH_SLOT_NUM) {
+            break;
+        }
+
+        // 先写数据, 最后写头作为完成标记
+        addr = match_slot_addr(match_next_slot);
+        cali_flash_write(addr, (uint32_t *)&match_summary[i], MATCH_DATA_WORDS);
+        head = (uint32_t)SUPERCAP_MATCH_NAME[0] | ((uint32_t)SUPERCAP_MATCH_NAME[1] << 8) |
+               ((uint32_t)('0' + i) << 16) | ((uint32_t)CALIED_FLAG << 24);
+        cali_flash_write(addr + MATCH_DATA_WORDS * 4, &head, CALI_SENSOR_HEAD_LEGHT);
+
+        match_next_slot++;
+        written++;
+    }
+
+    match_next_index++;
+    return written;
+}
+
+/**
+ * @brief 获取当前比赛统计
+ */
+const SuperCap_MatchSummary *SuperCapMatchGetSummary(uint8_t board)
+{
+    if (board >= SUPERCAP_MAX_INSTANCES) {
+        return NULL;
+    }
+    return &match_summary[board];
+}
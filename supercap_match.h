@@ -0,0 +1,72 @@
+#ifndef SUPERCAP_MATCH_H
+#define SUPERCAP_MATCH_H
+#include "struct_typedef.h"
+#include "super_cap.h"
+
+// 比赛统计日志区, 与 calibrate_task 的校准扇区分开, 避免校准保存擦掉日志
+#define SUPERCAP_MATCH_FLASH_ADDR         ADDR_FLASH_SECTOR_10   // 日志扇区起始地址
+#define SUPERCAP_MATCH_FLASH_SIZE         0x20000                // 日志扇区大小 (字节)
+#define SUPERCAP_MATCH_VERSION            2                      // 记录格式版本, 修改 SuperCap_MatchSummary 时加1
+#define SUPERCAP_MATCH_NAME               "MT"                   // 记录名 name[0-1], name[2] 为板序号
+#define SUPERCAP_MATCH_ENERGY_DEADBAND    2                      // capEnergy 相对上次计入值变化达到该值才计入充放电, 滤除量化抖动
+
+// 裁判系统接口 (移植时只需修改这里)
+#define supercap_match_get_robot_id()     get_robot_id()
+
+// 单块板一场比赛的统计, 按校准记录格式写入flash: 本结构 + name[3] + cali_flag
+// 长度必须为4字节倍数, tools/aggregate_match_summary.py 按同样布局解析
+// version 固定在第31字节, 上电发现日志版本不同时擦除日志扇区
+typedef struct
+{
+    uint32_t matchIndex;         // 比赛序号, 上电后接着flash中最后一条递增
+    uint32_t durationMs;         // 有效数据时长 (ms)
+    uint32_t frames;             // 收到的帧数
+    uint32_t chargedDj;          // 充入电容的能量 (0.1J)
+    uint32_t dischargedDj;       // 电容放出的能量 (0.1J)
+    uint32_t boostMs;            // chassisPower 超过 chassisPowerLimit 的时长 (ms)
+    uint32_t disabledMs;         // 输出禁用时长 (ms)
+    int16_t peakPowerDw;         // chassisPower 峰值 (0.1W)
+    uint8_t board;               // 超电板序号
+    uint8_t version;             // SUPERCAP_MATCH_VERSION
+    uint16_t errorRise[8];       // errorCode 各位置位次数, bit7为输出禁用
+    uint8_t robotId;             // 比赛开始时裁判系统的机器人ID, 多台机器人日志汇总时区分
+    uint8_t resv[3];             // 保留, 补齐4字节
+} SuperCap_MatchSummary;
+
+/**
+ * @brief 上电初始化, 查找日志空位. 日志写满时在此擦除 (仅上电时, 比赛中不擦除)
+ */
+extern void SuperCapMatchInit(void);
+
+/**
+ * @brief 比赛开始, 清零统计 (裁判系统比赛开始时调用)
+ *
+ * @param tick 当前时刻 (ms)
+ */
+extern void SuperCapMatchStart(uint32_t tick);
+
+/**
+ * @brief 每帧累加统计, O(1) (在解码路径中调用)
+ *
+ * @param board 超电板序号
+ * @param cap 本帧接收数据
+ * @param tick 本帧测量时刻 (ms)
+ */
+extern void SuperCapMatchAccumulate(uint8_t board, const SuperCap_Msg_get *cap, uint32_t tick);
+
+/**
+ * @brief 比赛结束, 每块收到过数据的板写入一条记录, 只编程不擦除
+ *
+ * @return 写入的记录数, 日志已满时少于在线板数
+ */
+extern uint8_t SuperCapMatchEnd(void);
+
+/**
+ * @brief 获取当前比赛统计
+ *
+ * @param board 超电板序号
+ * @return 统计数据指针, 序号越界返回NULL
+ */
+extern const SuperCap_MatchSummary *SuperCapMatchGetSummary(uint8_t board);
+
+#endif // !SUPERCAP_MATCH_H
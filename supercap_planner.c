@@ -0,0 +1,116 @@
+/**
+ * @file supercap_planner.c
+ * @brief 超级电容冲刺规划: 剩余时间与加速时长预测
+ * @note 模型放电功率 = chassisPower - chassisPowerLimit, 与估计窗口内可用能量变化
+ *       得到的平均实测放电功率比较, 差值低通后作为变换器损耗补偿. 窗口远长于一帧,
+ *       capEnergy 的量化误差被摊薄; 电容满电或可用能量为0 (截止电压以下) 时窗口作废不学习. 每帧O(1).
+ */
+
+#include "supercap_planner.h"
+#include "supercap_energy_table.h"
+
+/**
+ * @brief 由能量和净放电功率计算剩余时间
+ */
+static uint16_t planner_time_left(fp32 energy, fp32 net_discharge)
+{
+    fp32 time_ms;
+
+    if (net_discharge <= 0.0f) {
+        return SUPERCAP_PLANNER_INFINITE_TIME;
+    }
+
+    time_ms = energy * 1000.0f / net_discharge;
+    if (time_ms >= (fp32)SUPERCAP_PLANNER_INFINITE_TIME) {
+        return SUPERCAP_PLANNER_INFINITE_TIME - 1;
+    }
+    return (uint16_t)time_ms;
+}
+
+/**
+ * @brief 初始化冲刺规划器
+ */
+void SuperCapPlannerInit(SuperCap_Planner *planner)
+{
+    planner->lossPower = 0.0f;
+    planner->netDischarge = 0.0f;
+    planner->usableEnergy = 0.0f;
+    planner->peakPower = 0.0f;
+    planner->chassisPowerLimit = SUPERCAP_DEFAULT_POWER_LIMIT;
+    planner->timeToEmpty = SUPERCAP_PLANNER_INFINITE_TIME;
+    planner->boostAllowed = 0;
+    planner->windowEnergy = 0.0f;
+    planner->windowModel = 0.0f;
+    planner->windowTick = 0;
+    planner->lastTick = 0;
+    planner->primed = 0;
+}
+
+/**
+ * @brief 更新冲刺规划器
+ */
+void SuperCapPlannerUpdate(SuperCap_Planner *planner, const SuperCap_Msg_get *cap, uint32_t tick)
+{
+    fp32 chassis_power = cap->chassisPower;
+    fp32 model_discharge;
+    uint32_t dt = tick - planner->lastTick;
+
+    // NaN或负值按0处理
+    if (!(chassis_power > 0.0f)) {
+        chassis_power = 0.0f;
+    }
+
+    planner->usableEnergy = (fp32)SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy) * 0.1f;
+    planner->peakPower = (fp32)SUPERCAP_PEAK_POWER_DW(cap->capEnergy) * 0.1f;
+    planner->chassisPowerLimit = cap->chassisPowerLimit;
+    model_discharge = chassis_power - (fp32)cap->chassisPowerLimit;
+
+    // 截止电压以下查表可用能量恒为0, 实测放电读不出来, 与满电一样不学习
+    if (!planner->primed || dt > SUPERCAP_PLANNER_MAX_DT ||
+        cap->capEnergy >= SUPERCAP_PLANNER_FULL_ENERGY || SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy) == 0) {
+        // 重新开始窗口
+        planner->windowEnergy = planner->usableEnergy;
+        planner->windowModel = 0.0f;
+        planner->windowTick = tick;
+    } else {
+        uint32_t window = tick - planner->windowTick;
+
+        planner->windowModel += model_discharge * (fp32)dt * 0.001f;
+        if (window >= SUPERCAP_PLANNER_LOSS_WINDOW) {
+            fp32 measured = (planner->windowEnergy - planner->usableEnergy) * 1000.0f / (fp32)window;
+            fp32 model = planner->windowModel * 1000.0f / (fp32)window;
+            planner->lossPower += SUPERCAP_PLANNER_ALPHA * ((measured - model) - planner->lossPower);
+            planner->windowEnergy = planner->usableEnergy;
+            planner->windowModel = 0.0f;
+            planner->windowTick = tick;
+        }
+    }
+
+    planner->netDischarge = model_discharge + planner->lossPower;
+    planner->timeToEmpty = planner_time_left(planner->usableEnergy, planner->netDischarge);
+
+    // 迟滞开关, 电容放空前关闭加速
+    if (planner->boostAllowed && planner->timeToEmpty < SUPERCAP_PLANNER_CUTOFF_TIME) {
+        planner->boostAllowed = 0;
+    } else if (!planner->boostAllowed && planner->timeToEmpty > SUPERCAP_PLANNER_RESUME_TIME) {
+        planner->boostAllowed = 1;
+    }
+
+    planner->lastTick = tick;
+    planner->primed = 1;
+}
+
+/**
+ * @brief 预测以指定功率加速能持续的时间
+ */
+uint16_t SuperCapPlannerBurstTime(const SuperCap_Planner *planner, fp32 request_power)
+{
+    fp32 cap_power = request_power - (fp32)planner->chassisPowerLimit;
+
+    // 超出电容当前最大放电能力, 无法维持
+    if (cap_power > planner->peakPower) {
+        return 0;
+    }
+
+    return planner_time_left(planner->usableEnergy, cap_power + planner->lossPower);
+}
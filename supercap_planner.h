@@ -0,0 +1,56 @@
+#ifndef SUPERCAP_PLANNER_H
+#define SUPERCAP_PLANNER_H
+#include "struct_typedef.h"
+#include "super_cap.h"
+
+#define SUPERCAP_PLANNER_ALPHA            0.2f    // 损耗估计低通系数, 每个估计窗口更新一次
+#define SUPERCAP_PLANNER_MAX_DT           200     // 帧间隔超过该值不参与估计 (ms)
+#define SUPERCAP_PLANNER_LOSS_WINDOW      2000    // 损耗估计窗口 (ms), capEnergy 单步约10J, 窗口内量化误差约5W
+#define SUPERCAP_PLANNER_FULL_ENERGY      250     // capEnergy 不低于该值视为满电, 充电受限, 不学习
+#define SUPERCAP_PLANNER_INFINITE_TIME    0xFFFF  // 不放电时的剩余时间 (ms)
+#define SUPERCAP_PLANNER_CUTOFF_TIME      500     // 剩余时间低于该值关闭加速 (ms)
+#define SUPERCAP_PLANNER_RESUME_TIME      1500    // 剩余时间高于该值恢复加速 (ms), 迟滞
+
+// 冲刺规划器状态
+typedef struct
+{
+    fp32 lossPower;              // 估计的额外损耗功率 (W), 实测放电 - 模型放电
+    fp32 netDischarge;           // 当前净放电功率 (W), >0 为放电
+    fp32 usableEnergy;           // 当前可用能量 (J)
+    fp32 peakPower;              // 当前最大放电功率 (W)
+    uint16_t chassisPowerLimit;  // 最近一帧底盘功率限制 (W)
+    uint16_t timeToEmpty;        // 当前功率下的剩余时间 (ms)
+    uint8_t boostAllowed;        // 1=允许加速
+    fp32 windowEnergy;           // 估计窗口起点的可用能量 (J)
+    fp32 windowModel;            // 窗口内模型放电能量累加 (J)
+    uint32_t windowTick;         // 估计窗口起点时刻 (ms)
+    uint32_t lastTick;           // 上一帧时间戳 (ms)
+    uint8_t primed;              // 1=已有上一帧
+} SuperCap_Planner;
+
+/**
+ * @brief 初始化冲刺规划器
+ *
+ * @param planner 规划器实例
+ */
+extern void SuperCapPlannerInit(SuperCap_Planner *planner);
+
+/**
+ * @brief 每收到一帧超电数据调用一次, O(1)
+ *
+ * @param planner 规划器实例
+ * @param cap 超电接收实例
+ * @param tick 本帧时间戳 (ms)
+ */
+extern void SuperCapPlannerUpdate(SuperCap_Planner *planner, const SuperCap_Msg_get *cap, uint32_t tick);
+
+/**
+ * @brief 预测以指定功率加速能持续的时间
+ *
+ * @param planner 规划器实例
+ * @param request_power 请求的底盘功率 (W)
+ * @return 可持续时间 (ms), 不放电时返回 SUPERCAP_PLANNER_INFINITE_TIME
+ */
+extern uint16_t SuperCapPlannerBurstTime(const SuperCap_Planner *planner, fp32 request_power);
+
+#endif // !SUPERCAP_PLANNER_H
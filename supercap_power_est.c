@@ -0,0 +1,155 @@
+/**
+ * @file supercap_power_est.c
+ * @brief 1kHz底盘电功率估计: 电机电流/转速模型 + 超电帧在线校正
+ * @note 每ms由M3508反馈计算特征并预测功率; 每收到一帧超电数据, 按时间戳查找
+ *       测量时刻对应的特征做一次递推最小二乘 (RLS) 更新, 补偿传输延迟.
+ *       静止或匀速时部分特征长期无激励, 遗忘因子会让对应方向的协方差按 1/lambda
+ *       指数增长, 因此每次更新后把协方差的迹限制在 SUPERCAP_EST_TRACE_MAX 内.
+ *       sum(I*w) 可达数万而常数项为1, 直接用于单精度RLS时 x'Px 被最大的特征淹没,
+ *       所以特征先按 SUPERCAP_EST_SCALE_* 归一化到1附近, 系数相应以W为单位.
+ */
+
+#include "supercap_power_est.h"
+#include "CAN_receive.h"
+#include <string.h>
+
+/**
+ * @brief 由特征和系数计算功率
+ */
+static fp32 est_predict(const fp32 k[SUPERCAP_EST_PARAM_NUM], const fp32 x[SUPERCAP_EST_PARAM_NUM])
+{
+    return k[0] * x[0] + k[1] * x[1] + k[2] * x[2] + k[3] * x[3];
+}
+
+/**
+ * @brief 查找测量时刻对应的特征
+ * @note 取不晚于测量时刻的最新特征; 控制任务偶尔跳过1ms时下标与时刻不再一一对应,
+ *       因此按时间戳匹配而不是按 head - age 取下标
+ * @return 特征, 超出历史窗口时返回NULL
+ */
+static const fp32 *est_find_feature(const SuperCap_PowerEst *est, uint32_t sample_tick)
+{
+    uint16_t idx = est->head;
+    uint8_t n;
+
+    if ((uint32_t)(est->featureTick[est->head] - sample_tick) >= SUPERCAP_EST_HISTORY) {
+        return NULL;
+    }
+
+    for (n = 0; n < SUPERCAP_EST_HISTORY; n++) {
+        if ((int32_t)(est->featureTick[idx] - sample_tick) <= 0) {
+            return est->feature[idx];
+        }
+        idx = (idx - 1) & (SUPERCAP_EST_HISTORY - 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 初始化功率估计器
+ */
+void SuperCapPowerEstInit(SuperCap_PowerEst *est)
+{
+    uint8_t i;
+
+    memset(est, 0, sizeof(SuperCap_PowerEst));
+
+    // M3508转子转矩常数, 绕组电阻, 转速相关损耗, 静态功耗的经验初值, 换算到归一化特征
+    est->k[0] = 0.0157f * SUPERCAP_EST_SCALE_IW;
+    est->k[1] = 0.2f * SUPERCAP_EST_SCALE_I2;
+    est->k[2] = 0.001f * SUPERCAP_EST_SCALE_W;
+    est->k[3] = 3.0f;
+
+    for (i = 0; i < SUPERCAP_EST_PARAM_NUM; i++) {
+        est->P[i][i] = SUPERCAP_EST_P0;
+    }
+}
+
+/**
+ * @brief 由底盘电机反馈预测电功率
+ */
+fp32 SuperCapPowerEstTick(SuperCap_PowerEst *est, uint32_t tick)
+{
+    fp32 *x;
+    uint8_t i;
+
+    est->head = (est->head + 1) & (SUPERCAP_EST_HISTORY - 1);
+    x = est->feature[est->head];
+    x[0] = 0.0f;
+    x[1] = 0.0f;
+    x[2] = 0.0f;
+    x[3] = 1.0f;
+
+    for (i = 0; i < SUPERCAP_EST_MOTOR_NUM; i++) {
+        const motor_measure_t *motor = get_chassis_motor_measure_point(i);
+        fp32 current = (fp32)motor->given_current * M3508_CURRENT_TO_AMP;
+        fp32 omega = (fp32)motor->speed_rpm * M3508_RPM_TO_RAD_S;
+
+        x[0] += current * omega;
+        x[1] += current * current;
+        x[2] += omega > 0.0f ? omega : -omega;
+    }
+    x[0] *= 1.0f / SUPERCAP_EST_SCALE_IW;
+    x[1] *= 1.0f / SUPERCAP_EST_SCALE_I2;
+    x[2] *= 1.0f / SUPERCAP_EST_SCALE_W;
+
+    est->featureTick[est->head] = tick;
+    est->power = est_predict(est->k, x);
+    return est->power;
+}
+
+/**
+ * @brief 用测量时刻的特征在线校正模型
+ */
+void SuperCapPowerEstCorrect(SuperCap_PowerEst *est, fp32 chassis_power, uint32_t sample_tick)
+{
+    const fp32 *x = est_find_feature(est, sample_tick);
+    fp32 Px[SUPERCAP_EST_PARAM_NUM];
+    fp32 denom;
+    fp32 gain[SUPERCAP_EST_PARAM_NUM];
+    fp32 trace = 0.0f;
+    uint8_t i, j;
+
+    // 丢弃NaN/Inf以及超出历史窗口的样本
+    if (!(chassis_power > -1000.0f && chassis_power < 1000.0f) || x == NULL) {
+        est->missedSamples++;
+        return;
+    }
+
+    est->residual = chassis_power - est_predict(est->k, x);
+
+    // RLS: K = P x / (lambda + x' P x), k += K e, P = (P - K x' P) / lambda
+    denom = SUPERCAP_EST_LAMBDA;
+    for (i = 0; i < SUPERCAP_EST_PARAM_NUM; i++) {
+        Px[i] = 0.0f;
+        for (j = 0; j < SUPERCAP_EST_PARAM_NUM; j++) {
+            Px[i] += est->P[i][j] * x[j];
+        }
+        denom += x[i] * Px[i];
+    }
+    for (i = 0; i < SUPERCAP_EST_PARAM_NUM; i++) {
+        gain[i] = Px[i] / denom;
+        est->k[i] += gain[i] * est->residual;
+    }
+    for (i = 0; i < SUPERCAP_EST_PARAM_NUM; i++) {
+        for (j = 0; j < SUPERCAP_EST_PARAM_NUM; j++) {
+            // P对称, x'P 即 Px 的转置
+            est->P[i][j] = (est->P[i][j] - gain[i] * Px[j]) / SUPERCAP_EST_LAMBDA;
+        }
+        trace += est->P[i][i];
+    }
+
+    // 整体缩放保持P对称正定
+    if (trace > SUPERCAP_EST_TRACE_MAX) {
+        fp32 scale = SUPERCAP_EST_TRACE_MAX / trace;
+
+        for (i = 0; i < SUPERCAP_EST_PARAM_NUM; i++) {
+            for (j = 0; j < SUPERCAP_EST_PARAM_NUM; j++) {
+                est->P[i][j] *= scale;
+            }
+        }
+        est->traceClamps++;
+    }
+
+    est->corrections++;
+}
@@ -0,0 +1,64 @@
+#ifndef SUPERCAP_POWER_EST_H
+#define SUPERCAP_POWER_EST_H
+#include "struct_typedef.h"
+
+#define SUPERCAP_EST_MOTOR_NUM        4         // 底盘M3508数量
+#define SUPERCAP_EST_PARAM_NUM        4         // 模型参数个数
+#define SUPERCAP_EST_HISTORY          32        // 特征历史长度 (ms), 需为2的幂, 覆盖传输延迟
+#define SUPERCAP_EST_LAMBDA           0.999f    // RLS遗忘因子
+#define SUPERCAP_EST_P0               1000.0f   // RLS协方差初值
+#define SUPERCAP_EST_TRACE_MAX        (SUPERCAP_EST_P0 * SUPERCAP_EST_PARAM_NUM)  // 协方差迹上限, 防止激励不足时发散
+
+// 特征归一化尺度, 各特征满量程约为1, 单精度下RLS条件数不因量纲悬殊而恶化
+#define SUPERCAP_EST_SCALE_IW         20000.0f  // sum(I*w): 4个电机, 20A x 约250rad/s
+#define SUPERCAP_EST_SCALE_I2         400.0f    // sum(I^2): 4个电机, 约10A有效值
+#define SUPERCAP_EST_SCALE_W          1000.0f   // sum(|w|): 4个电机, 约250rad/s
+
+#define M3508_CURRENT_TO_AMP          (20.0f / 16384.0f)            // given_current原始值转A
+#define M3508_RPM_TO_RAD_S            (2.0f * 3.14159265f / 60.0f)  // 转子rpm转rad/s
+
+// 电功率模型: P = k0*sum(I*w)/SCALE_IW + k1*sum(I^2)/SCALE_I2 + k2*sum(|w|)/SCALE_W + k3
+// 集成位置:
+// 1. SuperCapPowerEstTick 在底盘任务每ms更新电机反馈之后调用, 返回值作为功率限制的1kHz输入
+// 2. SuperCapPowerEstCorrect 在任务中对每个新的超电帧调用一次, 传入 inst->rx.chassisPower 与
+//    inst->sampleTick, 不放在CAN接收中断里 (RLS约百次浮点乘加)
+typedef struct
+{
+    fp32 k[SUPERCAP_EST_PARAM_NUM];                              // 模型系数, 对应归一化特征, 单位W
+    fp32 P[SUPERCAP_EST_PARAM_NUM][SUPERCAP_EST_PARAM_NUM];      // RLS协方差
+    fp32 feature[SUPERCAP_EST_HISTORY][SUPERCAP_EST_PARAM_NUM];  // 每ms归一化特征历史
+    uint32_t featureTick[SUPERCAP_EST_HISTORY];                  // 特征对应时刻 (ms)
+    uint16_t head;                                               // 最新特征下标
+    fp32 power;                                                  // 最新预测功率 (W)
+    fp32 residual;                                               // 最近一次校正残差 (实测 - 预测, W)
+    uint32_t corrections;                                        // 校正次数
+    uint32_t missedSamples;                                      // 测量时刻超出历史窗口的帧数
+    uint32_t traceClamps;                                        // 协方差迹被限幅的次数
+} SuperCap_PowerEst;
+
+/**
+ * @brief 初始化功率估计器
+ *
+ * @param est 估计器实例
+ */
+extern void SuperCapPowerEstInit(SuperCap_PowerEst *est);
+
+/**
+ * @brief 1kHz调用, 由底盘电机反馈预测电功率
+ *
+ * @param est 估计器实例
+ * @param tick 当前时刻 (ms)
+ * @return 预测底盘功率 (W)
+ */
+extern fp32 SuperCapPowerEstTick(SuperCap_PowerEst *est, uint32_t tick);
+
+/**
+ * @brief 收到超电帧后调用, 用测量时刻的特征在线校正模型
+ *
+ * @param est 估计器实例
+ * @param chassis_power 超电测得的底盘功率 (W)
+ * @param sample_tick 该功率的测量时刻 (机器人ms, 见 SuperCap_Instance.sampleTick)
+ */
+extern void SuperCapPowerEstCorrect(SuperCap_PowerEst *est, fp32 chassis_power, uint32_t sample_tick);
+
+#endif // !SUPERCAP_POWER_EST_H
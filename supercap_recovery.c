@@ -0,0 +1,188 @@
+/**
+ * @file supercap_recovery.c
+ * @brief 超级电容故障自动恢复: 重启退避、上线确认、能量逐步交还
+ * @note 只改写 tx 的 systemRestart/enableDCDC, 功率限制仍由上层决定.
+ *       恢复时间从故障出现算到能量完全交还底盘, 即实际损失电容的时间.
+ */
+
+#include "supercap_recovery.h"
+#include "supercap_event.h"
+
+/**
+ * @brief 切换状态
+ */
+static void recovery_enter(SuperCap_Recovery *rec, SuperCap_RecoveryState state, uint32_t tick)
+{
+    rec->state = state;
+    rec->stateTick = tick;
+}
+
+/**
+ * @brief 进入锁定, 关闭DCDC
+ */
+static void recovery_lockout(SuperCap_Recovery *rec, SuperCap_Instance *inst, uint32_t tick)
+{
+    SuperCapDisable(&inst->tx);
+    rec->energyScale = 0.0f;
+    rec->lockouts++;
+    recovery_enter(rec, SUPERCAP_RECOVERY_LOCKOUT, tick);
+    SuperCapEventLog(inst->index, SUPERCAP_EVENT_LOCKOUT, rec->attempts, rec->faultCode, 0, tick);
+}
+
+/**
+ * @brief 重启失败, 退避时间翻倍
+ */
+static void recovery_retry(SuperCap_Recovery *rec, SuperCap_Instance *inst, uint32_t tick)
+{
+    rec->attempts++;
+    if (rec->attempts >= SUPERCAP_RECOVERY_MAX_ATTEMPTS) {
+        recovery_lockout(rec, inst, tick);
+        return;
+    }
+
+    rec->backoff = rec->backoff * 2 > SUPERCAP_RECOVERY_BACKOFF_MAX ? SUPERCAP_RECOVERY_BACKOFF_MAX : rec->backoff * 2;
+    recovery_enter(rec, SUPERCAP_RECOVERY_BACKOFF, tick);
+}
+
+/**
+ * @brief 初始化故障恢复状态机
+ */
+void SuperCapRecoveryInit(SuperCap_Recovery *rec)
+{
+    rec->state = SUPERCAP_RECOVERY_NORMAL;
+    rec->attempts = 0;
+    rec->faultCode = 0;
+    rec->backoff = SUPERCAP_RECOVERY_BACKOFF_MIN;
+    rec->stateTick = 0;
+    rec->faultTick = 0;
+    rec->energyScale = 1.0f;
+    rec->restarts = 0;
+    rec->recoveries = 0;
+    rec->lockouts = 0;
+    rec->ttrSum = 0;
+    rec->ttrMax = 0;
+}
+
+/**
+ * @brief 故障恢复状态机
+ */
+void SuperCapRecoveryUpdate(SuperCap_Recovery *rec, SuperCap_Instance *inst, uint32_t tick)
+{
+    uint8_t error = SUPERCAP_GET_ERROR(inst->rx.errorCode);
+    uint8_t online = SuperCapInstanceOnline(inst);
+    uint32_t elapsed = tick - rec->stateTick;
+
+    if (rec->state == SUPERCAP_RECOVERY_LOCKOUT) {
+        // 每次重新禁用, 之前调用的待机控制器等改写的使能位不生效
+        SuperCapDisable(&inst->tx);
+        return;
+    }
+
+    // 不可恢复故障任何状态下直接锁定
+    if (online && (error & SUPERCAP_RECOVERY_FATAL_MASK)) {
+        if (rec->state == SUPERCAP_RECOVERY_NORMAL) {
+            rec->faultTick = tick;
+        }
+        rec->faultCode = inst->rx.errorCode;
+        recovery_lockout(rec, inst, tick);
+        return;
+    }
+
+    switch (rec->state) {
+    case SUPERCAP_RECOVERY_NORMAL:
+        if (online && (error & SUPERCAP_RECOVERY_RESTART_MASK)) {
+            rec->faultCode = inst->rx.errorCode;
+            rec->faultTick = tick;
+            rec->energyScale = 0.0f;
+            recovery_enter(rec, SUPERCAP_RECOVERY_BACKOFF, tick);
+        } else if (rec->attempts != 0 && elapsed > SUPERCAP_RECOVERY_STABLE_TIME) {
+            // 稳定运行一段时间, 之前的失败不再累计
+            rec->attempts = 0;
+            rec->backoff = SUPERCAP_RECOVERY_BACKOFF_MIN;
+        }
+        break;
+
+    case SUPERCAP_RECOVERY_BACKOFF:
+        if (elapsed >= rec->backoff) {
+            SuperCapSystemRestart(&inst->tx);
+            rec->restarts++;
+            recovery_enter(rec, SUPERCAP_RECOVERY_RESTARTING, tick);
+        }
+        break;
+
+    case SUPERCAP_RECOVERY_RESTARTING:
+        if (elapsed >= SUPERCAP_RECOVERY_PULSE_TIME) {
+            // 清除重启位并使能DCDC
+            SuperCapEnable(&inst->tx);
+            recovery_enter(rec, SUPERCAP_RECOVERY_VERIFY, tick);
+        }
+        break;
+
+    case SUPERCAP_RECOVERY_VERIFY:
+        // 必须是重启之后收到的帧
+        if (online && (int32_t)(inst->lastTick - rec->stateTick) > 0 &&
+            !(error & SUPERCAP_RECOVERY_RESTART_MASK) && !SUPERCAP_OUTPUT_DISABLED(inst->rx.errorCode)) {
+            recovery_enter(rec, SUPERCAP_RECOVERY_RAMP, tick);
+        } else if (elapsed > SUPERCAP_RECOVERY_VERIFY_TIME) {
+            recovery_retry(rec, inst, tick);
+        }
+        break;
+
+    case SUPERCAP_RECOVERY_RAMP:
+        if (online && (error & SUPERCAP_RECOVERY_RESTART_MASK)) {
+            // 交还过程中再次故障, 视为本次重启失败
+            rec->energyScale = 0.0f;
+            recovery_retry(rec, inst, tick);
+        } else if (elapsed >= SUPERCAP_RECOVERY_RAMP_TIME) {
+            uint32_t ttr = tick - rec->faultTick;
+            rec->energyScale = 1.0f;
+            rec->recoveries++;
+            rec->ttrSum += ttr;
+            if (ttr > rec->ttrMax) {
+                rec->ttrMax = ttr;
+            }
+            recovery_enter(rec, SUPERCAP_RECOVERY_NORMAL, tick);
+            // 本次故障的重启次数 = 之前失败的次数 + 成功的一次
+            SuperCapEventLog(inst->index, SUPERCAP_EVENT_RECOVERED, rec->attempts + 1, rec->faultCode,
+                             ttr > 0xFFFF ? 0xFFFF : (uint16_t)ttr, tick);
+        } else {
+            rec->energyScale = (fp32)elapsed / (fp32)SUPERCAP_RECOVERY_RAMP_TIME;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief 人工解除锁定
+ */
+void SuperCapRecoveryReset(SuperCap_Recovery *rec, uint32_t tick)
+{
+    rec->attempts = 0;
+    rec->backoff = SUPERCAP_RECOVERY_BACKOFF_MIN;
+    if (rec->state == SUPERCAP_RECOVERY_LOCKOUT) {
+        rec->faultTick = tick;
+        recovery_enter(rec, SUPERCAP_RECOVERY_BACKOFF, tick);
+    }
+}
+
+/**
+ * @brief 底盘可使用的电容能量比例
+ */
+fp32 SuperCapRecoveryEnergyScale(const SuperCap_Recovery *rec)
+{
+    return rec->energyScale;
+}
+
+/**
+ * @brief 获取平均恢复时间
+ */
+uint32_t SuperCapRecoveryMttr(const SuperCap_Recovery *rec)
+{
+    if (rec->recoveries == 0) {
+        return 0;
+    }
+    return rec->ttrSum / rec->recoveries;
+}
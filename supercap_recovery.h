@@ -0,0 +1,88 @@
+#ifndef SUPERCAP_RECOVERY_H
+#define SUPERCAP_RECOVERY_H
+#include "struct_typedef.h"
+#include "super_cap.h"
+
+// 故障分类: 可重启恢复 / 不可恢复, 其余错误位由超电板自行处理, 不干预
+#define SUPERCAP_RECOVERY_RESTART_MASK    (SUPERCAP_ERROR_BUCK_BOOST | SUPERCAP_ERROR_SHORT_CIRCUIT)
+#define SUPERCAP_RECOVERY_FATAL_MASK      (SUPERCAP_ERROR_CAPACITOR)
+
+#define SUPERCAP_RECOVERY_BACKOFF_MIN     100     // 首次重启前等待时间 (ms)
+#define SUPERCAP_RECOVERY_BACKOFF_MAX     3200    // 退避等待上限 (ms), 每次失败翻倍
+#define SUPERCAP_RECOVERY_MAX_ATTEMPTS    5       // 连续重启失败次数上限, 超过则锁定
+#define SUPERCAP_RECOVERY_PULSE_TIME      50      // 重启位保持时间 (ms), 覆盖多帧0x061
+#define SUPERCAP_RECOVERY_VERIFY_TIME     2000    // 重启后等待恢复的时间 (ms)
+#define SUPERCAP_RECOVERY_RAMP_TIME       1000    // 恢复后电容能量逐步交还底盘的时间 (ms)
+#define SUPERCAP_RECOVERY_STABLE_TIME     10000   // 正常运行超过该时间清零失败计数 (ms)
+
+typedef enum
+{
+    SUPERCAP_RECOVERY_NORMAL = 0,   // 正常
+    SUPERCAP_RECOVERY_BACKOFF,      // 故障, 等待退避时间
+    SUPERCAP_RECOVERY_RESTARTING,   // 正在发送重启位
+    SUPERCAP_RECOVERY_VERIFY,       // 等待超电板重新上线且故障清除
+    SUPERCAP_RECOVERY_RAMP,         // 已恢复, 逐步交还电容能量
+    SUPERCAP_RECOVERY_LOCKOUT,      // 不可恢复或重试耗尽, 等待人工复位
+} SuperCap_RecoveryState;
+
+// 故障恢复状态机
+typedef struct
+{
+    SuperCap_RecoveryState state;
+    uint8_t attempts;            // 连续重启失败次数
+    uint8_t faultCode;           // 触发恢复的 errorCode
+    uint16_t backoff;            // 当前退避等待时间 (ms)
+    uint32_t stateTick;          // 进入当前状态的时刻 (ms)
+    uint32_t faultTick;          // 故障发生时刻 (ms)
+    fp32 energyScale;            // 允许底盘使用电容能量的比例 (0-1)
+    uint32_t restarts;           // 重启次数
+    uint32_t recoveries;         // 成功恢复次数
+    uint32_t lockouts;           // 锁定次数
+    uint32_t ttrSum;             // 恢复时间累加 (ms), 故障到能量完全交还
+    uint32_t ttrMax;             // 最长恢复时间 (ms)
+} SuperCap_Recovery;
+
+/**
+ * @brief 初始化故障恢复状态机
+ *
+ * @param rec 状态机实例
+ */
+extern void SuperCapRecoveryInit(SuperCap_Recovery *rec);
+
+/**
+ * @brief 周期调用, 按接收状态改写发送命令
+ * @note 在超电发送任务每次发出0x061前调用, 且在 SuperCapStandbyUpdate 之后:
+ *       锁定时每次都重新禁用DCDC, 对使能位有最终决定权, 待机控制器无法把它重新打开.
+ *       每次恢复完成和锁定都经 SuperCapEventLog 记录 (故障码, 重启次数, 恢复时间).
+ *
+ * @param rec 状态机实例
+ * @param inst 超电实例, 读取 rx/在线状态, 写 tx 的重启与使能位
+ * @param tick 当前时刻 (ms)
+ */
+extern void SuperCapRecoveryUpdate(SuperCap_Recovery *rec, SuperCap_Instance *inst, uint32_t tick);
+
+/**
+ * @brief 人工解除锁定, 重新开始恢复流程
+ *
+ * @param rec 状态机实例
+ * @param tick 当前时刻 (ms)
+ */
+extern void SuperCapRecoveryReset(SuperCap_Recovery *rec, uint32_t tick);
+
+/**
+ * @brief 底盘功率限制器可使用的电容能量比例, 乘在电容放电功率上
+ *
+ * @param rec 状态机实例
+ * @return 0=不可使用电容, 1=完全可用
+ */
+extern fp32 SuperCapRecoveryEnergyScale(const SuperCap_Recovery *rec);
+
+/**
+ * @brief 获取平均恢复时间
+ *
+ * @param rec 状态机实例
+ * @return 平均恢复时间 (ms), 无恢复记录返回0
+ */
+extern uint32_t SuperCapRecoveryMttr(const SuperCap_Recovery *rec);
+
+#endif // !SUPERCAP_RECOVERY_H
@@ -0,0 +1,197 @@
+/**
+ * @file supercap_standby.c
+ * @brief 超级电容DCDC预测待机: 满电空闲时禁用DCDC, 按底盘指令趋势提前唤醒
+ * @note 待机省下的是 buck-boost 空载开关损耗. 唤醒提前量跟随实测唤醒延迟的最大值,
+ *       限制在 SUPERCAP_STANDBY_LEAD_MIN ~ SUPERCAP_STANDBY_LEAD_MAX, 预测失败时
+ *       底盘功率出现即唤醒, 最坏唤醒延迟即为实测的 wakeLatencyMax.
+ *       离线、状态未知或有错误码时不进入待机, 也不改写使能位, 交给故障恢复处理;
+ *       待机中出现错误则直接回到ACTIVE, 错误清除后再补上使能, 故障恢复锁定时
+ *       SuperCapRecoveryUpdate 在之后调用, 会重新禁用.
+ *       进入待机和每次唤醒完成经 SuperCapEventLog 记录唤醒延迟.
+ *       主机仿真: make -C tools/supercap_replay standby
+ */
+
+#include "supercap_standby.h"
+#include "supercap_event.h"
+
+/**
+ * @brief 切换状态
+ */
+static void standby_enter(SuperCap_Standby *sb, SuperCap_StandbyState state, uint32_t tick)
+{
+    sb->state = state;
+    sb->stateTick = tick;
+}
+
+/**
+ * @brief 使能DCDC, 进入唤醒等待
+ */
+static void standby_wake(SuperCap_Standby *sb, SuperCap_Instance *inst, uint32_t tick)
+{
+    // 只改使能位, 不清除故障恢复可能正在发送的重启位
+    inst->tx.enableDCDC = 1;
+    sb->dcdcOff = 0;
+    sb->wakes++;
+    sb->idle = 0;
+    standby_enter(sb, SUPERCAP_STANDBY_WAKING, tick);
+}
+
+/**
+ * @brief 初始化待机控制器
+ */
+void SuperCapStandbyInit(SuperCap_Standby *sb)
+{
+    sb->state = SUPERCAP_STANDBY_ACTIVE;
+    sb->stateTick = 0;
+    sb->idle = 0;
+    sb->dcdcOff = 0;
+    sb->idleTick = 0;
+    sb->lastTick = 0;
+    sb->lastCmd = 0.0f;
+    sb->cmdSlope = 0.0f;
+    sb->lead = SUPERCAP_STANDBY_LEAD_MIN;
+    sb->entries = 0;
+    sb->wakes = 0;
+    sb->lateWakes = 0;
+    sb->wakeTimeouts = 0;
+    sb->standbyMs = 0;
+    sb->savedEnergy = 0.0f;
+    sb->wakeLatencyMax = 0;
+    sb->wakeLatencySum = 0;
+}
+
+/**
+ * @brief 待机控制器
+ */
+void SuperCapStandbyUpdate(SuperCap_Standby *sb, SuperCap_Instance *inst, fp32 chassis_cmd, uint32_t tick)
+{
+    uint32_t dt = tick - sb->lastTick;
+    fp32 predicted;
+    uint8_t quiet;
+
+    // 指令变化率, 只取上升趋势外推 lead 后的指令
+    if (dt > 0) {
+        fp32 slope = (chassis_cmd - sb->lastCmd) / (fp32)dt;
+        sb->cmdSlope += SUPERCAP_STANDBY_SLOPE_ALPHA * (slope - sb->cmdSlope);
+    }
+    sb->lastCmd = chassis_cmd;
+    sb->lastTick = tick;
+    predicted = chassis_cmd;
+    if (sb->cmdSlope > 0.0f) {
+        predicted += sb->cmdSlope * (fp32)sb->lead;
+    }
+
+    if (!SuperCapInstanceOnline(inst) || !SuperCapInstanceStateKnown(inst) ||
+        SUPERCAP_GET_ERROR(inst->rx.errorCode) != 0) {
+        // 不改写使能位: 故障恢复可能刚刚禁用了DCDC
+        if (sb->state != SUPERCAP_STANDBY_ACTIVE) {
+            standby_enter(sb, SUPERCAP_STANDBY_ACTIVE, tick);
+        }
+        sb->idle = 0;
+        return;
+    }
+
+    // 待机中因错误退出, 错误清除后补上使能
+    if (sb->state == SUPERCAP_STANDBY_ACTIVE && sb->dcdcOff) {
+        inst->tx.enableDCDC = 1;
+        sb->dcdcOff = 0;
+    }
+
+    // NaN比较为假, 视为非空闲
+    quiet = inst->rx.chassisPower < SUPERCAP_STANDBY_IDLE_POWER && predicted < SUPERCAP_STANDBY_CMD_DEADBAND;
+
+    switch (sb->state) {
+    case SUPERCAP_STANDBY_ACTIVE:
+        if (quiet && inst->rx.capEnergy >= SUPERCAP_STANDBY_FULL_ENERGY) {
+            if (!sb->idle) {
+                sb->idle = 1;
+                sb->idleTick = tick;
+            } else if (tick - sb->idleTick >= SUPERCAP_STANDBY_IDLE_TIME) {
+                inst->tx.enableDCDC = 0;
+                sb->dcdcOff = 1;
+                sb->entries++;
+                standby_enter(sb, SUPERCAP_STANDBY_IDLE, tick);
+                SuperCapEventLog(inst->index, SUPERCAP_EVENT_STANDBY, 1, inst->rx.errorCode, 0, tick);
+            }
+        } else {
+            sb->idle = 0;
+        }
+        break;
+
+    case SUPERCAP_STANDBY_IDLE:
+        if (dt <= SUPERCAP_OFFLINE_TIME) {
+            sb->standbyMs += dt;
+            sb->savedEnergy += SUPERCAP_STANDBY_LOSS_POWER * (fp32)dt * 0.001f;
+        }
+        if (!(inst->rx.chassisPower < SUPERCAP_STANDBY_IDLE_POWER)) {
+            // 负载先于预测出现
+            sb->lateWakes++;
+            standby_wake(sb, inst, tick);
+        } else if (predicted >= SUPERCAP_STANDBY_CMD_DEADBAND || inst->rx.capEnergy < SUPERCAP_STANDBY_WAKE_ENERGY) {
+            standby_wake(sb, inst, tick);
+        }
+        break;
+
+    case SUPERCAP_STANDBY_WAKING:
+        // 必须是唤醒之后收到的帧
+        if ((int32_t)(inst->lastTick - sb->stateTick) > 0 && !SUPERCAP_OUTPUT_DISABLED(inst->rx.errorCode)) {
+            uint32_t latency = inst->lastTick - sb->stateTick;
+            sb->wakeLatencySum += latency;
+            if (latency > sb->wakeLatencyMax) {
+                sb->wakeLatencyMax = latency;
+            }
+            // 提前量覆盖实测最坏唤醒延迟
+            sb->lead = sb->wakeLatencyMax < SUPERCAP_STANDBY_LEAD_MIN ? SUPERCAP_STANDBY_LEAD_MIN :
+                       sb->wakeLatencyMax > SUPERCAP_STANDBY_LEAD_MAX ? SUPERCAP_STANDBY_LEAD_MAX :
+                       (uint16_t)sb->wakeLatencyMax;
+            standby_enter(sb, SUPERCAP_STANDBY_ACTIVE, tick);
+            SuperCapEventLog(inst->index, SUPERCAP_EVENT_STANDBY, 0, inst->rx.errorCode,
+                             latency > 0xFFFE ? 0xFFFE : (uint16_t)latency, tick);
+        } else if (tick - sb->stateTick > SUPERCAP_STANDBY_WAKE_TIMEOUT) {
+            sb->wakeTimeouts++;
+            if (sb->wakeLatencyMax < SUPERCAP_STANDBY_WAKE_TIMEOUT) {
+                sb->wakeLatencyMax = SUPERCAP_STANDBY_WAKE_TIMEOUT;
+            }
+            sb->lead = SUPERCAP_STANDBY_LEAD_MAX;
+            standby_enter(sb, SUPERCAP_STANDBY_ACTIVE, tick);
+            SuperCapEventLog(inst->index, SUPERCAP_EVENT_STANDBY, 0, inst->rx.errorCode, 0xFFFF, tick);
+        }
+        break;
+
+    default:
+        standby_enter(sb, SUPERCAP_STANDBY_ACTIVE, tick);
+        break;
+    }
+}
+
+/**
+ * @brief 立即唤醒
+ */
+void SuperCapStandbyWake(SuperCap_Standby *sb, SuperCap_Instance *inst, uint32_t tick)
+{
+    if (sb->state == SUPERCAP_STANDBY_IDLE) {
+        standby_wake(sb, inst, tick);
+    }
+}
+
+/**
+ * @brief 电容能量是否可用
+ */
+uint8_t SuperCapStandbyAvailable(const SuperCap_Standby *sb)
+{
+    return sb->state == SUPERCAP_STANDBY_ACTIVE;
+}
+
+/**
+ * @brief 平均唤醒延迟
+ */
+uint32_t SuperCapStandbyMeanWakeLatency(const SuperCap_Standby *sb)
+{
+    // 正在唤醒的一次还没有延迟记录
+    uint32_t done = sb->wakes - sb->wakeTimeouts - (sb->state == SUPERCAP_STANDBY_WAKING ? 1 : 0);
+
+    if (done == 0) {
+        return 0;
+    }
+    return sb->wakeLatencySum / done;
+}
@@ -0,0 +1,94 @@
+#ifndef SUPERCAP_STANDBY_H
+#define SUPERCAP_STANDBY_H
+#include "struct_typedef.h"
+#include "super_cap.h"
+
+// 进入待机条件: 电容满电且底盘空闲一段时间
+#define SUPERCAP_STANDBY_FULL_ENERGY      250     // capEnergy 不低于该值视为满电
+#define SUPERCAP_STANDBY_IDLE_POWER       8.0f    // chassisPower 低于该值视为空闲 (W)
+#define SUPERCAP_STANDBY_IDLE_TIME        2000    // 持续空闲该时间后进入待机 (ms)
+
+// 退出待机条件
+#define SUPERCAP_STANDBY_WAKE_ENERGY      235     // 待机中自放电到该值以下唤醒补电
+#define SUPERCAP_STANDBY_CMD_DEADBAND     0.05f   // 预测底盘指令超过该值唤醒 (与指令同单位)
+#define SUPERCAP_STANDBY_SLOPE_ALPHA      0.2f    // 指令变化率一阶滤波系数
+#define SUPERCAP_STANDBY_LEAD_MIN         50      // 唤醒提前量下限 (ms)
+#define SUPERCAP_STANDBY_LEAD_MAX         300     // 唤醒提前量上限 (ms), 即预测的最远距离
+#define SUPERCAP_STANDBY_WAKE_TIMEOUT     500     // 唤醒后超过该时间仍未回报使能, 不再等待 (ms)
+
+// 节能统计
+#define SUPERCAP_STANDBY_LOSS_POWER       4.0f    // DCDC空载开关损耗估计 (W), 待机节省的功率
+
+typedef enum
+{
+    SUPERCAP_STANDBY_ACTIVE = 0,    // DCDC使能
+    SUPERCAP_STANDBY_IDLE,          // 待机 (DCDC禁用)
+    SUPERCAP_STANDBY_WAKING,        // 已使能, 等待超电板回报输出使能
+} SuperCap_StandbyState;
+
+// 待机控制器
+typedef struct
+{
+    SuperCap_StandbyState state;
+    uint32_t stateTick;          // 进入当前状态的时刻 (ms)
+    uint8_t idle;                // 1=正在计空闲时间
+    uint8_t dcdcOff;             // 1=使能位由待机清除且尚未恢复
+    uint32_t idleTick;           // 连续空闲的开始时刻 (ms)
+    uint32_t lastTick;           // 上次调用时刻 (ms)
+    fp32 lastCmd;                // 上次底盘指令
+    fp32 cmdSlope;               // 滤波后的指令变化率 (每ms)
+    uint16_t lead;               // 当前唤醒提前量 (ms), 跟随实测唤醒延迟
+    uint32_t entries;            // 进入待机次数
+    uint32_t wakes;              // 唤醒次数 (含预测唤醒与迟到唤醒)
+    uint32_t lateWakes;          // 预测失败, 底盘已出现负载才唤醒的次数
+    uint32_t wakeTimeouts;       // 唤醒超时次数
+    uint32_t standbyMs;          // 累计待机时长 (ms)
+    fp32 savedEnergy;            // 累计节省能量估计 (J)
+    uint32_t wakeLatencyMax;     // 最大唤醒延迟 (ms), 使能到回报输出使能
+    uint32_t wakeLatencySum;     // 唤醒延迟累加 (ms)
+} SuperCap_Standby;
+
+/**
+ * @brief 初始化待机控制器
+ *
+ * @param sb 控制器实例
+ */
+extern void SuperCapStandbyInit(SuperCap_Standby *sb);
+
+/**
+ * @brief 周期调用 (在发送0x061前, SuperCapRecoveryUpdate 之前), 只改写 tx 的 enableDCDC
+ * @note 只读写传入的结构体, 不访问硬件, 可在主机上按日志回放
+ *
+ * @param sb 控制器实例
+ * @param inst 超电实例, 读取 rx/在线状态, 写 tx 的使能位
+ * @param chassis_cmd 底盘指令大小 (如速度设定值的模, >=0), 用于预测负载
+ * @param tick 当前时刻 (ms)
+ */
+extern void SuperCapStandbyUpdate(SuperCap_Standby *sb, SuperCap_Instance *inst, fp32 chassis_cmd, uint32_t tick);
+
+/**
+ * @brief 立即唤醒 (如复活倒计时结束前), 不计为迟到唤醒
+ *
+ * @param sb 控制器实例
+ * @param inst 超电实例
+ * @param tick 当前时刻 (ms)
+ */
+extern void SuperCapStandbyWake(SuperCap_Standby *sb, SuperCap_Instance *inst, uint32_t tick);
+
+/**
+ * @brief 电容能量是否可用, 待机或唤醒中底盘不应使用电容
+ *
+ * @param sb 控制器实例
+ * @return 1=可用, 0=不可用
+ */
+extern uint8_t SuperCapStandbyAvailable(const SuperCap_Standby *sb);
+
+/**
+ * @brief 获取平均唤醒延迟
+ *
+ * @param sb 控制器实例
+ * @return 平均唤醒延迟 (ms), 无记录返回0
+ */
+extern uint32_t SuperCapStandbyMeanWakeLatency(const SuperCap_Standby *sb);
+
+#endif // !SUPERCAP_STANDBY_H
@@ -0,0 +1,338 @@
+/**
+ * @file supercap_telemetry.c
+ * @brief 超级电容历史遥测环形缓冲与窗口统计
+ * @note 生产者为CAN接收中断, 查询在任务中进行. 均值与dE/dt由前缀和/首尾相减得到, 与窗口长度无关;
+ *       最小/最大值: 登记过的窗口 (SuperCapTelemetryRangeRegister) 由写入时维护的单调队列得到,
+ *       写入均摊O(1), 查询取队首O(1); 未登记的窗口按窗口扫描, M4上用 SSUB16/SEL 每次比较两帧.
+ *       查询读取的几项可能正被接收中断覆盖 (窗口等于缓冲长度时最旧一帧即下一帧写入位置),
+ *       均值、dE/dt和队首读取均短暂关中断; 扫描不关中断, 结果可能混入一帧新数据.
+ *       主机检查: make -C tools/supercap_replay telemetry
+ */
+
+#include "supercap_telemetry.h"
+#include "supercap_energy_table.h"
+#include "main.h"
+
+#if (SUPERCAP_TELEMETRY_SIZE & (SUPERCAP_TELEMETRY_SIZE - 1)) != 0 || SUPERCAP_TELEMETRY_SIZE > 256
+#error "SUPERCAP_TELEMETRY_SIZE must be a power of 2 not larger than 256"
+#endif
+
+#define TELEMETRY_MASK  (SUPERCAP_TELEMETRY_SIZE - 1)
+
+static SuperCap_Telemetry supercap_telemetry[SUPERCAP_MAX_INSTANCES];
+static uint16_t telemetry_range_window[SUPERCAP_TELEMETRY_RANGE_SLOTS];   // 0=未登记
+
+/**
+ * @brief 实际可用窗口长度
+ */
+static uint16_t telemetry_window(uint32_t count, uint16_t window)
+{
+    uint32_t available = count < SUPERCAP_TELEMETRY_SIZE ? count : SUPERCAP_TELEMETRY_SIZE;
+
+    if (window > available) {
+        window = (uint16_t)available;
+    }
+    return window;
+}
+
+/**
+ * @brief 单调队列追加一帧
+ * @param count 本帧之前已写入的帧数
+ * @param window 队列对应的窗口
+ * @param sign 1=最小值队列, -1=最大值队列
+ * @note 移出窗口的一帧若仍在队首先出队, 然后弹出队尾所有不优于新帧的元素.
+ *       每帧最多入队出队各一次, 均摊O(1)
+ */
+static void telemetry_queue_push(const SuperCap_Telemetry *tel, uint8_t *queue, uint16_t *head, uint16_t *tail,
+                                 uint32_t count, uint16_t window, int32_t sign)
+{
+    uint8_t pos = (uint8_t)(count & TELEMETRY_MASK);
+    int32_t value = sign * tel->powerDw[pos];
+
+    if (count >= window && *head != *tail && queue[*head & TELEMETRY_MASK] == (uint8_t)((count - window) & TELEMETRY_MASK)) {
+        (*head)++;
+    }
+    while (*head != *tail && sign * tel->powerDw[queue[(uint16_t)(*tail - 1) & TELEMETRY_MASK]] >= value) {
+        (*tail)--;
+    }
+    queue[*tail & TELEMETRY_MASK] = pos;
+    (*tail)++;
+}
+
+/**
+ * @brief 一个窗口的两个单调队列追加一帧
+ */
+static void telemetry_range_push(const SuperCap_Telemetry *tel, SuperCap_TelemetryRange *range, uint32_t count,
+                                 uint16_t window)
+{
+    telemetry_queue_push(tel, range->minQueue, &range->minHead, &range->minTail, count, window, 1);
+    telemetry_queue_push(tel, range->maxQueue, &range->maxHead, &range->maxTail, count, window, -1);
+}
+
+/**
+ * @brief 连续区段的最小/最大值
+ */
+static void telemetry_range_s16(const int16_t *p, uint16_t n, int16_t *min, int16_t *max)
+{
+    int16_t lo = *min;
+    int16_t hi = *max;
+
+#if defined(__ARM_FEATURE_SIMD32)
+    // 对齐到4字节后, 每个字含两帧, SSUB16置GE标志, SEL按半字选择
+    if (((uint32_t)(size_t)p & 0x02) && n > 0) {
+        if (*p < lo) lo = *p;
+        if (*p > hi) hi = *p;
+        p++;
+        n--;
+    }
+    if (n >= 2) {
+        const uint32_t *w = (const uint32_t *)p;
+        uint32_t vmin = (uint32_t)(uint16_t)lo | ((uint32_t)(uint16_t)lo << 16);
+        uint32_t vmax = (uint32_t)(uint16_t)hi | ((uint32_t)(uint16_t)hi << 16);
+        uint16_t pairs = n >> 1;
+
+        while (pairs--) {
+            uint32_t v = *w++;
+            __SSUB16(v, vmax);
+            vmax = __SEL(v, vmax);
+            __SSUB16(v, vmin);
+            vmin = __SEL(vmin, v);
+        }
+
+        lo = (int16_t)vmin < (int16_t)(vmin >> 16) ? (int16_t)vmin : (int16_t)(vmin >> 16);
+        hi = (int16_t)vmax > (int16_t)(vmax >> 16) ? (int16_t)vmax : (int16_t)(vmax >> 16);
+        p = (const int16_t *)w;
+        n &= 0x01;
+    }
+#endif
+
+    while (n--) {
+        if (*p < lo) lo = *p;
+        if (*p > hi) hi = *p;
+        p++;
+    }
+
+    *min = lo;
+    *max = hi;
+}
+
+/**
+ * @brief 追加一帧
+ */
+void SuperCapTelemetryPush(uint8_t board, const SuperCap_Msg_get *cap, uint32_t tick)
+{
+    SuperCap_Telemetry *tel;
+    uint32_t pos;
+    fp32 power_dw;
+    int16_t power;
+    uint8_t i;
+
+    if (board >= SUPERCAP_MAX_INSTANCES) {
+        return;
+    }
+
+    tel = &supercap_telemetry[board];
+    pos = tel->count & TELEMETRY_MASK;
+
+    power_dw = cap->chassisPower * 10.0f;
+    if (power_dw > 32767.0f) {
+        power = 32767;
+    } else if (power_dw < -32768.0f) {
+        power = -32768;
+    } else {
+        power = (int16_t)power_dw;
+    }
+
+    tel->powerDw[pos] = power;
+    tel->powerSum[pos] = (tel->count == 0 ? 0 : tel->powerSum[(tel->count - 1) & TELEMETRY_MASK]) + (uint32_t)(int32_t)power;
+    tel->tick[pos] = tick;
+    tel->energyDj[pos] = SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy);
+    tel->limit[pos] = cap->chassisPowerLimit > 0xFF ? 0xFF : (uint8_t)cap->chassisPowerLimit;
+    tel->flags[pos] = cap->errorCode;
+    for (i = 0; i < SUPERCAP_TELEMETRY_RANGE_SLOTS; i++) {
+        if (telemetry_range_window[i] != 0) {
+            telemetry_range_push(tel, &tel->range[i], tel->count, telemetry_range_window[i]);
+        }
+    }
+
+    // 先写数据再发布计数
+    __DMB();
+    tel->count++;
+}
+
+/**
+ * @brief 登记最小/最大值窗口
+ */
+int8_t SuperCapTelemetryRangeRegister(uint16_t window)
+{
+    uint32_t primask;
+    int8_t slot = -1;
+    uint8_t board;
+    uint8_t i;
+
+    if (window == 0 || window > SUPERCAP_TELEMETRY_SIZE) {
+        return -1;
+    }
+
+    for (i = 0; i < SUPERCAP_TELEMETRY_RANGE_SLOTS; i++) {
+        if (telemetry_range_window[i] == window) {
+            return 0;
+        }
+        if (telemetry_range_window[i] == 0 && slot < 0) {
+            slot = (int8_t)i;
+        }
+    }
+    if (slot < 0) {
+        return -1;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    // 用缓冲中最近window帧重建队列, 与逐帧写入的结果相同
+    for (board = 0; board < SUPERCAP_MAX_INSTANCES; board++) {
+        SuperCap_Telemetry *tel = &supercap_telemetry[board];
+        SuperCap_TelemetryRange *range = &tel->range[slot];
+        uint32_t count = tel->count;
+        uint32_t n = telemetry_window(count, window);
+
+        range->minHead = range->minTail = 0;
+        range->maxHead = range->maxTail = 0;
+        for (; n > 0; n--) {
+            telemetry_range_push(tel, range, count - n, window);
+        }
+    }
+    telemetry_range_window[slot] = window;
+
+    __set_PRIMASK(primask);
+    return 0;
+}
+
+/**
+ * @brief 获取某块板的历史遥测
+ */
+const SuperCap_Telemetry *SuperCapTelemetryGet(uint8_t board)
+{
+    if (board >= SUPERCAP_MAX_INSTANCES) {
+        return NULL;
+    }
+    return &supercap_telemetry[board];
+}
+
+/**
+ * @brief 平均底盘功率
+ */
+fp32 SuperCapTelemetryAvgPower(const SuperCap_Telemetry *tel, uint16_t window)
+{
+    uint32_t primask;
+    uint32_t count;
+    uint32_t oldest;
+    int32_t sum;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    count = tel->count;
+    window = telemetry_window(count, window);
+    if (window == 0) {
+        __set_PRIMASK(primask);
+        return 0.0f;
+    }
+
+    // 最旧一帧之前的前缀和 = 最旧一帧的前缀和 - 最旧一帧, 窗口可取满整个缓冲
+    oldest = (count - window) & TELEMETRY_MASK;
+    sum = (int32_t)(tel->powerSum[(count - 1) & TELEMETRY_MASK] - tel->powerSum[oldest] +
+                    (uint32_t)(int32_t)tel->powerDw[oldest]);
+
+    __set_PRIMASK(primask);
+    return (fp32)sum * 0.1f / (fp32)window;
+}
+
+/**
+ * @brief 可用能量变化率
+ */
+fp32 SuperCapTelemetryEnergyRate(const SuperCap_Telemetry *tel, uint16_t window)
+{
+    uint32_t primask;
+    uint32_t count;
+    uint32_t newest;
+    uint32_t oldest;
+    uint32_t dt;
+    int32_t de;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    count = tel->count;
+    window = telemetry_window(count, window);
+    if (window < 2) {
+        __set_PRIMASK(primask);
+        return 0.0f;
+    }
+
+    newest = (count - 1) & TELEMETRY_MASK;
+    oldest = (count - window) & TELEMETRY_MASK;
+    dt = tel->tick[newest] - tel->tick[oldest];
+    de = (int32_t)tel->energyDj[newest] - (int32_t)tel->energyDj[oldest];
+
+    __set_PRIMASK(primask);
+    if (dt == 0) {
+        return 0.0f;
+    }
+
+    // 0.1J / ms * 100 = W
+    return (fp32)de * 100.0f / (fp32)dt;
+}
+
+/**
+ * @brief 底盘功率最小/最大值
+ */
+uint8_t SuperCapTelemetryPowerRange(const SuperCap_Telemetry *tel, uint16_t window, fp32 *min, fp32 *max)
+{
+    uint32_t count = tel->count;
+    uint32_t start;
+    uint16_t first;
+    int16_t lo = 32767;
+    int16_t hi = -32768;
+    uint8_t i;
+
+    if (window > SUPERCAP_TELEMETRY_SIZE) {
+        window = SUPERCAP_TELEMETRY_SIZE;
+    }
+
+    for (i = 0; i < SUPERCAP_TELEMETRY_RANGE_SLOTS; i++) {
+        if (telemetry_range_window[i] == window && window != 0) {
+            const SuperCap_TelemetryRange *range = &tel->range[i];
+            uint32_t primask = __get_PRIMASK();
+
+            // 帧数不足窗口时队列中就是全部已有帧
+            __disable_irq();
+            if (tel->count == 0) {
+                __set_PRIMASK(primask);
+                return 0;
+            }
+            lo = tel->powerDw[range->minQueue[range->minHead & TELEMETRY_MASK]];
+            hi = tel->powerDw[range->maxQueue[range->maxHead & TELEMETRY_MASK]];
+            __set_PRIMASK(primask);
+
+            *min = (fp32)lo * 0.1f;
+            *max = (fp32)hi * 0.1f;
+            return 1;
+        }
+    }
+
+    window = telemetry_window(count, window);
+    if (window == 0) {
+        return 0;
+    }
+
+    // 窗口跨越环形缓冲末尾时分两段
+    start = (count - window) & TELEMETRY_MASK;
+    first = SUPERCAP_TELEMETRY_SIZE - start < window ? (uint16_t)(SUPERCAP_TELEMETRY_SIZE - start) : window;
+    telemetry_range_s16(&tel->powerDw[start], first, &lo, &hi);
+    telemetry_range_s16(&tel->powerDw[0], window - first, &lo, &hi);
+
+    *min = (fp32)lo * 0.1f;
+    *max = (fp32)hi * 0.1f;
+    return 1;
+}
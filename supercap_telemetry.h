@@ -0,0 +1,89 @@
+#ifndef SUPERCAP_TELEMETRY_H
+#define SUPERCAP_TELEMETRY_H
+#include "struct_typedef.h"
+#include "super_cap.h"
+
+#define SUPERCAP_TELEMETRY_SIZE           128   // 每块板历史帧数, 必须为2的幂且不超过256
+#define SUPERCAP_TELEMETRY_RANGE_SLOTS    4     // 可登记的最小/最大值窗口数
+
+// 最小/最大值窗口: 每个登记的窗口一对单调队列, 写入时维护, 查询取队首
+typedef struct
+{
+    uint8_t minQueue[SUPERCAP_TELEMETRY_SIZE];   // 帧下标, 对应功率严格递增, 队首为窗口最小值
+    uint8_t maxQueue[SUPERCAP_TELEMETRY_SIZE];   // 帧下标, 对应功率严格递减, 队首为窗口最大值
+    uint16_t minHead, minTail;   // 队列读写计数, 下标为 & (SIZE-1)
+    uint16_t maxHead, maxTail;
+} SuperCap_TelemetryRange;
+
+// 历史遥测, 按字段分数组存放 (SoA), 每个数组8字节对齐, 读取不再经过packed结构的非对齐float
+typedef struct
+{
+    int16_t powerDw[SUPERCAP_TELEMETRY_SIZE] __attribute__((aligned(8)));    // chassisPower (0.1W), 限幅到int16
+    uint32_t powerSum[SUPERCAP_TELEMETRY_SIZE] __attribute__((aligned(8)));  // powerDw 前缀和 (允许回绕), 均值O(1)
+    uint32_t tick[SUPERCAP_TELEMETRY_SIZE] __attribute__((aligned(8)));      // 测量时刻 (ms)
+    uint16_t energyDj[SUPERCAP_TELEMETRY_SIZE] __attribute__((aligned(8)));  // 可用能量 (0.1J, 查表)
+    uint8_t limit[SUPERCAP_TELEMETRY_SIZE] __attribute__((aligned(8)));      // chassisPowerLimit (W)
+    uint8_t flags[SUPERCAP_TELEMETRY_SIZE] __attribute__((aligned(8)));      // errorCode
+    SuperCap_TelemetryRange range[SUPERCAP_TELEMETRY_RANGE_SLOTS];          // 与 SuperCapTelemetryRangeRegister 的序号对应
+    uint32_t count;              // 累计写入帧数, 最新帧下标为 (count-1) & (SIZE-1)
+} SuperCap_Telemetry;
+
+/**
+ * @brief 追加一帧 (在解码路径中调用)
+ *
+ * @param board 超电板序号
+ * @param cap 本帧接收数据
+ * @param tick 本帧测量时刻 (ms)
+ */
+extern void SuperCapTelemetryPush(uint8_t board, const SuperCap_Msg_get *cap, uint32_t tick);
+
+/**
+ * @brief 登记一个最小/最大值窗口, 之后该窗口的 SuperCapTelemetryPowerRange 为O(1)
+ * @note 所有板共用, 在使用者初始化时调用; 登记时用已有历史重建队列, 期间关中断.
+ *       每个登记的窗口使接收中断中每帧多维护一对单调队列 (均摊O(1)).
+ *
+ * @param window 帧数, 1 ~ SUPERCAP_TELEMETRY_SIZE
+ * @return 0=成功 (已登记的窗口也返回0), -1=窗口越界或已满
+ */
+extern int8_t SuperCapTelemetryRangeRegister(uint16_t window);
+
+/**
+ * @brief 获取某块板的历史遥测
+ *
+ * @param board 超电板序号
+ * @return 历史数据指针, 序号越界返回NULL
+ */
+extern const SuperCap_Telemetry *SuperCapTelemetryGet(uint8_t board);
+
+/**
+ * @brief 最近window帧的平均底盘功率, O(1)
+ *
+ * @param tel 历史数据
+ * @param window 帧数, 超过已有帧数时按已有帧数计算
+ * @return 平均功率 (W), 无数据返回0
+ */
+extern fp32 SuperCapTelemetryAvgPower(const SuperCap_Telemetry *tel, uint16_t window);
+
+/**
+ * @brief 最近window帧的可用能量变化率 dE/dt, O(1)
+ *
+ * @param tel 历史数据
+ * @param window 帧数, 超过已有帧数时按已有帧数计算
+ * @return 能量变化率 (W), >0为充电, 数据不足返回0
+ */
+extern fp32 SuperCapTelemetryEnergyRate(const SuperCap_Telemetry *tel, uint16_t window);
+
+/**
+ * @brief 最近window帧底盘功率的最小/最大值
+ * @note 已登记的窗口取单调队列队首, O(1), 期间短暂关中断;
+ *       其他窗口按窗口扫描, O(window), 有 __ARM_FEATURE_SIMD32 时用 SSUB16/SEL 每次处理两帧
+ *
+ * @param tel 历史数据
+ * @param window 帧数, 超过已有帧数时按已有帧数计算
+ * @param min 最小功率输出 (W)
+ * @param max 最大功率输出 (W)
+ * @return 1=成功, 0=无数据
+ */
+extern uint8_t SuperCapTelemetryPowerRange(const SuperCap_Telemetry *tel, uint16_t window, fp32 *min, fp32 *max);
+
+#endif // !SUPERCAP_TELEMETRY_H
@@ -0,0 +1,110 @@
+/**
+ * @file supercap_timesync.c
+ * @brief 超级电容板与机器人时钟同步 (NTP式四时间戳)
+ * @note 偏差 = ((t2 - t1) + (t3 - t4)) / 2, 往返 = (t4 - t1) - (t3 - t2).
+ *       板端时间戳只有16位, 偏差按模65536保存, 换算时以当前机器人时刻展开.
+ */
+
+#include "supercap_timesync.h"
+
+/**
+ * @brief 16位模运算差值, 映射到 (-32768, 32768]
+ */
+static fp32 sync_wrap16(fp32 value)
+{
+    while (value > 32768.0f) {
+        value -= 65536.0f;
+    }
+    while (value <= -32768.0f) {
+        value += 65536.0f;
+    }
+    return value;
+}
+
+/**
+ * @brief 写入对时请求
+ */
+void SuperCapTimeSyncPing(SuperCap_TimeSync *sync, uint8_t resv1[3], uint32_t now)
+{
+    if (sync->pingTick != 0 && now - sync->pingTick < SUPERCAP_SYNC_PERIOD) {
+        return;
+    }
+
+    sync->pingSeq++;
+    sync->pingTick = now;
+    resv1[0] = sync->pingSeq;
+    resv1[1] = (uint8_t)(now & 0xFF);
+    resv1[2] = (uint8_t)((now >> 8) & 0xFF);
+}
+
+/**
+ * @brief 处理对时应答
+ */
+void SuperCapTimeSyncResponse(SuperCap_TimeSync *sync, const uint8_t *data, uint32_t now)
+{
+    uint16_t t1 = (uint16_t)data[1] | ((uint16_t)data[2] << 8);
+    uint16_t t2 = (uint16_t)data[3] | ((uint16_t)data[4] << 8);
+    uint16_t t3 = (uint16_t)data[5] | ((uint16_t)data[6] << 8);
+    uint16_t up;
+    uint16_t down;
+    uint32_t rtt;
+    fp32 sample;
+
+    // 只接受最近一次请求的应答
+    if (data[0] != sync->pingSeq || t1 != (uint16_t)sync->pingTick) {
+        sync->rejected++;
+        return;
+    }
+
+    rtt = (now - sync->pingTick) - (uint16_t)(t3 - t2);
+    if (rtt > SUPERCAP_SYNC_MAX_RTT) {
+        sync->rejected++;
+        return;
+    }
+
+    // up = offset + 上行延迟, down = offset - 下行延迟
+    up = (uint16_t)(t2 - t1);
+    down = (uint16_t)(t3 - (uint16_t)now);
+    sample = (fp32)down + 0.5f * (fp32)(int16_t)(up - down);
+
+    if (!sync->synced) {
+        sync->offset = sample;
+        sync->drift = 0.0f;
+        sync->synced = 1;
+    } else {
+        fp32 dt = (fp32)(now - sync->refTick);
+        fp32 predicted = sync->offset + sync->drift * dt;
+        fp32 error = sync_wrap16(sample - predicted);
+
+        sync->offset = predicted + SUPERCAP_SYNC_OFFSET_GAIN * error;
+        if (dt > 0.0f) {
+            sync->drift += SUPERCAP_SYNC_DRIFT_GAIN * error / dt;
+        }
+    }
+
+    sync->offset = sync_wrap16(sync->offset);
+    if (sync->offset < 0.0f) {
+        sync->offset += 65536.0f;
+    }
+    sync->refTick = now;
+    sync->rtt = (uint16_t)rtt;
+    sync->samples++;
+}
+
+/**
+ * @brief 板端时间戳换算为机器人时刻
+ */
+uint32_t SuperCapTimeSyncToRobot(const SuperCap_TimeSync *sync, uint16_t board_tick, uint32_t now)
+{
+    fp32 offset = sync->offset + sync->drift * (fp32)(now - sync->refTick);
+    int32_t offset_ms = (int32_t)(offset + (offset >= 0.0f ? 0.5f : -0.5f));
+    uint16_t robot16 = (uint16_t)(board_tick - (uint16_t)offset_ms);
+    uint16_t back = (uint16_t)((uint16_t)now - robot16);
+
+    // 测量时刻一定早于当前时刻, 按16位差值回推; 漂移误差使换算结果略晚于
+    // 当前时刻时差值回绕到接近65536, 此时钳到当前时刻而不是回推一分多钟
+    if (back >= 0x8000) {
+        return now;
+    }
+    return now - back;
+}
@@ -0,0 +1,62 @@
+#ifndef SUPERCAP_TIMESYNC_H
+#define SUPERCAP_TIMESYNC_H
+#include "struct_typedef.h"
+
+#define SUPERCAP_SYNC_PERIOD          100     // 对时请求周期 (ms)
+#define SUPERCAP_SYNC_MAX_RTT         6       // 往返时间超过该值的样本丢弃 (ms)
+#define SUPERCAP_SYNC_OFFSET_GAIN     0.3f    // 偏差修正系数
+#define SUPERCAP_SYNC_DRIFT_GAIN      0.1f    // 漂移修正系数
+
+// 对时请求 (写入0x061的resv1):
+//       resv1[0]: pingSeq
+//       resv1[1-2]: t1, 机器人发送时刻低16位 (ms, 小端)
+// 对时应答 (CAN ID: 0x055+n), 8字节:
+//       Byte 0: pingSeq (回显)
+//       Byte 1-2: t1 (回显)
+//       Byte 3-4: t2, 板端收到请求时刻 (ms, 小端)
+//       Byte 5-6: t3, 板端发送应答时刻 (ms, 小端)
+//       Byte 7: 保留
+
+// 板端时钟估计, 板端时间 = 机器人时间 + offset + drift * (t - refTick)
+typedef struct
+{
+    fp32 offset;                 // 板端减机器人时钟偏差 (ms, 模65536)
+    fp32 drift;                  // 时钟漂移 (ms/ms)
+    uint32_t refTick;            // offset 对应的机器人时刻 (ms)
+    uint32_t pingTick;           // 最近一次请求的机器人发送时刻 (ms)
+    uint16_t rtt;                // 最近一次有效样本的往返时间 (ms)
+    uint8_t pingSeq;             // 最近一次请求序号
+    uint8_t synced;              // 1=已完成对时
+    uint32_t samples;            // 有效样本数
+    uint32_t rejected;           // 往返过长或序号不符被丢弃的样本数
+} SuperCap_TimeSync;
+
+/**
+ * @brief 到周期时在发送命令中写入对时请求, 在发送0x061前调用
+ *
+ * @param sync 对时状态
+ * @param resv1 发送帧的3字节保留位
+ * @param now 当前机器人时刻 (ms)
+ */
+extern void SuperCapTimeSyncPing(SuperCap_TimeSync *sync, uint8_t resv1[3], uint32_t now);
+
+/**
+ * @brief 处理对时应答, 更新偏差和漂移估计
+ *
+ * @param sync 对时状态
+ * @param data CAN接收的原始数据 (8字节)
+ * @param now 收到应答的机器人时刻 (ms)
+ */
+extern void SuperCapTimeSyncResponse(SuperCap_TimeSync *sync, const uint8_t *data, uint32_t now);
+
+/**
+ * @brief 板端时间戳换算为机器人时刻
+ *
+ * @param sync 对时状态
+ * @param board_tick 板端时间戳 (ms, 16位)
+ * @param now 当前机器人时刻 (ms), 用于扩展到32位
+ * @return 机器人时刻 (ms)
+ */
+extern uint32_t SuperCapTimeSyncToRobot(const SuperCap_TimeSync *sync, uint16_t board_tick, uint32_t now);
+
+#endif // !SUPERCAP_TIMESYNC_H
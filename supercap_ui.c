@@ -0,0 +1,357 @@
+/**
+ * @file supercap_ui.c
+ * @brief 超级电容裁判系统客户端UI组件
+ * @note 能量、故障和可加速状态量化为各图形的显示状态, 只有与客户端已显示的状态不同的图形才发送.
+ *       一包放入所有待发图形, 按数量选用1/2/5/7图形命令, 空位填空操作.
+ *       发送受字节预算 (令牌桶) 和最短间隔限制, 预算不足时变化保留到下次,
+ *       期间又变回原状态则不再发送.
+ *       多块板的组件共用一个发送器 (DMA缓冲、预算和最短间隔), 最短间隔内DMA已发完上一包,
+ *       不会重新启动DMA中断正在发送的包; 多块板同时有变化时上一包的板让给其他板.
+ */
+
+#include "supercap_ui.h"
+#include "referee.h"
+#include "CRC8_CRC16.h"
+#include "bsp_usart.h"
+#include <string.h>
+
+#define UI_SOF                  0xA5
+#define UI_CMD_INTERACT         0x0301      // 机器人交互数据
+#define UI_HEADER_LEN           5           // SOF + 长度 + 序号 + CRC8
+#define UI_CMD_LEN              2
+#define UI_TAIL_LEN             2           // CRC16
+#define UI_INTERACT_HEAD_LEN    6           // 内容ID + 发送者ID + 接收者ID
+#define UI_GRAPHIC_LEN          15
+#define UI_GRAPHIC_MAX          7
+#define UI_PACKET_LEN(n)        (UI_HEADER_LEN + UI_CMD_LEN + UI_INTERACT_HEAD_LEN + (n) * UI_GRAPHIC_LEN + UI_TAIL_LEN)
+#define UI_CLIENT_ID_BASE       0x0100      // 客户端ID = 0x0100 + 机器人ID
+
+// 图形操作与类型, 颜色
+#define UI_OP_NONE              0
+#define UI_OP_ADD               1
+#define UI_OP_MODIFY            2
+#define UI_TYPE_LINE            0
+#define UI_TYPE_RECT            1
+#define UI_TYPE_CIRCLE          2
+#define UI_COLOR_YELLOW         1
+#define UI_COLOR_GREEN          2
+#define UI_COLOR_ORANGE         3
+#define UI_COLOR_PURPLE         4
+#define UI_COLOR_WHITE          8
+
+typedef struct
+{
+    uint8_t graphic_name[3];
+    uint32_t operate_type : 3;
+    uint32_t graphic_type : 3;
+    uint32_t layer : 4;
+    uint32_t color : 4;
+    uint32_t start_angle : 9;
+    uint32_t end_angle : 9;
+    uint32_t width : 10;
+    uint32_t start_x : 11;
+    uint32_t start_y : 11;
+    uint32_t radius : 10;
+    uint32_t end_x : 11;
+    uint32_t end_y : 11;
+} __attribute__((packed)) ui_graphic_t;
+
+typedef char ui_graphic_size_check[(sizeof(ui_graphic_t) == UI_GRAPHIC_LEN) ? 1 : -1];
+typedef char ui_tx_buf_size_check[(SUPERCAP_UI_TX_BUF_LEN == UI_PACKET_LEN(UI_GRAPHIC_MAX)) ? 1 : -1];
+// 一包 (每字节10位) 在最短间隔内发完
+typedef char ui_tx_time_check[(SUPERCAP_UI_TX_BUF_LEN * 10 * 1000 / SUPERCAP_UI_BAUD < SUPERCAP_UI_MIN_INTERVAL) ? 1 : -1];
+typedef char ui_board_num_check[(SUPERCAP_MAX_INSTANCES <= 8) ? 1 : -1];
+
+// 一包图形数 -> 内容ID
+static const uint8_t ui_batch_size[] = {1, 2, 5, 7};
+static const uint16_t ui_batch_cmd[] = {0x0101, 0x0102, 0x0103, 0x0104};
+
+static SuperCap_UiSender ui_sender;
+
+/**
+ * @brief 能量格, 跨过格边界 SUPERCAP_UI_LEVEL_HYST 以上才换格, 大跳变时先停在相邻格
+ * @note 满格和空格只在 capEnergy 为255/很小时出现, 不加滞回, 否则永远到不了
+ */
+static uint8_t ui_energy_level(uint8_t level, uint8_t capEnergy)
+{
+    uint8_t raw = (uint16_t)capEnergy * SUPERCAP_UI_LEVELS / 255;
+    uint16_t edge;
+
+    if (raw == 0 || raw == SUPERCAP_UI_LEVELS) {
+        return raw;
+    }
+    if (raw > level) {
+        edge = (uint16_t)raw * 255 / SUPERCAP_UI_LEVELS;
+        return capEnergy >= edge + SUPERCAP_UI_LEVEL_HYST ? raw : raw - 1;
+    }
+    if (raw < level) {
+        edge = (uint16_t)level * 255 / SUPERCAP_UI_LEVELS;
+        return capEnergy + SUPERCAP_UI_LEVEL_HYST < edge ? raw : raw + 1;
+    }
+    return level;
+}
+
+/**
+ * @brief 按显示状态填写图形, 图形名为 'S' + 板号 + 图形号, 多块板互不覆盖
+ */
+static void ui_fill_graphic(ui_graphic_t *g, uint8_t board, SuperCap_UiElement element, uint8_t value, uint8_t op)
+{
+    static const uint8_t lamp_color[] = {UI_COLOR_GREEN, UI_COLOR_YELLOW, UI_COLOR_PURPLE, UI_COLOR_WHITE};
+    uint16_t bar_y = SUPERCAP_UI_BAR_Y + board * SUPERCAP_UI_BOARD_SPACING;
+
+    memset(g, 0, sizeof(ui_graphic_t));
+    g->graphic_name[0] = 'S';
+    g->graphic_name[1] = '0' + board;
+    g->graphic_name[2] = '0' + element;
+    g->operate_type = op;
+    g->layer = SUPERCAP_UI_LAYER;
+
+    switch (element) {
+    case SUPERCAP_UI_FRAME:
+        g->graphic_type = UI_TYPE_RECT;
+        g->color = UI_COLOR_WHITE;
+        g->width = 2;
+        g->start_x = SUPERCAP_UI_BAR_X - 4;
+        g->start_y = bar_y - SUPERCAP_UI_BAR_WIDTH / 2 - 4;
+        g->end_x = SUPERCAP_UI_BAR_X + SUPERCAP_UI_BAR_LENGTH + 4;
+        g->end_y = bar_y + SUPERCAP_UI_BAR_WIDTH / 2 + 4;
+        break;
+
+    case SUPERCAP_UI_BAR:
+        g->graphic_type = UI_TYPE_LINE;
+        g->color = value * 10 >= SUPERCAP_UI_LEVELS * 5 ? UI_COLOR_GREEN :
+                   value * 10 >= SUPERCAP_UI_LEVELS * 2 ? UI_COLOR_YELLOW : UI_COLOR_ORANGE;
+        g->width = SUPERCAP_UI_BAR_WIDTH;
+        g->start_x = SUPERCAP_UI_BAR_X;
+        g->start_y = bar_y;
+        g->end_x = SUPERCAP_UI_BAR_X + (uint32_t)value * SUPERCAP_UI_BAR_LENGTH / SUPERCAP_UI_LEVELS;
+        g->end_y = bar_y;
+        break;
+
+    case SUPERCAP_UI_LAMP:
+        g->graphic_type = UI_TYPE_CIRCLE;
+        g->color = lamp_color[value < sizeof(lamp_color) ? value : SUPERCAP_UI_STATE_OFFLINE];
+        g->width = SUPERCAP_UI_LAMP_RADIUS;
+        g->start_x = SUPERCAP_UI_STATE_X;
+        g->start_y = bar_y;
+        g->radius = SUPERCAP_UI_LAMP_RADIUS / 2;
+        break;
+
+    case SUPERCAP_UI_BOOST:
+        g->graphic_type = UI_TYPE_CIRCLE;
+        g->color = value ? UI_COLOR_GREEN : UI_COLOR_WHITE;
+        g->width = SUPERCAP_UI_LAMP_RADIUS;
+        g->start_x = SUPERCAP_UI_BOOST_X;
+        g->start_y = bar_y;
+        g->radius = SUPERCAP_UI_LAMP_RADIUS / 2;
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief 初始化UI组件
+ */
+void SuperCapUiInit(SuperCap_Ui *ui, uint32_t tick)
+{
+    SuperCap_UiSender *s = &ui_sender;
+
+    memset(ui, 0, sizeof(SuperCap_Ui));
+    memset(ui->shown, 0xFF, sizeof(ui->shown));
+    ui->addMask = (1 << SUPERCAP_UI_ELEMENT_NUM) - 1;
+    ui->refreshTick = tick;
+
+    // 组件重新初始化时不重置共用预算
+    if (!s->ready) {
+        s->ready = 1;
+        s->budgetTick = tick;
+        s->naiveTick = tick;
+        s->lastSendTick = tick - SUPERCAP_UI_MIN_INTERVAL;
+        s->budget = SUPERCAP_UI_BYTE_BURST;
+        s->naiveBudget = SUPERCAP_UI_BYTE_BURST;
+    }
+}
+
+/**
+ * @brief 周期更新, 有变化时发送一包
+ */
+uint16_t SuperCapUiUpdate(SuperCap_Ui *ui, const SuperCap_Instance *inst, uint8_t boost_ready, uint32_t tick)
+{
+    SuperCap_UiSender *s = &ui_sender;
+    uint8_t board_bit = (uint8_t)(1u << inst->index);
+    uint8_t mask = 0;
+    uint8_t count = 0;
+    uint8_t batch;
+    uint16_t len;
+    uint16_t robot_id;
+    uint8_t *p;
+    uint8_t i;
+
+    s->boards |= board_bit;
+
+    // 共用令牌桶, 同一时刻的第二个组件不再累计
+    s->budget += (fp32)(tick - s->budgetTick) * SUPERCAP_UI_BYTE_BUDGET * 0.001f;
+    if (s->budget > SUPERCAP_UI_BYTE_BURST) {
+        s->budget = SUPERCAP_UI_BYTE_BURST;
+    }
+    s->budgetTick = tick;
+
+    // 对比基准: 每 SUPERCAP_UI_NAIVE_PERIOD 为每块板重画全部图形, 使用同样的共用预算, 不够时跳过
+    while (tick - s->naiveTick >= SUPERCAP_UI_NAIVE_PERIOD) {
+        s->naiveTick += SUPERCAP_UI_NAIVE_PERIOD;
+        s->naiveBudget += SUPERCAP_UI_NAIVE_PERIOD * SUPERCAP_UI_BYTE_BUDGET * 0.001f;
+        if (s->naiveBudget > SUPERCAP_UI_BYTE_BURST) {
+            s->naiveBudget = SUPERCAP_UI_BYTE_BURST;
+        }
+        for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+            if ((s->boards & (1u << i)) && s->naiveBudget >= (fp32)UI_PACKET_LEN(5)) {
+                s->naiveBudget -= (fp32)UI_PACKET_LEN(5);
+                s->naiveBytes += UI_PACKET_LEN(5);
+            }
+        }
+    }
+
+    // 量化显示状态
+    ui->level = ui_energy_level(ui->level, inst->rx.capEnergy);
+    ui->target[SUPERCAP_UI_FRAME] = 0;
+    ui->target[SUPERCAP_UI_BAR] = ui->level;
+    if (!SuperCapInstanceOnline(inst) || !SuperCapInstanceStateKnown(inst)) {
+        ui->target[SUPERCAP_UI_LAMP] = SUPERCAP_UI_STATE_OFFLINE;
+    } else if (SUPERCAP_GET_ERROR(inst->rx.errorCode) != 0) {
+        ui->target[SUPERCAP_UI_LAMP] = SUPERCAP_UI_STATE_FAULT;
+    } else if (SUPERCAP_OUTPUT_DISABLED(inst->rx.errorCode)) {
+        ui->target[SUPERCAP_UI_LAMP] = SUPERCAP_UI_STATE_DISABLED;
+    } else {
+        ui->target[SUPERCAP_UI_LAMP] = SUPERCAP_UI_STATE_OK;
+    }
+    ui->target[SUPERCAP_UI_BOOST] = boost_ready && ui->target[SUPERCAP_UI_LAMP] == SUPERCAP_UI_STATE_OK &&
+                                    inst->rx.capEnergy >= SUPERCAP_UI_BOOST_ENERGY;
+
+    // 定期重新添加, 客户端重启后恢复
+    if (tick - ui->refreshTick >= SUPERCAP_UI_REFRESH_TIME) {
+        ui->refreshTick = tick;
+        ui->addMask = (1 << SUPERCAP_UI_ELEMENT_NUM) - 1;
+    }
+
+    for (i = 0; i < SUPERCAP_UI_ELEMENT_NUM; i++) {
+        if ((ui->addMask & (1 << i)) || ui->target[i] != ui->shown[i]) {
+            mask |= 1 << i;
+            count++;
+        }
+    }
+
+    if (mask == 0) {
+        // 变化未发出前又恢复, 不计延迟
+        ui->dirty = 0;
+        s->pending &= (uint8_t)~board_bit;
+        return 0;
+    }
+    if (!ui->dirty) {
+        ui->dirty = 1;
+        ui->dirtyTick = tick;
+    }
+    s->pending |= board_bit;
+
+    for (batch = 0; ui_batch_size[batch] < count; batch++) {
+    }
+    len = UI_PACKET_LEN(ui_batch_size[batch]);
+
+    // 共用最短间隔, 上一包的DMA发送已完成
+    if (tick - s->lastSendTick < SUPERCAP_UI_MIN_INTERVAL) {
+        return 0;
+    }
+    // 其他板也有变化时, 上一包的板让出, 避免先调用的组件一直占用
+    if ((s->pending & (uint8_t)~board_bit) && s->lastBoard == inst->index) {
+        ui->deferred++;
+        return 0;
+    }
+    if (s->budget < (fp32)len) {
+        ui->deferred++;
+        return 0;
+    }
+
+    // 帧头
+    p = s->txBuf;
+    p[0] = UI_SOF;
+    p[1] = (UI_INTERACT_HEAD_LEN + ui_batch_size[batch] * UI_GRAPHIC_LEN) & 0xFF;
+    p[2] = (UI_INTERACT_HEAD_LEN + ui_batch_size[batch] * UI_GRAPHIC_LEN) >> 8;
+    p[3] = s->seq++;
+    supercap_ui_append_crc8(p, UI_HEADER_LEN);
+    p += UI_HEADER_LEN;
+    p[0] = UI_CMD_INTERACT & 0xFF;
+    p[1] = UI_CMD_INTERACT >> 8;
+    p += UI_CMD_LEN;
+
+    // 交互数据头
+    robot_id = supercap_ui_get_robot_id();
+    p[0] = ui_batch_cmd[batch] & 0xFF;
+    p[1] = ui_batch_cmd[batch] >> 8;
+    p[2] = robot_id & 0xFF;
+    p[3] = robot_id >> 8;
+    p[4] = (UI_CLIENT_ID_BASE + robot_id) & 0xFF;
+    p[5] = (UI_CLIENT_ID_BASE + robot_id) >> 8;
+    p += UI_INTERACT_HEAD_LEN;
+
+    // 待发图形, 空位为空操作
+    for (i = 0; i < SUPERCAP_UI_ELEMENT_NUM; i++) {
+        if (mask & (1 << i)) {
+            ui_fill_graphic((ui_graphic_t *)p, inst->index, (SuperCap_UiElement)i, ui->target[i],
+                            (ui->addMask & (1 << i)) ? UI_OP_ADD : UI_OP_MODIFY);
+            ui->shown[i] = ui->target[i];
+            p += UI_GRAPHIC_LEN;
+        }
+    }
+    memset(p, 0, (ui_batch_size[batch] - count) * UI_GRAPHIC_LEN);
+    supercap_ui_append_crc16(s->txBuf, len);
+    supercap_ui_send(s->txBuf, len);
+
+    ui->addMask = 0;
+    ui->packets++;
+    ui->bytesSent += len;
+    s->budget -= (fp32)len;
+    s->lastSendTick = tick;
+    s->lastBoard = inst->index;
+    s->pending &= (uint8_t)~board_bit;
+    s->bytesSent += len;
+
+    {
+        uint32_t latency = tick - ui->dirtyTick;
+        ui->latencySum += latency;
+        ui->latencyCount++;
+        if (latency > ui->latencyMax) {
+            ui->latencyMax = latency;
+        }
+    }
+    ui->dirty = 0;
+
+    return len;
+}
+
+/**
+ * @brief 节省的字节数
+ */
+uint32_t SuperCapUiSavedBytes(void)
+{
+    return ui_sender.naiveBytes > ui_sender.bytesSent ? ui_sender.naiveBytes - ui_sender.bytesSent : 0;
+}
+
+/**
+ * @brief 获取共用发送器
+ */
+const SuperCap_UiSender *SuperCapUiSenderGet(void)
+{
+    return &ui_sender;
+}
+
+/**
+ * @brief 平均屏幕延迟
+ */
+uint32_t SuperCapUiMeanLatency(const SuperCap_Ui *ui)
+{
+    if (ui->latencyCount == 0) {
+        return 0;
+    }
+    return ui->latencySum / ui->latencyCount;
+}
@@ -0,0 +1,134 @@
+#ifndef SUPERCAP_UI_H
+#define SUPERCAP_UI_H
+#include "struct_typedef.h"
+#include "super_cap.h"
+
+// 裁判系统客户端接口 (移植时只需修改这里)
+#define supercap_ui_get_robot_id()              get_robot_id()
+#define supercap_ui_send(buf, len)              usart6_tx_dma_enable((buf), (len))
+#define supercap_ui_append_crc8(buf, len)       append_CRC8_check_sum((buf), (len))
+#define supercap_ui_append_crc16(buf, len)      append_CRC16_check_sum((buf), (len))
+
+// 显示量化
+#define SUPERCAP_UI_LEVELS                10      // 能量条格数
+#define SUPERCAP_UI_LEVEL_HYST            4       // 能量跨过格边界超过该值才换格 (capEnergy单位), 避免闪烁
+#define SUPERCAP_UI_BOOST_ENERGY          64      // capEnergy 低于该值不显示可加速
+
+// 带宽控制
+#define SUPERCAP_UI_BYTE_BUDGET           600     // 全部电容UI组件共用的串口字节预算 (字节/s), 与其他UI元素分享链路
+#define SUPERCAP_UI_BYTE_BURST            180     // 预算最多积攒的字节数
+#define SUPERCAP_UI_MIN_INTERVAL          100     // 两包之间最短间隔 (ms), 全部组件共用, 客户端UI刷新上限10Hz
+#define SUPERCAP_UI_BAUD                  115200  // 裁判系统串口波特率, 检查最短间隔内DMA能发完一包
+#define SUPERCAP_UI_REFRESH_TIME          5000    // 全部图形重新添加的周期 (ms), 客户端重启后恢复显示
+#define SUPERCAP_UI_NAIVE_PERIOD          100     // 对比基准: 每隔该时间重画全部图形 (ms), 同样受字节预算限制
+
+// 图形位置 (客户端 1920x1080 坐标)
+#define SUPERCAP_UI_LAYER                 5       // 图层
+#define SUPERCAP_UI_BAR_X                 760     // 能量条左端
+#define SUPERCAP_UI_BAR_Y                 160     // 能量条中线
+#define SUPERCAP_UI_BAR_LENGTH            400     // 能量条满长
+#define SUPERCAP_UI_BAR_WIDTH             20      // 能量条线宽
+#define SUPERCAP_UI_STATE_X               1200    // 状态灯圆心
+#define SUPERCAP_UI_BOOST_X               1250    // 加速灯圆心
+#define SUPERCAP_UI_LAMP_RADIUS           12      // 指示灯半径
+#define SUPERCAP_UI_BOARD_SPACING         40      // 多块超电板时每块的图形向上偏移
+
+#define SUPERCAP_UI_TX_BUF_LEN            120     // 一包最长字节数 (7图形)
+
+typedef enum
+{
+    SUPERCAP_UI_STATE_OK = 0,       // 正常
+    SUPERCAP_UI_STATE_DISABLED,     // 输出禁用 (待机/手动禁用)
+    SUPERCAP_UI_STATE_FAULT,        // 有错误码
+    SUPERCAP_UI_STATE_OFFLINE,      // 离线或状态未知
+} SuperCap_UiState;
+
+typedef enum
+{
+    SUPERCAP_UI_FRAME = 0,          // 能量条外框, 只在添加时发送
+    SUPERCAP_UI_BAR,                // 能量条
+    SUPERCAP_UI_LAMP,               // 状态灯
+    SUPERCAP_UI_BOOST,              // 加速灯
+    SUPERCAP_UI_ELEMENT_NUM,
+} SuperCap_UiElement;
+
+// 全部电容UI组件共用的发送器. usart6 DMA 重新启动会中断正在发送的包, 所以各组件不各自发送:
+// 共用一个DMA缓冲、一个令牌桶和最短间隔, 多块板同时有变化时轮流发送
+typedef struct
+{
+    uint8_t txBuf[SUPERCAP_UI_TX_BUF_LEN];      // DMA发送缓冲, 发送期间不能改动
+    uint8_t ready;               // 1=已初始化
+    uint8_t seq;                 // 帧序号
+    uint8_t boards;              // 有组件的板 (按位), 对比基准按此重画
+    uint8_t pending;             // 有未发送变化的板 (按位)
+    uint8_t lastBoard;           // 上一包的板号
+    uint32_t lastSendTick;       // 上一包发送时刻 (ms)
+    uint32_t budgetTick;         // 预算上次累计的时刻 (ms)
+    uint32_t naiveTick;          // 对比基准上次计数的时刻 (ms)
+    fp32 budget;                 // 可用字节
+    fp32 naiveBudget;            // 对比基准的可用字节
+    uint32_t bytesSent;          // 全部组件发送字节数
+    uint32_t naiveBytes;         // 对比基准 (预算内定时重画全部板的全部图形) 的字节数
+} SuperCap_UiSender;
+
+// 电容UI组件, 只在显示状态变化时发送, 每块超电板一个, 图形名含板号
+typedef struct
+{
+    uint8_t target[SUPERCAP_UI_ELEMENT_NUM];    // 要显示的状态
+    uint8_t shown[SUPERCAP_UI_ELEMENT_NUM];     // 客户端已显示的状态
+    uint8_t addMask;             // 需要添加 (而非修改) 的图形
+    uint8_t level;               // 当前能量格 (带滞回)
+    uint8_t dirty;               // 1=有未发送的变化
+    uint32_t dirtyTick;          // 开始有未发送变化的时刻 (ms)
+    uint32_t refreshTick;        // 上次全部添加的时刻 (ms)
+    uint32_t packets;            // 发送包数
+    uint32_t bytesSent;          // 发送字节数
+    uint32_t deferred;           // 因预算不足或等待其他板推迟的次数
+    uint32_t latencyMax;         // 状态变化到发出的最大延迟 (ms)
+    uint32_t latencySum;         // 延迟累加 (ms)
+    uint32_t latencyCount;       // 延迟样本数
+} SuperCap_Ui;
+
+/**
+ * @brief 初始化UI组件, 下次更新时添加全部图形. 第一个组件同时初始化共用发送器
+ *
+ * @param ui 组件实例
+ * @param tick 当前时刻 (ms)
+ */
+extern void SuperCapUiInit(SuperCap_Ui *ui, uint32_t tick);
+
+/**
+ * @brief 周期调用 (如UI任务中每10ms), 显示状态变化且共用发送器空闲、预算足够时发送一包.
+ *        各组件须在同一任务中调用
+ *
+ * @param ui 组件实例
+ * @param inst 超电实例, 每个组件固定对应一块板
+ * @param boost_ready 上层判断的可加速条件 (如故障恢复与待机都允许使用电容)
+ * @param tick 当前时刻 (ms)
+ * @return 本次发送的字节数, 0=未发送
+ */
+extern uint16_t SuperCapUiUpdate(SuperCap_Ui *ui, const SuperCap_Instance *inst, uint8_t boost_ready, uint32_t tick);
+
+/**
+ * @brief 全部组件相对预算内定时重画全部图形节省的字节数
+ *
+ * @return 节省字节数
+ */
+extern uint32_t SuperCapUiSavedBytes(void);
+
+/**
+ * @brief 获取共用发送器 (只读, 用于统计)
+ *
+ * @return 发送器
+ */
+extern const SuperCap_UiSender *SuperCapUiSenderGet(void);
+
+/**
+ * @brief 平均屏幕延迟 (显示状态变化到发出)
+ *
+ * @param ui 组件实例
+ * @return 平均延迟 (ms), 无样本返回0
+ */
+extern uint32_t SuperCapUiMeanLatency(const SuperCap_Ui *ui);
+
+#endif // !SUPERCAP_UI_H
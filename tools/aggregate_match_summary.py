@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+汇总超电比赛统计日志 (supercap_match.c 写入的flash扇区).
+
+读取方法: 用 ST-Link/J-Link 导出日志扇区, 例如
+  st-flash read match.bin 0x080C0000 0x20000
+可传入多个文件 (多台机器人或多次导出), 按 (机器人ID, 板序号, 比赛序号) 去重后汇总,
+同一台机器人多次导出的重叠记录只计一次. v1 记录没有机器人ID, 按 (文件, 板序号, 比赛序号) 去重.
+用法: python3 tools/aggregate_match_summary.py match.bin [more.bin ...]
+"""
+import struct
+import sys
+
+# 与 SuperCap_MatchSummary 布局一致 (小端), 后跟 name[3] + cali_flag
+# 版本号固定在第31字节, 固件升级版本时擦除日志扇区, 一个扇区内只有一种版本
+SUMMARY_FMT = {
+    1: '<7IhBB8H',
+    2: '<7IhBB8HB3x',
+}
+VERSION_OFFSET = 31
+CALIED_FLAG = 0x55
+ERROR_NAMES = ['欠压', '过压', 'BuckBoost', '短路', '高温', '无输入', '电容故障', '输出禁用']
+
+
+def parse(path):
+    data = open(path, 'rb').read()
+    records = []
+    if len(data) <= VERSION_OFFSET or data[VERSION_OFFSET] not in SUMMARY_FMT:
+        return records
+    version = data[VERSION_OFFSET]
+    fmt = SUMMARY_FMT[version]
+    summary_size = struct.calcsize(fmt)
+    slot_size = summary_size + 4
+    for off in range(0, len(data) - slot_size + 1, slot_size):
+        slot = data[off:off + slot_size]
+        if slot == b'\xff' * slot_size:
+            break
+        name, flag = slot[summary_size:summary_size + 2], slot[summary_size + 3]
+        if name != b'MT' or flag != CALIED_FLAG:
+            continue  # 写入中途掉电的槽位
+        f = struct.unpack(fmt, slot[:summary_size])
+        if f[9] != version:
+            continue
+        records.append({
+            'match': f[0], 'duration_ms': f[1], 'frames': f[2],
+            'charged_j': f[3] / 10.0, 'discharged_j': f[4] / 10.0,
+            'boost_ms': f[5], 'disabled_ms': f[6], 'peak_power_w': f[7] / 10.0,
+            'board': f[8], 'error_rise': list(f[10:18]),
+            'robot': f[18] if version >= 2 else None,
+        })
+    return records
+
+
+def main(paths):
+    if not paths:
+        sys.exit(__doc__)
+
+    seen = set()
+    records = []
+    for path in paths:
+        for r in parse(path):
+            robot = r['robot'] if r['robot'] is not None else path
+            key = (robot, r['board'], r['match'])
+            if key not in seen:
+                seen.add(key)
+                records.append(r)
+
+    print('%-5s %-6s %-5s %8s %10s %10s %8s %8s %8s' % (
+        'robot', 'match', 'board', 'time(s)', 'charge(J)', 'dischg(J)', 'boost(s)', 'off(s)', 'peak(W)'))
+    for r in sorted(records, key=lambda r: (r['robot'] if r['robot'] is not None else -1, r['match'], r['board'])):
+        print('%-5s %-6d %-5d %8.1f %10.1f %10.1f %8.1f %8.1f %8.1f' % (
+            r['robot'] if r['robot'] is not None else '-',
+            r['match'], r['board'], r['duration_ms'] / 1000.0, r['charged_j'], r['discharged_j'],
+            r['boost_ms'] / 1000.0, r['disabled_ms'] / 1000.0, r['peak_power_w']))
+
+    if not records:
+        return
+    total_time = sum(r['duration_ms'] for r in records) / 1000.0
+    print()
+    print('比赛记录数: %d, 总时长: %.1f s' % (len(records), total_time))
+    print('电容总吞吐: 充 %.1f J, 放 %.1f J' % (
+        sum(r['charged_j'] for r in records), sum(r['discharged_j'] for r in records)))
+    print('加速时长: %.1f s, 输出禁用时长: %.1f s, 最大功率: %.1f W' % (
+        sum(r['boost_ms'] for r in records) / 1000.0,
+        sum(r['disabled_ms'] for r in records) / 1000.0,
+        max(r['peak_power_w'] for r in records)))
+    for bit, name in enumerate(ERROR_NAMES):
+        count = sum(r['error_rise'][bit] for r in records)
+        if count:
+            print('  %-10s %d 次' % (name, count))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
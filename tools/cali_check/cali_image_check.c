@@ -0,0 +1,672 @@
+/**
+ * @file cali_image_check.c
+ * @brief 校准数据读取和结构升级的主机检查
+ * @note 直接编译固件的 calibrate_task.c, flash 用内存中的假映像代替 (擦除为0xFF, 写入只能把1改为0),
+ *       其余依赖 (INS, 云台, 超电效率表等) 用记录参数的替身. 每个用例按给定布局构造映像,
+ *       CRC 用本文件独立实现的CRC32计算, 然后运行 cali_param_init 检查设备数据和写回的映像:
+ *       - 空flash: 没有设备被标记为已校准, 不写flash
+ *       - 没有CRC的旧布局 (CRC字为擦除值): 数据载入, 陀螺仪从v1升级, 以带描述字的格式写回,
+ *         再读一次结果相同且不再写入
+ *       - 带描述字和CRC、陀螺仪为v1 (6字) 的布局: 陀螺仪升级为v2 (9字) 写回, cali_offset 取 offset
+ *       - 含本固件不认识的记录和更高版本的记录: 前者跳过, 后者不载入, 其余记录载入
+ *       - CRC错误 (新旧两种布局): 设备数据保持原值, 全部需要重新校准, 不写flash
+ *
+ *       用法: cali_image_check
+ */
+
+#include "main.h"
+#include "calibrate_task.h"
+#include "bsp_flash.h"
+#include "can_receive.h"
+#include "cmsis_os.h"
+#include "INS_task.h"
+#include "gimbal_task.h"
+#include "remote_control.h"
+#include "supercap_efficiency.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK_FLASH_SIZE      (CALI_CKPT_OFFSET + CALI_CKPT_SIZE)
+#define CHECK_SENTINEL        0xA5
+
+// calibrate_task.c 中的设备表, 头文件未声明
+extern cali_sensor_t cali_sensor[CALI_LIST_LENGHT];
+
+// 假flash
+static uint32_t check_flash[CHECK_FLASH_SIZE / 4];
+static uint32_t check_flash_erases;
+static uint32_t check_flash_writes;
+static uint32_t check_flash_errors;      // 越界访问或写入未擦除的位
+
+// 替身记录的调用
+static uint32_t check_gyro_set;
+static fp32 check_gyro_scale[3];
+static fp32 check_gyro_offset[3];
+static uint32_t check_gimbal_set;
+static uint16_t check_gimbal_yaw_offset;
+static uint8_t check_eff_loaded;         // 按位记录载入的板
+static uint16_t check_eff_first[SUPERCAP_MAX_INSTANCES];
+
+static uint32_t *check_flash_word(uint32_t address, uint32_t len)
+{
+    uint32_t offset = address - FLASH_USER_ADDR;
+
+    if (address < FLASH_USER_ADDR || offset % 4 != 0 || offset + len * 4 > CHECK_FLASH_SIZE) {
+        fprintf(stderr, "flash access 0x%08lx len %lu out of range\n", (unsigned long)address, (unsigned long)len);
+        check_flash_errors++;
+        return NULL;
+    }
+    return &check_flash[offset / 4];
+}
+
+// 擦除整个扇区, 包括检查点区
+void flash_erase_address(uint32_t address, uint16_t len)
+{
+    if (check_flash_word(address, 1) != NULL) {
+        memset(check_flash, 0xFF, sizeof(check_flash));
+        check_flash_erases++;
+    }
+}
+
+int8_t flash_write_single_address(uint32_t start_address, uint32_t *buf, uint32_t len)
+{
+    uint32_t *word = check_flash_word(start_address, len);
+    uint32_t i;
+
+    if (word == NULL) {
+        return -1;
+    }
+    for (i = 0; i < len; i++) {
+        if (~word[i] & buf[i]) {
+            fprintf(stderr, "flash 0x%08lx programmed without erase\n", (unsigned long)(start_address + i * 4));
+            check_flash_errors++;
+        }
+        word[i] &= buf[i];
+    }
+    check_flash_writes++;
+    return 0;
+}
+
+void flash_read(uint32_t address, uint32_t *buf, uint32_t len)
+{
+    uint32_t *word = check_flash_word(address, len);
+
+    if (word == NULL) {
+        memset(buf, 0xFF, len * 4);
+        return;
+    }
+    memcpy(buf, word, len * 4);
+}
+
+// 上电读取不会用到的依赖
+TickType_t xTaskGetTickCount(void)
+{
+    return 0;
+}
+
+void osDelay(uint32_t ms)
+{
+}
+
+fp32 get_temprate(void)
+{
+    return 30.0f;
+}
+
+void buzzer_on(uint16_t psc, uint16_t pwm)
+{
+}
+
+void buzzer_off(void)
+{
+}
+
+const motor_measure_t *get_chassis_motor_measure_point(uint8_t i)
+{
+    static motor_measure_t motor;
+    return &motor;
+}
+
+const motor_measure_t *get_yaw_gimbal_motor_measure_point(void)
+{
+    static motor_measure_t motor;
+    return &motor;
+}
+
+const motor_measure_t *get_pitch_gimbal_motor_measure_point(void)
+{
+    static motor_measure_t motor;
+    return &motor;
+}
+
+bool_t cmd_cali_gimbal_hook(uint16_t *yaw_offset, uint16_t *pitch_offset, fp32 *max_yaw, fp32 *min_yaw,
+                            fp32 *max_pitch, fp32 *min_pitch)
+{
+    return 0;
+}
+
+void set_cali_gimbal_hook(const uint16_t yaw_offset, const uint16_t pitch_offset, const fp32 max_yaw,
+                          const fp32 min_yaw, const fp32 max_pitch, const fp32 min_pitch)
+{
+    check_gimbal_set++;
+    check_gimbal_yaw_offset = yaw_offset;
+}
+
+const RC_ctrl_t *get_remote_control_point(void)
+{
+    static RC_ctrl_t rc;
+    return &rc;
+}
+
+void RC_unable(void)
+{
+}
+
+void RC_restart(uint16_t dma_buf_num)
+{
+}
+
+uint8_t get_game_progress(void)
+{
+    return GYRO_BIAS_GAME_NOT_STARTED;
+}
+
+const fp32 *get_gyro_data_point(void)
+{
+    static fp32 gyro[3];
+    return gyro;
+}
+
+void INS_set_cali_gyro(fp32 cali_scale[3], fp32 cali_offset[3])
+{
+    check_gyro_set++;
+    memcpy(check_gyro_scale, cali_scale, sizeof(check_gyro_scale));
+    memcpy(check_gyro_offset, cali_offset, sizeof(check_gyro_offset));
+}
+
+void INS_cali_gyro(fp32 cali_scale[3], fp32 cali_offset[3], uint16_t *time_count)
+{
+}
+
+void SuperCapEffLoad(uint8_t board, const SuperCap_EffStore *store)
+{
+    if (board < SUPERCAP_MAX_INSTANCES) {
+        check_eff_loaded |= (uint8_t)(1u << board);
+        check_eff_first[board] = store->eff[0][0];
+    }
+}
+
+void SuperCapEffStore(uint8_t board, SuperCap_EffStore *store)
+{
+}
+
+/**
+ * @brief 与STM32硬件CRC相同的按字CRC32, 独立于固件实现
+ */
+static uint32_t check_crc32(uint32_t crc, uint32_t word)
+{
+    uint8_t bit;
+
+    crc ^= word;
+    for (bit = 0; bit < 32; bit++) {
+        crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+    }
+    return crc;
+}
+
+// 构造中的映像
+typedef struct
+{
+    uint32_t word[CHECK_FLASH_SIZE / 4];
+    uint32_t len;
+    uint32_t crc;
+} check_image_t;
+
+static void image_init(check_image_t *img, uint8_t magic)
+{
+    memset(img->word, 0xFF, sizeof(img->word));
+    img->len = 0;
+    img->crc = 0xFFFFFFFFu;
+    // 首字不计入CRC
+    if (magic) {
+        img->word[img->len++] = CALI_IMAGE_MAGIC;
+    }
+}
+
+static void image_put(check_image_t *img, const void *buf, uint32_t len)
+{
+    uint32_t i;
+
+    memcpy(&img->word[img->len], buf, len * 4);
+    for (i = 0; i < len; i++) {
+        img->crc = check_crc32(img->crc, img->word[img->len + i]);
+    }
+    img->len += len;
+}
+
+/**
+ * @brief 追加一条记录
+ * @param desc 1=带描述字, 0=旧布局
+ */
+static void image_record(check_image_t *img, uint8_t desc, const char *name, uint8_t version,
+                         const void *data, uint8_t len)
+{
+    uint8_t head[4] = {(uint8_t)name[0], (uint8_t)name[1], (uint8_t)name[2], CALIED_FLAG};
+
+    if (desc) {
+        cali_record_desc_t d = {len, version, CALI_RECORD_TAG};
+        image_put(img, &d, 1);
+    }
+    image_put(img, data, len);
+    image_put(img, head, 1);
+}
+
+/**
+ * @brief 结束映像并写入假flash
+ * @param with_crc 0=不写CRC, 保持擦除值, 与加入CRC之前的旧数据相同
+ */
+static void image_flash(check_image_t *img, uint8_t with_crc)
+{
+    if (with_crc) {
+        img->word[img->len] = img->crc;
+    }
+    img->len++;
+    memcpy(check_flash, img->word, sizeof(check_flash));
+}
+
+// 样本数据
+static head_cali_t check_head;
+static gimbal_cali_t check_gimbal;
+static imu_cali_t check_gyro_v1;
+static gyro_cali_t check_gyro_v2;       // check_gyro_v1 升级后的值
+static gyro_cali_t check_gyro_new;      // 当前固件写入的记录, cali_offset 与 offset 不同
+static imu_cali_t check_accel;
+static imu_cali_t check_mag;
+static SuperCap_EffStore check_eff[SUPERCAP_MAX_INSTANCES];
+static uint32_t check_unknown[10];
+
+static void check_data_init(void)
+{
+    uint8_t i, p, e;
+
+    check_head.self_id = SELF_ID;
+    check_head.firmware_version = FIRMWARE_VERSION;
+    check_head.temperature = 40;
+    check_head.latitude = 22.5f;
+
+    check_gimbal.yaw_offset = 1234;
+    check_gimbal.pitch_offset = 4321;
+    check_gimbal.yaw_max_angle = 3.0f;
+    check_gimbal.yaw_min_angle = -3.0f;
+    check_gimbal.pitch_max_angle = 0.5f;
+    check_gimbal.pitch_min_angle = -0.4f;
+
+    for (i = 0; i < 3; i++) {
+        check_gyro_v1.offset[i] = 0.001f * (fp32)(i + 1);
+        check_gyro_v1.scale[i] = 1.0f + 0.01f * (fp32)i;
+        check_gyro_v2.offset[i] = check_gyro_v1.offset[i];
+        check_gyro_v2.scale[i] = check_gyro_v1.scale[i];
+        check_gyro_v2.cali_offset[i] = check_gyro_v1.offset[i];
+        check_gyro_new.offset[i] = -0.002f * (fp32)(i + 1);
+        check_gyro_new.scale[i] = 0.99f;
+        check_gyro_new.cali_offset[i] = -0.001f * (fp32)(i + 1);
+        check_accel.offset[i] = 0.05f * (fp32)i;
+        check_accel.scale[i] = 1.02f;
+        check_mag.offset[i] = 10.0f + (fp32)i;
+        check_mag.scale[i] = 0.98f;
+    }
+
+    for (i = 0; i < SUPERCAP_MAX_INSTANCES; i++) {
+        for (p = 0; p < SUPERCAP_EFF_POWER_BINS; p++) {
+            for (e = 0; e < SUPERCAP_EFF_ENERGY_BINS; e++) {
+                check_eff[i].eff[p][e] = (uint16_t)(8000 + i * 1000 + p * 10 + e);
+                check_eff[i].weight[p][e] = (uint16_t)(100 + p + e);
+            }
+        }
+    }
+
+    for (i = 0; i < sizeof(check_unknown) / sizeof(check_unknown[0]); i++) {
+        check_unknown[i] = 0xDEAD0000u + i;
+    }
+}
+
+static uint32_t check_fail(const char *name, const char *what)
+{
+    fprintf(stderr, "%s: %s\n", name, what);
+    return 1;
+}
+
+/**
+ * @brief 清除替身记录, 设备数据填充哨兵值, 然后上电读取
+ */
+static void check_boot(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < CALI_LIST_LENGHT; i++) {
+        if (cali_sensor[i].flash_buf != NULL) {
+            memset(cali_sensor[i].flash_buf, CHECK_SENTINEL, cali_sensor[i].flash_len * 4);
+        }
+    }
+    check_flash_erases = 0;
+    check_flash_writes = 0;
+    check_gyro_set = 0;
+    check_gimbal_set = 0;
+    check_eff_loaded = 0;
+    cali_param_init();
+}
+
+/**
+ * @brief 检查一个设备已载入给定数据
+ */
+static uint32_t check_loaded(const char *name, uint8_t id, const void *expect)
+{
+    char what[64];
+
+    if (cali_sensor[id].cali_done != CALIED_FLAG) {
+        snprintf(what, sizeof(what), "device %u not calibrated", id);
+        return check_fail(name, what);
+    }
+    if (memcmp(cali_sensor[id].flash_buf, expect, cali_sensor[id].flash_len * 4) != 0) {
+        snprintf(what, sizeof(what), "device %u data mismatch", id);
+        return check_fail(name, what);
+    }
+    return 0;
+}
+
+/**
+ * @brief 检查一个设备未载入: 需要重新校准, 数据仍为哨兵值
+ */
+static uint32_t check_not_loaded(const char *name, uint8_t id)
+{
+    const uint8_t *buf = (const uint8_t *)cali_sensor[id].flash_buf;
+    char what[64];
+    uint32_t i;
+
+    if (cali_sensor[id].cali_done == CALIED_FLAG) {
+        snprintf(what, sizeof(what), "device %u loaded", id);
+        return check_fail(name, what);
+    }
+    for (i = 0; i < cali_sensor[id].flash_len * 4u; i++) {
+        if (buf[i] != CHECK_SENTINEL) {
+            snprintf(what, sizeof(what), "device %u data changed", id);
+            return check_fail(name, what);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 按格式独立解析假flash中带描述字的映像, 检查CRC并查找一条记录
+ * @param data 记录数据的输出, 可为NULL
+ * @return 1=找到且映像CRC正确
+ */
+static uint8_t check_flash_find(const char *dev, cali_record_desc_t *desc, uint32_t *data)
+{
+    uint32_t offset = 1;
+    uint32_t crc = 0xFFFFFFFFu;
+    uint8_t found = 0;
+    uint32_t i;
+
+    if (check_flash[0] != CALI_IMAGE_MAGIC) {
+        return 0;
+    }
+    while (offset < CALI_CKPT_OFFSET / 4) {
+        cali_record_desc_t d;
+        uint8_t head[4];
+
+        memcpy(&d, &check_flash[offset], 4);
+        if (d.tag != CALI_RECORD_TAG) {
+            break;
+        }
+        memcpy(head, &check_flash[offset + 1 + d.len], 4);
+        for (i = 0; i < 1u + d.len + 1u; i++) {
+            crc = check_crc32(crc, check_flash[offset + i]);
+        }
+        if (memcmp(head, dev, 3) == 0 && head[3] == CALIED_FLAG) {
+            *desc = d;
+            if (data != NULL) {
+                memcpy(data, &check_flash[offset + 1], d.len * 4);
+            }
+            found = 1;
+        }
+        offset += 1u + d.len + 1u;
+    }
+    return found && check_flash[offset] == crc;
+}
+
+/**
+ * @brief 空flash
+ */
+static uint32_t check_blank(void)
+{
+    const char *name = "blank";
+    uint32_t failures = 0;
+    uint8_t i;
+
+    memset(check_flash, 0xFF, sizeof(check_flash));
+    check_boot();
+    for (i = 0; i < CALI_LIST_LENGHT; i++) {
+        failures += check_not_loaded(name, i);
+        if (cali_sensor[i].cali_hook != NULL && !cali_sensor[i].cali_cmd) {
+            failures += check_fail(name, "device without data not scheduled for calibration");
+        }
+    }
+    if (check_flash_erases != 0 || check_flash_writes != 0) {
+        failures += check_fail(name, "flash written");
+    }
+    return failures;
+}
+
+/**
+ * @brief 旧布局和描述字布局载入后的共同检查: HD 到 EFF 已载入, 陀螺仪为升级后的值, 初始化hook已调用
+ */
+static uint32_t check_upgraded(const char *name)
+{
+    uint32_t failures = 0;
+
+    failures += check_loaded(name, CALI_HEAD, &check_head);
+    failures += check_loaded(name, CALI_GIMBAL, &check_gimbal);
+    failures += check_loaded(name, CALI_GYRO, &check_gyro_v2);
+    failures += check_loaded(name, CALI_ACC, &check_accel);
+    failures += check_loaded(name, CALI_MAG, &check_mag);
+    failures += check_loaded(name, CALI_SUPERCAP_EFF, &check_eff[0]);
+    failures += check_not_loaded(name, CALI_SUPERCAP_EFF1);
+
+    if (check_gyro_set != 1 || memcmp(check_gyro_offset, check_gyro_v2.offset, sizeof(check_gyro_offset)) != 0 ||
+        memcmp(check_gyro_scale, check_gyro_v2.scale, sizeof(check_gyro_scale)) != 0) {
+        failures += check_fail(name, "gyro INIT hook not called with the stored values");
+    }
+    if (check_gimbal_set != 1 || check_gimbal_yaw_offset != check_gimbal.yaw_offset) {
+        failures += check_fail(name, "gimbal INIT hook not called with the stored values");
+    }
+    // 没有自己记录的第1块板用第0块板的表作为初值
+    if (check_eff_loaded != (1u << SUPERCAP_MAX_INSTANCES) - 1u || check_eff_first[1] != check_eff[0].eff[0][0]) {
+        failures += check_fail(name, "efficiency map not seeded from board 0");
+    }
+    return failures;
+}
+
+/**
+ * @brief 检查写回的映像: 带描述字, CRC正确, 陀螺仪为v2
+ */
+static uint32_t check_written(const char *name)
+{
+    cali_record_desc_t desc;
+    uint32_t data[CALI_RECORD_MAX_LENGHT];
+    uint32_t failures = 0;
+
+    if (check_flash_erases != 1) {
+        failures += check_fail(name, "image not written back exactly once");
+    }
+    if (!check_flash_find("GYR", &desc, data)) {
+        return failures + check_fail(name, "written image has no gyro record or a bad CRC");
+    }
+    if (desc.version != CALI_GYRO_VERSION || desc.len != sizeof(gyro_cali_t) / 4 ||
+        memcmp(data, &check_gyro_v2, sizeof(gyro_cali_t)) != 0) {
+        failures += check_fail(name, "gyro not written back as v2");
+    }
+    if (check_flash_find("EF1", &desc, NULL)) {
+        failures += check_fail(name, "uncalibrated device written as calibrated");
+    }
+    return failures;
+}
+
+/**
+ * @brief 再次上电读取写回的映像, 结果相同且不再写入
+ */
+static uint32_t check_reboot(const char *name)
+{
+    uint32_t failures;
+
+    check_boot();
+    failures = check_upgraded(name);
+    if (check_flash_erases != 0 || check_flash_writes != 0) {
+        failures += check_fail(name, "flash written again after the upgrade");
+    }
+    return failures;
+}
+
+/**
+ * @brief 加入描述字和CRC之前的布局, CRC字为擦除值
+ */
+static uint32_t check_legacy(void)
+{
+    static check_image_t img;
+    const char *name = "legacy";
+    uint32_t failures = 0;
+
+    image_init(&img, 0);
+    image_record(&img, 0, "HD", 1, &check_head, sizeof(head_cali_t) / 4);
+    image_record(&img, 0, "GM", 1, &check_gimbal, sizeof(gimbal_cali_t) / 4);
+    image_record(&img, 0, "GYR", 1, &check_gyro_v1, sizeof(imu_cali_t) / 4);
+    image_record(&img, 0, "ACC", 1, &check_accel, sizeof(imu_cali_t) / 4);
+    image_record(&img, 0, "MAG", 1, &check_mag, sizeof(imu_cali_t) / 4);
+    image_record(&img, 0, "EFF", 1, &check_eff[0], sizeof(SuperCap_EffStore) / 4);
+    image_flash(&img, 0);
+
+    check_boot();
+    failures += check_upgraded(name);
+    failures += check_written(name);
+    failures += check_reboot("legacy reboot");
+    return failures;
+}
+
+/**
+ * @brief 带描述字和CRC, 陀螺仪为v1, 没有 EF1
+ */
+static uint32_t check_v1_image(void)
+{
+    static check_image_t img;
+    const char *name = "v1 image";
+    uint32_t failures = 0;
+
+    image_init(&img, 1);
+    image_record(&img, 1, "HD", CALI_HEAD_VERSION, &check_head, sizeof(head_cali_t) / 4);
+    image_record(&img, 1, "GM", CALI_GIMBAL_VERSION, &check_gimbal, sizeof(gimbal_cali_t) / 4);
+    image_record(&img, 1, "GYR", 1, &check_gyro_v1, sizeof(imu_cali_t) / 4);
+    image_record(&img, 1, "ACC", CALI_IMU_VERSION, &check_accel, sizeof(imu_cali_t) / 4);
+    image_record(&img, 1, "MAG", CALI_IMU_VERSION, &check_mag, sizeof(imu_cali_t) / 4);
+    image_record(&img, 1, "EFF", CALI_SUPERCAP_EFF_VERSION, &check_eff[0], sizeof(SuperCap_EffStore) / 4);
+    image_flash(&img, 1);
+
+    check_boot();
+    failures += check_upgraded(name);
+    failures += check_written(name);
+    failures += check_reboot("v1 image reboot");
+    return failures;
+}
+
+/**
+ * @brief 不认识的记录 "XYZ" 和更高版本的 ACC, 记录顺序与本固件不同
+ */
+static uint32_t check_unknown_record(void)
+{
+    static check_image_t img;
+    const char *name = "unknown record";
+    uint32_t failures = 0;
+
+    image_init(&img, 1);
+    image_record(&img, 1, "EF1", CALI_SUPERCAP_EFF_VERSION, &check_eff[1], sizeof(SuperCap_EffStore) / 4);
+    image_record(&img, 1, "HD", CALI_HEAD_VERSION, &check_head, sizeof(head_cali_t) / 4);
+    image_record(&img, 1, "XYZ", 3, check_unknown, sizeof(check_unknown) / 4);
+    image_record(&img, 1, "ACC", CALI_IMU_VERSION + 1, &check_accel, sizeof(imu_cali_t) / 4);
+    image_record(&img, 1, "GM", CALI_GIMBAL_VERSION, &check_gimbal, sizeof(gimbal_cali_t) / 4);
+    image_record(&img, 1, "GYR", CALI_GYRO_VERSION, &check_gyro_new, sizeof(gyro_cali_t) / 4);
+    image_flash(&img, 1);
+
+    check_boot();
+    failures += check_loaded(name, CALI_HEAD, &check_head);
+    failures += check_loaded(name, CALI_GIMBAL, &check_gimbal);
+    failures += check_loaded(name, CALI_GYRO, &check_gyro_new);
+    failures += check_loaded(name, CALI_SUPERCAP_EFF1, &check_eff[1]);
+    failures += check_not_loaded(name, CALI_ACC);
+    failures += check_not_loaded(name, CALI_MAG);
+    failures += check_not_loaded(name, CALI_SUPERCAP_EFF);
+    if (check_eff_loaded != (1u << 1) || check_eff_first[1] != check_eff[1].eff[0][0]) {
+        failures += check_fail(name, "board 1 efficiency map not loaded");
+    }
+    if (check_flash_erases != 0 || check_flash_writes != 0) {
+        failures += check_fail(name, "flash written without an upgrade");
+    }
+    return failures;
+}
+
+/**
+ * @brief CRC错误: 设备数据不变, 全部需要重新校准, 不写flash
+ * @param legacy 1=旧布局, CRC字不是擦除值也不匹配
+ */
+static uint32_t check_bad_crc(uint8_t legacy)
+{
+    static check_image_t img;
+    const char *name = legacy ? "legacy bad crc" : "bad crc";
+    uint32_t failures = 0;
+    uint8_t i;
+
+    image_init(&img, !legacy);
+    image_record(&img, !legacy, "HD", CALI_HEAD_VERSION, &check_head, sizeof(head_cali_t) / 4);
+    image_record(&img, !legacy, "GM", CALI_GIMBAL_VERSION, &check_gimbal, sizeof(gimbal_cali_t) / 4);
+    if (legacy) {
+        image_record(&img, 0, "GYR", 1, &check_gyro_v1, sizeof(imu_cali_t) / 4);
+    } else {
+        image_record(&img, 1, "GYR", CALI_GYRO_VERSION, &check_gyro_new, sizeof(gyro_cali_t) / 4);
+    }
+    image_flash(&img, 1);
+    // 陀螺仪数据中翻转一位
+    check_flash[img.len - 4] ^= 0x00010000u;
+
+    check_boot();
+    for (i = 0; i < CALI_LIST_LENGHT; i++) {
+        failures += check_not_loaded(name, i);
+    }
+    if (check_gyro_set != 0 || check_gimbal_set != 0 || check_eff_loaded != 0) {
+        failures += check_fail(name, "INIT hook called");
+    }
+    if (!cali_sensor[CALI_GYRO].cali_cmd || !cali_sensor[CALI_GIMBAL].cali_cmd) {
+        failures += check_fail(name, "devices not scheduled for calibration");
+    }
+    if (check_flash_erases != 0 || check_flash_writes != 0) {
+        failures += check_fail(name, "flash written");
+    }
+    return failures;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+
+    check_data_init();
+    // 第一次上电设置设备表的数据指针, 之后每个用例前才能填充哨兵值
+    memset(check_flash, 0xFF, sizeof(check_flash));
+    cali_param_init();
+    failures += check_blank();
+    failures += check_legacy();
+    failures += check_v1_image();
+    failures += check_unknown_record();
+    failures += check_bad_crc(0);
+    failures += check_bad_crc(1);
+    failures += check_flash_errors;
+
+    printf("cali image: 6 cases, %lu failures\n", (unsigned long)failures);
+    return failures != 0;
+}
@@ -0,0 +1,9 @@
+#ifndef INS_TASK_H
+#define INS_TASK_H
+#include "struct_typedef.h"
+
+extern const fp32 *get_gyro_data_point(void);
+extern void INS_set_cali_gyro(fp32 cali_scale[3], fp32 cali_offset[3]);
+extern void INS_cali_gyro(fp32 cali_scale[3], fp32 cali_offset[3], uint16_t *time_count);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef BSP_ADC_H
+#define BSP_ADC_H
+#include "struct_typedef.h"
+
+extern fp32 get_temprate(void);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef BSP_FLASH_H
+#define BSP_FLASH_H
+#include "struct_typedef.h"
+
+// 主机编译用, 由 cali_image_check.c 在内存中模拟flash
+extern void flash_erase_address(uint32_t address, uint16_t len);
+extern int8_t flash_write_single_address(uint32_t start_address, uint32_t *buf, uint32_t len);
+extern void flash_read(uint32_t address, uint32_t *buf, uint32_t len);
+
+#endif
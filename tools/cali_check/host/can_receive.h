@@ -0,0 +1,18 @@
+#ifndef CAN_RECEIVE_H
+#define CAN_RECEIVE_H
+#include "struct_typedef.h"
+
+typedef struct
+{
+    uint16_t ecd;
+    int16_t speed_rpm;
+    int16_t given_current;
+    uint8_t temperate;
+    int16_t last_ecd;
+} motor_measure_t;
+
+extern const motor_measure_t *get_chassis_motor_measure_point(uint8_t i);
+extern const motor_measure_t *get_yaw_gimbal_motor_measure_point(void);
+extern const motor_measure_t *get_pitch_gimbal_motor_measure_point(void);
+
+#endif
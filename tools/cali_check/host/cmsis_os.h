@@ -0,0 +1,12 @@
+#ifndef CMSIS_OS_H
+#define CMSIS_OS_H
+#include "struct_typedef.h"
+
+// 主机编译用, 只需声明, 检查程序不运行校准任务
+#define INCLUDE_uxTaskGetStackHighWaterMark 0
+
+typedef uint32_t TickType_t;
+extern TickType_t xTaskGetTickCount(void);
+extern void osDelay(uint32_t ms);
+
+#endif
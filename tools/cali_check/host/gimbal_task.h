@@ -0,0 +1,10 @@
+#ifndef GIMBAL_TASK_H
+#define GIMBAL_TASK_H
+#include "struct_typedef.h"
+
+extern bool_t cmd_cali_gimbal_hook(uint16_t *yaw_offset, uint16_t *pitch_offset, fp32 *max_yaw, fp32 *min_yaw,
+                                   fp32 *max_pitch, fp32 *min_pitch);
+extern void set_cali_gimbal_hook(const uint16_t yaw_offset, const uint16_t pitch_offset, const fp32 max_yaw,
+                                 const fp32 min_yaw, const fp32 max_pitch, const fp32 min_pitch);
+
+#endif
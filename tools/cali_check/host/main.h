@@ -0,0 +1,15 @@
+#ifndef MAIN_H
+#define MAIN_H
+#include <stddef.h>
+#include "struct_typedef.h"
+
+// 主机编译用HAL替身
+#define ADDR_FLASH_SECTOR_9 0x080A0000
+#define __weak              __attribute__((weak))
+
+#define __DMB()
+#define __get_PRIMASK()     0u
+#define __set_PRIMASK(x)    ((void)(x))
+#define __disable_irq()
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef REFEREE_H
+#define REFEREE_H
+#include "struct_typedef.h"
+
+extern uint8_t get_game_progress(void);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef REMOTE_CONTROL_H
+#define REMOTE_CONTROL_H
+#include "struct_typedef.h"
+
+#define SBUS_RX_BUF_NUM     36
+#define switch_is_down(s)   ((s) == 2)
+
+typedef struct
+{
+    struct
+    {
+        int16_t ch[5];
+        char s[2];
+    } rc;
+} RC_ctrl_t;
+
+extern const RC_ctrl_t *get_remote_control_point(void);
+extern void RC_unable(void);
+extern void RC_restart(uint16_t dma_buf_num);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef STM32F4XX_IT_H
+#define STM32F4XX_IT_H
+#include "main.h"
+
+// 主机编译用空替身
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef STRUCT_TYPEDEF_H
+#define STRUCT_TYPEDEF_H
+#include <stdint.h>
+
+// 主机编译用, 与固件 struct_typedef.h 一致
+typedef unsigned char bool_t;
+typedef float fp32;
+typedef double fp64;
+
+#define __packed __attribute__((packed))
+
+#endif
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+生成 supercap_energy_table.c: capEnergy(0-255) -> 电容电压 / 可用能量 / 峰值放电功率 定点查找表.
+
+模型 (与超电板固件 PowerManager 一致):
+  capEnergy = 255 * VB^2 / VMAX^2                 能量与电压平方成正比
+  可用能量 = 0.5 * C * (VB^2 - VCUT^2), VB <= VCUT 时为 0
+  放电电流限制: VB < 5V 为 0.1A, 5V~12V 线性升至 22.5A, 12V 以上 22.5A
+  峰值放电功率 = VB * 放电电流限制
+
+参数修改后需同步 supercap_energy_table.h 中的同名宏, 生成的 .c 会用 #error 检查.
+用法: python3 tools/gen_supercap_energy_table.py supercap_energy_table.c
+生成后用 make -C tools/supercap_replay check 按解析模型逐项检查 (tools/supercap_replay/energy_table_check.c).
+"""
+import math
+import sys
+
+CAPACITANCE_MF = 6000      # 电容容量 (mF)
+MAX_VOLTAGE_MV = 28800     # 满电电压 (mV)
+CUTOFF_VOLTAGE_MV = 12000  # 放电截止电压 (mV)
+
+I_LIMIT = 22.5             # 最大放电电流 (A)
+I_MIN = 0.1                # 低压最小放电电流 (A)
+V_LOW = 5.0                # 放电电流开始线性增加的电压 (V)
+V_FULL_CURRENT = 12.0      # 达到最大放电电流的电压 (V)
+
+
+def cap_voltage(e):
+    return MAX_VOLTAGE_MV / 1000.0 * math.sqrt(e / 255.0)
+
+
+def usable_energy(e):
+    c = CAPACITANCE_MF / 1000.0
+    v = cap_voltage(e)
+    vcut = CUTOFF_VOLTAGE_MV / 1000.0
+    return 0.5 * c * (v * v - vcut * vcut) if v > vcut else 0.0
+
+
+def discharge_current(v):
+    if v < V_LOW:
+        return I_MIN
+    if v < V_FULL_CURRENT:
+        return I_MIN + (I_LIMIT - I_MIN) * (v - V_LOW) / (V_FULL_CURRENT - V_LOW)
+    return I_LIMIT
+
+
+def peak_power(e):
+    v = cap_voltage(e)
+    return v * discharge_current(v)
+
+
+def main():
+    rows = []
+    for e in range(256):
+        mv = round(cap_voltage(e) * 1000.0)
+        dj = round(usable_energy(e) * 10.0)
+        dw = round(peak_power(e) * 10.0)
+        for value in (mv, dj, dw):
+            if value > 0xFFFF:
+                sys.exit("table entry %d overflows uint16, check parameters" % e)
+        # 定点量化误差不超过半个最低位
+        assert abs(mv / 1000.0 - cap_voltage(e)) <= 0.0005
+        assert abs(dj / 10.0 - usable_energy(e)) <= 0.05
+        assert abs(dw / 10.0 - peak_power(e)) <= 0.05
+        rows.append((mv, dj, dw))
+
+    out = open(sys.argv[1], "w", encoding="utf-8", newline="\r\n") if len(sys.argv) > 1 else sys.stdout
+    out.write("/**\n")
+    out.write(" * @file supercap_energy_table.c\n")
+    out.write(" * @brief capEnergy 定点查找表, 由 tools/gen_supercap_energy_table.py 生成, 请勿手改\n")
+    out.write(" */\n\n")
+    out.write('#include "supercap_energy_table.h"\n\n')
+    out.write("#if SUPERCAP_CAP_CAPACITANCE_MF != %d || SUPERCAP_CAP_MAX_VOLTAGE_MV != %d || SUPERCAP_CAP_CUTOFF_VOLTAGE_MV != %d\n"
+              % (CAPACITANCE_MF, MAX_VOLTAGE_MV, CUTOFF_VOLTAGE_MV))
+    out.write("#error \"supercap_energy_table.c is out of date, rerun tools/gen_supercap_energy_table.py\"\n")
+    out.write("#endif\n\n")
+    out.write("const SuperCap_EnergyEntry supercap_energy_table[256] = {\n")
+    for e, (mv, dj, dw) in enumerate(rows):
+        out.write("    {%5d, %5d, %4d}, // %3d\n" % (mv, dj, dw, e))
+    out.write("};\n")
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,85 @@
+/**
+ * @file energy_table_check.c
+ * @brief 用解析模型逐项检查 supercap_energy_table
+ * @note 与生成脚本独立, 直接按物理模型以双精度计算全部256项:
+ *       V = Vmax * sqrt(e / 255)
+ *       可用能量 E = 0.5 * C * (V^2 - Vcut^2), V <= Vcut 时为 0
+ *       峰值功率 P = V * I(V), I 在 5V 以下为 0.1A, 5V~12V 线性升至 22.5A, 12V 以上 22.5A
+ *       参数取自 supercap_energy_table.h, 与表不一致即说明表过期或生成脚本有误.
+ *       定点误差允许1个最低位 (舍入半个, 另留半个给脚本的浮点差异).
+ *
+ *       用法: energy_table_check
+ */
+
+#include "supercap_energy_table.h"
+#include <math.h>
+#include <stdio.h>
+
+#define CHECK_I_LIMIT         22.5
+#define CHECK_I_MIN           0.1
+#define CHECK_V_LOW           5.0
+#define CHECK_V_FULL_CURRENT  12.0
+
+static double check_voltage(int e)
+{
+    return SUPERCAP_CAP_MAX_VOLTAGE_MV * 0.001 * sqrt(e / 255.0);
+}
+
+static double check_usable(int e)
+{
+    double c = SUPERCAP_CAP_CAPACITANCE_MF * 0.001;
+    double v = check_voltage(e);
+    double vcut = SUPERCAP_CAP_CUTOFF_VOLTAGE_MV * 0.001;
+
+    return v > vcut ? 0.5 * c * (v * v - vcut * vcut) : 0.0;
+}
+
+static double check_peak_power(int e)
+{
+    double v = check_voltage(e);
+    double i;
+
+    if (v < CHECK_V_LOW) {
+        i = CHECK_I_MIN;
+    } else if (v < CHECK_V_FULL_CURRENT) {
+        i = CHECK_I_MIN + (CHECK_I_LIMIT - CHECK_I_MIN) * (v - CHECK_V_LOW) / (CHECK_V_FULL_CURRENT - CHECK_V_LOW);
+    } else {
+        i = CHECK_I_LIMIT;
+    }
+    return v * i;
+}
+
+int main(void)
+{
+    unsigned failures = 0;
+    double err_mv = 0.0, err_dj = 0.0, err_dw = 0.0;
+    int e;
+
+    for (e = 0; e < 256; e++) {
+        double mv = fabs(SUPERCAP_VOLTAGE_MV(e) - check_voltage(e) * 1000.0);
+        double dj = fabs(SUPERCAP_USABLE_ENERGY_DJ(e) - check_usable(e) * 10.0);
+        double dw = fabs(SUPERCAP_PEAK_POWER_DW(e) - check_peak_power(e) * 10.0);
+
+        if (mv > 1.0 || dj > 1.0 || dw > 1.0) {
+            fprintf(stderr, "entry %d: table {%u, %u, %u}, model {%.1f mV, %.2f J, %.2f W}\n", e,
+                    SUPERCAP_VOLTAGE_MV(e), SUPERCAP_USABLE_ENERGY_DJ(e), SUPERCAP_PEAK_POWER_DW(e),
+                    check_voltage(e) * 1000.0, check_usable(e), check_peak_power(e));
+            failures++;
+        }
+        err_mv = fmax(err_mv, mv);
+        err_dj = fmax(err_dj, dj);
+        err_dw = fmax(err_dw, dw);
+    }
+
+    // 单调性: 电压和可用能量随 capEnergy 不减
+    for (e = 1; e < 256; e++) {
+        if (SUPERCAP_VOLTAGE_MV(e) < SUPERCAP_VOLTAGE_MV(e - 1) ||
+            SUPERCAP_USABLE_ENERGY_DJ(e) < SUPERCAP_USABLE_ENERGY_DJ(e - 1)) {
+            fprintf(stderr, "entry %d: not monotonic\n", e);
+            failures++;
+        }
+    }
+
+    printf("energy table: max error %.2f mV, %.2f dJ, %.2f dW, %u failures\n", err_mv, err_dj, err_dw, failures);
+    return failures != 0;
+}
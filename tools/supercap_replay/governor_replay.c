@@ -0,0 +1,188 @@
+/**
+ * @file governor_replay.c
+ * @brief 功率限制预测控制器的主机回放与单帧耗时测量
+ * @note 工况文件按裁判系统功率帧 (20ms) 展开, 每帧调用 SuperCapGovernorStep,
+ *       再用简单的被控对象模型推进缓冲能量和电容能量:
+ *       - 板子从裁判系统最多取 powerLimit, 底盘多出的部分由电容补 (受峰值功率和可用能量限制),
+ *         电容补不上的部分仍从裁判系统取
+ *       - 电容总能量与 capEnergy 成正比 (capEnergy = 255 * V^2 / Vmax^2)
+ *       控制器只看到当前帧的底盘功率, 工况中的功率突变即为预测误差.
+ *       单帧耗时由 profile 探针 PROFILE_SUPERCAP_GOVERNOR 统计 (主机为ns),
+ *       目标板上同一探针给出周期数, 与 SUPERCAP_GOV_CYCLE_BUDGET 对照.
+ *
+ *       工况为文本, 每行一段, '#' 开头为注释:
+ *         <duration_ms> <referee_power_limit> <chassis_power>
+ *
+ *       用法: governor_replay <drive_cycle>...
+ *       任一工况缓冲能量耗尽 (裁判系统超功率扣血) 时返回非零.
+ */
+
+#include "main.h"
+#include "profile.h"
+#include "supercap_energy_table.h"
+#include "supercap_governor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GOV_LINE_MAX          128
+#define GOV_FRAME_MS          20
+#define GOV_CAP_TOTAL_J       (0.5f * SUPERCAP_CAP_CAPACITANCE_MF * 0.001f * \
+                               SUPERCAP_CAP_MAX_VOLTAGE_MV * 0.001f * SUPERCAP_CAP_MAX_VOLTAGE_MV * 0.001f)
+
+typedef struct
+{
+    fp32 buffer;                 // 裁判系统缓冲能量 (J)
+    fp32 capEnergy;              // 电容能量 (0-255, 连续值)
+    fp32 minBuffer;              // 缓冲能量最低点 (J)
+    uint32_t frames;             // 功率帧数
+    uint32_t overdrawFrames;     // 缓冲能量耗尽的帧数
+    uint32_t riskFrames;         // 控制器报告 bufferAtRisk 的帧数
+    uint64_t limitSum;           // 下发功率限制累加 (W)
+    fp32 capJoule;               // 电容放出的能量 (J)
+} gov_plant_t;
+
+/**
+ * @brief 推进一帧被控对象
+ */
+static void gov_plant_step(gov_plant_t *pl, const SuperCap_Governor *gov, uint16_t referee_limit, fp32 demand)
+{
+    const fp32 dt = GOV_FRAME_MS * 0.001f;
+    uint8_t e = (uint8_t)pl->capEnergy;
+    fp32 usable = (fp32)SUPERCAP_USABLE_ENERGY_DJ(e) * 0.1f;
+    fp32 peak = (fp32)SUPERCAP_PEAK_POWER_DW(e) * 0.1f;
+    fp32 cap_power = demand - (fp32)gov->powerLimit;
+    fp32 draw;
+
+    if (cap_power > 0.0f) {
+        if (cap_power > peak) {
+            cap_power = peak;
+        }
+        if (cap_power * dt > usable) {
+            cap_power = usable / dt;
+        }
+        draw = demand - cap_power;
+    } else if (pl->capEnergy < 255.0f) {
+        draw = (fp32)gov->powerLimit;
+        cap_power *= SUPERCAP_GOV_CHARGE_EFFICIENCY;
+    } else {
+        draw = demand;
+        cap_power = 0.0f;
+    }
+
+    pl->capEnergy -= cap_power * dt * 255.0f / GOV_CAP_TOTAL_J;
+    if (pl->capEnergy > 255.0f) {
+        pl->capEnergy = 255.0f;
+    }
+    if (pl->capEnergy < 0.0f) {
+        pl->capEnergy = 0.0f;
+    }
+    if (cap_power > 0.0f) {
+        pl->capJoule += cap_power * dt;
+    }
+
+    pl->buffer += ((fp32)referee_limit - draw) * dt;
+    if (pl->buffer > SUPERCAP_GOV_BUFFER_MAX) {
+        pl->buffer = SUPERCAP_GOV_BUFFER_MAX;
+    }
+    if (pl->buffer < 0.0f) {
+        // 裁判系统扣血, 缓冲能量按0继续
+        pl->overdrawFrames++;
+        pl->buffer = 0.0f;
+    }
+    if (pl->buffer < pl->minBuffer) {
+        pl->minBuffer = pl->buffer;
+    }
+}
+
+/**
+ * @brief 回放一个工况文件
+ */
+static int gov_replay_file(const char *path, uint32_t *overdraw)
+{
+    char line[GOV_LINE_MAX];
+    FILE *fp = fopen(path, "r");
+    SuperCap_Governor gov;
+    gov_plant_t pl;
+    uint32_t line_no = 0;
+
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    SuperCapGovernorInit(&gov);
+    memset(&pl, 0, sizeof(pl));
+    pl.buffer = SUPERCAP_GOV_BUFFER_MAX;
+    pl.minBuffer = SUPERCAP_GOV_BUFFER_MAX;
+    pl.capEnergy = 255.0f;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        unsigned long duration, limit;
+        float demand;
+        uint32_t t;
+
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        if (sscanf(line, "%lu %lu %f", &duration, &limit, &demand) != 3) {
+            fprintf(stderr, "%s:%lu: bad line\n", path, (unsigned long)line_no);
+            fclose(fp);
+            return -1;
+        }
+        for (t = 0; t < duration; t += GOV_FRAME_MS) {
+            SuperCapGovernorStep(&gov, (uint16_t)limit, pl.buffer, (uint8_t)pl.capEnergy, demand);
+            gov_plant_step(&pl, &gov, (uint16_t)limit, demand);
+            pl.frames++;
+            pl.riskFrames += gov.bufferAtRisk;
+            pl.limitSum += gov.powerLimit;
+        }
+    }
+    fclose(fp);
+
+    printf("%s\n", path);
+    printf("  %lu frames, min buffer %.1f J, overdraw %lu, at risk %lu, mean limit %.1f W, cap out %.0f J, "
+           "end capEnergy %.0f\n",
+           (unsigned long)pl.frames, pl.minBuffer, (unsigned long)pl.overdrawFrames,
+           (unsigned long)pl.riskFrames, pl.frames ? (double)pl.limitSum / pl.frames : 0.0,
+           pl.capJoule, pl.capEnergy);
+    *overdraw += pl.overdrawFrames;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const profile_probe_t *probe;
+    uint32_t overdraw = 0;
+    uint32_t bin;
+    int i;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <drive_cycle>...\n", argv[0]);
+        return 2;
+    }
+
+    PROFILE_INIT();
+    for (i = 1; i < argc; i++) {
+        if (gov_replay_file(argv[i], &overdraw) != 0) {
+            return 2;
+        }
+    }
+
+    // 单帧耗时, 主机上为ns, 只用于发现计算量随输入变化 (应为常数)
+    probe = profile_get_probe(PROFILE_SUPERCAP_GOVERNOR);
+    if (probe->count != 0) {
+        printf("step: %lu calls, min %lu ns, mean %lu ns, max %lu ns\n", (unsigned long)probe->count,
+               (unsigned long)probe->min, (unsigned long)(probe->sum / probe->count), (unsigned long)probe->max);
+        printf("step histogram (ns):");
+        for (bin = 0; bin < PROFILE_HIST_BINS; bin++) {
+            if (probe->hist[bin] != 0) {
+                printf(" <%lu:%lu", 16ul << bin, (unsigned long)probe->hist[bin]);
+            }
+        }
+        printf("\n");
+    }
+    printf("%lu overdraw frames\n", (unsigned long)overdraw);
+    return overdraw != 0;
+}
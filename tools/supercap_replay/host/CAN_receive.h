@@ -0,0 +1,7 @@
+#ifndef CAN_RECEIVE_H
+#define CAN_RECEIVE_H
+#include "main.h"
+
+// 主机编译用空替身
+
+#endif
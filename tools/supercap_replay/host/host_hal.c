@@ -0,0 +1,40 @@
+/**
+ * @file host_hal.c
+ * @brief 主机编译用HAL与外部模块替身
+ * @note 比赛统计依赖flash和校准任务, 回放只关心解析, 这里替换为空实现.
+ */
+
+#include "main.h"
+#include "super_cap.h"
+#include "supercap_match.h"
+#include "referee.h"
+
+static uint32_t host_tick;
+
+uint32_t HAL_GetTick(void)
+{
+    return host_tick;
+}
+
+void host_set_tick(uint32_t tick)
+{
+    host_tick = tick;
+}
+
+void SuperCapMatchAccumulate(uint8_t board, const SuperCap_Msg_get *cap, uint32_t tick)
+{
+    (void)board;
+    (void)cap;
+    (void)tick;
+}
+
+void get_chassis_power_and_buffer(fp32 *power, fp32 *buffer)
+{
+    *power = 0.0f;
+    *buffer = 0.0f;
+}
+
+uint16_t get_chassis_power_limit(void)
+{
+    return 0;
+}
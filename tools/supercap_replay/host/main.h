@@ -0,0 +1,45 @@
+#ifndef MAIN_H
+#define MAIN_H
+#include <stddef.h>
+#include "struct_typedef.h"
+
+// 主机编译用HAL替身, 时钟由回放程序设置
+extern uint32_t HAL_GetTick(void);
+extern void host_set_tick(uint32_t tick);
+
+#define __DMB()
+#define __get_PRIMASK()     0u
+#define __set_PRIMASK(x)    ((void)(x))
+#define __disable_irq()
+
+#if defined(__ARM_FEATURE_SIMD32)
+// 命令行定义 __ARM_FEATURE_SIMD32 时用C模拟 SSUB16/SEL, 在主机上检查SIMD分支; GE标志按半字各两位
+static inline uint32_t *host_apsr_ge(void)
+{
+    static uint32_t ge;
+    return &ge;
+}
+
+static inline uint32_t __SSUB16(uint32_t a, uint32_t b)
+{
+    int32_t lo = (int32_t)(int16_t)a - (int16_t)b;
+    int32_t hi = (int32_t)(int16_t)(a >> 16) - (int16_t)(b >> 16);
+
+    *host_apsr_ge() = (lo >= 0 ? 0x3u : 0u) | (hi >= 0 ? 0xCu : 0u);
+    return (uint32_t)(uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+}
+
+static inline uint32_t __SEL(uint32_t a, uint32_t b)
+{
+    uint32_t result = 0;
+    uint8_t i;
+
+    for (i = 0; i < 4; i++) {
+        uint32_t byte = 0xFFu << (8 * i);
+        result |= ((*host_apsr_ge() >> i) & 1u ? a : b) & byte;
+    }
+    return result;
+}
+#endif
+
+#endif
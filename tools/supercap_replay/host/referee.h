@@ -0,0 +1,9 @@
+#ifndef REFEREE_H
+#define REFEREE_H
+#include "main.h"
+
+// 主机编译用替身, 回放程序直接调用 SuperCapGovernorStep, 不经过这里
+extern void get_chassis_power_and_buffer(fp32 *power, fp32 *buffer);
+extern uint16_t get_chassis_power_limit(void);
+
+#endif
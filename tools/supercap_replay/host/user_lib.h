@@ -0,0 +1,7 @@
+#ifndef USER_LIB_H
+#define USER_LIB_H
+#include "main.h"
+
+// 主机编译用空替身
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * @file replay_check.c
+ * @brief 回放与模糊测试共用: 送帧, 链路监控, 不变量检查和统计
+ * @note 每帧后检查:
+ *       - chassisPower 有限且不超过 SUPERCAP_POWER_ABS_MAX
+ *       - sampleTick 不晚于当前时刻, 且不回退
+ *       - 数据年龄不下溢
+ *       - v2 新帧/重复/迟到计数之和等于送入的v2帧数
+ *       - 未注册或越界的ID返回NULL
+ *       两帧之间按 REPLAY_MONITOR_PERIOD 调用 SuperCapLinkMonitor, 每次后检查:
+ *       - online 与 SuperCapInstanceOnline 一致
+ *       - 每次最多掉线一次, 掉线后状态回到未知 (需重新握手)
+ */
+
+#include "replay_check.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void replay_fail(replay_state_t *st, const char *what)
+{
+    fprintf(stderr, "frame %lu: %s\n", (unsigned long)st->frames, what);
+    st->failures++;
+}
+
+static uint64_t replay_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void replay_reset(replay_state_t *st, uint8_t keep_latency)
+{
+    uint32_t *latency = st->latency;
+    uint32_t cap = st->latencyCap;
+    uint8_t i;
+
+    memset(st, 0, sizeof(replay_state_t));
+    if (keep_latency) {
+        st->latency = latency;
+        st->latencyCap = cap;
+    } else {
+        free(latency);
+    }
+    if (keep_latency && st->latency == NULL) {
+        st->latencyCap = 4096;
+        st->latency = malloc(st->latencyCap * sizeof(uint32_t));
+    }
+
+    host_set_tick(0);
+    for (i = 0; i < REPLAY_BOARDS; i++) {
+        st->inst[i] = SuperCapInstanceRegister(i, 2000.0f);
+    }
+}
+
+void replay_free(replay_state_t *st)
+{
+    free(st->latency);
+    st->latency = NULL;
+    st->latencyCap = 0;
+    st->latencyCount = 0;
+}
+
+/**
+ * @brief 在当前时钟运行一次链路监控并检查
+ */
+static void replay_monitor_once(replay_state_t *st)
+{
+    uint8_t i;
+
+    SuperCapLinkMonitor();
+    for (i = 0; i < REPLAY_BOARDS; i++) {
+        const SuperCap_Instance *inst = st->inst[i];
+
+        if (inst->online != SuperCapInstanceOnline(inst)) {
+            replay_fail(st, "link monitor online flag stale");
+        }
+        if (inst->linkLost - st->lastLost[i] > 1) {
+            replay_fail(st, "link lost counted twice in one pass");
+        }
+        if (inst->linkLost != st->lastLost[i] && inst->stateKnown) {
+            replay_fail(st, "state still known after link loss");
+        }
+        st->lastLost[i] = inst->linkLost;
+    }
+}
+
+/**
+ * @brief 推进时钟, 期间按周期运行链路监控
+ * @note 长时间静默时状态只在离线判定处变化一次, 中间的周期跳过
+ */
+static void replay_advance(replay_state_t *st, uint32_t tick)
+{
+    while ((int32_t)(tick - st->monitorTick) >= 0) {
+        if (tick - st->monitorTick > 2 * SUPERCAP_OFFLINE_TIME) {
+            host_set_tick(st->monitorTick + SUPERCAP_OFFLINE_TIME + 1);
+            replay_monitor_once(st);
+            st->monitorTick = tick - tick % REPLAY_MONITOR_PERIOD;
+        }
+        host_set_tick(st->monitorTick);
+        replay_monitor_once(st);
+        st->monitorTick += REPLAY_MONITOR_PERIOD;
+    }
+    host_set_tick(tick);
+}
+
+void replay_tx(replay_state_t *st, uint32_t tick, uint8_t board)
+{
+    if (board >= REPLAY_BOARDS) {
+        return;
+    }
+    replay_advance(st, tick);
+    SuperCapInstanceTxPrepare(st->inst[board]);
+}
+
+void replay_frame(replay_state_t *st, uint32_t tick, uint32_t std_id, uint8_t data[8])
+{
+    SuperCap_Instance *expect = SuperCapInstanceFromCanId(std_id);
+    SuperCap_Instance *inst;
+    uint64_t start;
+    uint32_t ns;
+    uint8_t i;
+
+    replay_advance(st, tick);
+
+    start = replay_ns();
+    inst = SuperCapCanRxHandler(std_id, data);
+    ns = (uint32_t)(replay_ns() - start);
+    st->decodeNs += ns;
+    st->frames++;
+    if (st->latency != NULL) {
+        if (st->latencyCount == st->latencyCap) {
+            uint32_t *grown = realloc(st->latency, st->latencyCap * 2 * sizeof(uint32_t));
+            if (grown != NULL) {
+                st->latency = grown;
+                st->latencyCap *= 2;
+            }
+        }
+        if (st->latencyCount < st->latencyCap) {
+            st->latency[st->latencyCount++] = ns;
+        }
+    }
+
+    if (inst != expect) {
+        replay_fail(st, "handler and id lookup disagree");
+        return;
+    }
+    if (inst == NULL) {
+        if (std_id >= SUPERCAP_RX_ID_BASE && std_id - SUPERCAP_RX_ID_BASE < 3 * SUPERCAP_RX_ID_GROUP_SIZE &&
+            (std_id - SUPERCAP_RX_ID_BASE) % SUPERCAP_RX_ID_GROUP_SIZE < REPLAY_BOARDS) {
+            replay_fail(st, "registered id dropped");
+        }
+        return;
+    }
+
+    i = inst->index;
+    if (std_id >= SUPERCAP_RX_V2_ID_BASE) {
+        st->v2Frames[i]++;
+    }
+
+    if (!isfinite(inst->rx.chassisPower) ||
+        fabsf(inst->rx.chassisPower) >= SUPERCAP_POWER_ABS_MAX) {
+        replay_fail(st, "chassisPower not finite or out of range");
+    }
+    if ((int32_t)(inst->sampleTick - tick) > 0) {
+        replay_fail(st, "sampleTick in the future");
+    }
+    if ((int32_t)(inst->sampleTick - st->lastSample[i]) < 0) {
+        replay_fail(st, "sampleTick went backwards");
+    }
+    st->lastSample[i] = inst->sampleTick;
+    if (SuperCapInstanceDataAge(inst) >= 0x80000000u) {
+        replay_fail(st, "data age underflow");
+    }
+    if (inst->link.received + inst->link.duplicated + inst->link.reordered != st->v2Frames[i]) {
+        replay_fail(st, "v2 frame accounting mismatch");
+    }
+}
+
+static int replay_cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+void replay_report(replay_state_t *st)
+{
+    uint8_t i;
+
+    for (i = 0; i < REPLAY_BOARDS; i++) {
+        const SuperCap_Instance *inst = st->inst[i];
+
+        printf("board %u: v2 rx %lu drop %lu reorder %lu dup %lu, sync %lu/%lu, "
+               "badPower %lu badLimit %lu energyJump %lu, linkLost %lu\n",
+               i, (unsigned long)inst->link.received, (unsigned long)inst->link.dropped,
+               (unsigned long)inst->link.reordered, (unsigned long)inst->link.duplicated,
+               (unsigned long)inst->sync.samples, (unsigned long)inst->sync.rejected,
+               (unsigned long)inst->anomaly.badPower, (unsigned long)inst->anomaly.badPowerLimit,
+               (unsigned long)inst->anomaly.energyJump, (unsigned long)inst->linkLost);
+    }
+
+    // 主机耗时只用于对比改动前后, 与目标板周期数无关; 打开ASan时偏大
+    if (st->frames != 0 && st->decodeNs != 0) {
+        printf("decode: %.0f frames/s", (double)st->frames * 1e9 / (double)st->decodeNs);
+        if (st->latencyCount != 0) {
+            qsort(st->latency, st->latencyCount, sizeof(uint32_t), replay_cmp_u32);
+            printf(", latency p50 %lu ns p99 %lu ns p99.9 %lu ns max %lu ns",
+                   (unsigned long)st->latency[st->latencyCount / 2],
+                   (unsigned long)st->latency[(uint64_t)st->latencyCount * 99 / 100],
+                   (unsigned long)st->latency[(uint64_t)st->latencyCount * 999 / 1000],
+                   (unsigned long)st->latency[st->latencyCount - 1]);
+        }
+        printf("\n");
+    }
+    printf("%lu frames, %lu failures\n", (unsigned long)st->frames, (unsigned long)st->failures);
+}
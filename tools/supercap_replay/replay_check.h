@@ -0,0 +1,60 @@
+#ifndef REPLAY_CHECK_H
+#define REPLAY_CHECK_H
+#include "main.h"
+#include "super_cap.h"
+
+#define REPLAY_BOARDS             SUPERCAP_MAX_INSTANCES
+#define REPLAY_MONITOR_PERIOD     10      // 链路监控周期 (ms), 与低速执行器中的登记一致
+
+// 模糊测试输入: 每条记录10字节 [dt(ms), sel, data0..data7]
+// sel < REPLAY_FUZZ_ID_SPAN: 接收帧, ID = SUPERCAP_RX_ID_BASE - 2 + sel, 覆盖全部超电ID及两侧
+// REPLAY_FUZZ_TX_SEL + n:    板n发出对时请求, 忽略data
+// 其他:                      接收帧, ID = sel << 3, 与超电无关的ID
+#define REPLAY_FUZZ_RECORD_LEN    10
+#define REPLAY_FUZZ_ID_SPAN       0x40
+#define REPLAY_FUZZ_TX_SEL        0xF0
+#define REPLAY_FUZZ_OTHER_SEL     0xFF
+
+// 回放状态与统计, 回放程序和libFuzzer入口共用
+typedef struct
+{
+    SuperCap_Instance *inst[REPLAY_BOARDS];
+    uint32_t lastSample[REPLAY_BOARDS];
+    uint32_t v2Frames[REPLAY_BOARDS];
+    uint32_t lastLost[REPLAY_BOARDS];
+    uint32_t monitorTick;        // 下次链路监控时刻 (ms)
+    uint32_t frames;
+    uint32_t failures;
+    uint64_t decodeNs;           // 解析耗时累加 (ns)
+    uint32_t *latency;           // 每帧解析耗时 (ns), 用于分位数, 为NULL时不记录
+    uint32_t latencyCount;
+    uint32_t latencyCap;
+} replay_state_t;
+
+/**
+ * @brief 上电状态: 注册全部超电板, 时钟归零
+ * @param keep_latency 1=记录每帧耗时
+ */
+extern void replay_reset(replay_state_t *st, uint8_t keep_latency);
+
+/**
+ * @brief 释放耗时记录
+ */
+extern void replay_free(replay_state_t *st);
+
+/**
+ * @brief 推进时钟到tick, 其间按周期运行链路监控, 再送入一帧并检查不变量
+ */
+extern void replay_frame(replay_state_t *st, uint32_t tick, uint32_t std_id, uint8_t data[8]);
+
+/**
+ * @brief 推进时钟到tick并为一块板准备发送 (发出对时请求)
+ */
+extern void replay_tx(replay_state_t *st, uint32_t tick, uint8_t board);
+
+/**
+ * @brief 打印各板统计, 解析吞吐和耗时分位数
+ */
+extern void replay_report(replay_state_t *st);
+
+#endif
@@ -0,0 +1,269 @@
+/**
+ * @file standby_sim.c
+ * @brief DCDC预测待机的主机仿真: 节省能量和唤醒延迟
+ * @note 直接编译固件的 supercap_standby.c 和 supercap_recovery.c, 按发送任务的顺序每10ms
+ *       调用 SuperCapStandbyUpdate 和 SuperCapRecoveryUpdate, 超电板用简单模型代替:
+ *       - 每10ms回一帧v1 (0x051), 输出禁用时 errorCode 带 bit7
+ *       - 使能位 0->1 后经过唤醒延迟才回报输出使能, 延迟依次取 sim_wake_latency
+ *       - 底盘功率滞后底盘指令 SIM_CHASSIS_LAG, 空闲时为 SIM_IDLE_POWER
+ *       - 待机时电容自放电, 使能且底盘轻载时充电, 重载时放电
+ *       指令阶跃时提前量只有底盘功率滞后指令的时间, 唤醒未完成时出现的负载计入
+ *       loaded without cap.
+ *       最后检查待机中出现不可恢复故障: 待机控制器不改写使能位, 锁定后DCDC保持禁用.
+ *
+ *       用法: standby_sim
+ *       锁定检查失败或工况中从未进入待机时返回非零.
+ */
+
+#include "main.h"
+#include "supercap_recovery.h"
+#include "supercap_standby.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SIM_PERIOD            10      // 发送周期和超电板回帧周期 (ms)
+#define SIM_CHASSIS_LAG       60      // 底盘功率滞后指令的时间 (ms)
+#define SIM_IDLE_POWER        3.0f    // 底盘空闲功率 (W)
+#define SIM_FULL_POWER        200.0f  // 指令为1时的底盘功率 (W)
+#define SIM_POWER_LIMIT       80      // 裁判系统功率限制 (W)
+#define SIM_LEAK_MS           2000    // 待机时每该时间自放电1个 capEnergy
+#define SIM_CHARGE_MS         40      // 使能且轻载时每该时间充电1个 capEnergy
+#define SIM_DRAIN_MS          20      // 超功率时每该时间放电1个 capEnergy
+
+// 工况段: 持续时间内指令从 from 线性变化到 to
+typedef struct
+{
+    uint32_t duration;
+    fp32 from;
+    fp32 to;
+} sim_segment_t;
+
+static const sim_segment_t sim_drive[] = {
+    {8000, 0.0f, 0.0f},
+    {1500, 0.0f, 0.8f},     // 缓慢起步, 应被预测提前唤醒
+    {3000, 0.8f, 0.8f},
+    {12000, 0.0f, 0.0f},
+    {2000, 1.0f, 1.0f},     // 阶跃, 只有功率滞后指令的时间可用
+    {15000, 0.0f, 0.0f},
+    {1000, 0.0f, 0.5f},
+    {20000, 0.0f, 0.0f},
+    {500, 0.3f, 0.3f},
+    {30000, 0.0f, 0.0f},    // 长时间空闲, 自放电唤醒补电
+};
+
+static const uint32_t sim_wake_latency[] = {40, 80, 120, 160, 220};
+
+// 超电板模型
+typedef struct
+{
+    uint8_t enable;              // 上次收到的使能位
+    uint8_t output;              // 1=输出使能
+    uint32_t enableTick;         // 使能位 0->1 的时刻 (ms)
+    uint32_t wakeLatency;        // 本次唤醒延迟 (ms)
+    uint8_t wakeIndex;
+    uint8_t fault;               // 注入的错误位
+    uint8_t capEnergy;
+    uint32_t energyMs;           // 未满1个 capEnergy 的累计时间 (ms)
+} sim_board_t;
+
+typedef struct
+{
+    sim_board_t board;
+    SuperCap_Standby sb;
+    SuperCap_Recovery rec;
+    SuperCap_Instance *inst;
+    fp32 cmdHistory[SIM_CHASSIS_LAG / SIM_PERIOD];
+    uint8_t cmdHead;
+    uint32_t tick;
+    uint32_t unavailableMs;      // 底盘有负载但电容不可用的时间 (ms)
+} sim_t;
+
+static void sim_board_step(sim_board_t *b, uint8_t enable, fp32 power, uint32_t tick)
+{
+    if (enable && !b->enable) {
+        b->enableTick = tick;
+        b->wakeLatency = sim_wake_latency[b->wakeIndex];
+        b->wakeIndex = (uint8_t)((b->wakeIndex + 1) % (sizeof(sim_wake_latency) / sizeof(sim_wake_latency[0])));
+    }
+    b->enable = enable;
+    if (!enable) {
+        b->output = 0;
+    } else if (!b->output && tick - b->enableTick >= b->wakeLatency) {
+        b->output = 1;
+    }
+
+    b->energyMs += SIM_PERIOD;
+    if (!b->output) {
+        if (b->energyMs >= SIM_LEAK_MS) {
+            b->energyMs = 0;
+            if (b->capEnergy > 0) {
+                b->capEnergy--;
+            }
+        }
+    } else if (power > (fp32)SIM_POWER_LIMIT) {
+        if (b->energyMs >= SIM_DRAIN_MS) {
+            b->energyMs = 0;
+            if (b->capEnergy > 0) {
+                b->capEnergy--;
+            }
+        }
+    } else if (b->energyMs >= SIM_CHARGE_MS) {
+        b->energyMs = 0;
+        if (b->capEnergy < 255) {
+            b->capEnergy++;
+        }
+    }
+}
+
+/**
+ * @brief 超电板回一帧v1
+ */
+static void sim_board_send(const sim_board_t *b, fp32 power)
+{
+    uint8_t data[8];
+    uint16_t limit = SIM_POWER_LIMIT;
+
+    data[0] = (uint8_t)(b->fault | (b->output ? 0 : 0x80));
+    memcpy(&data[1], &power, sizeof(power));
+    data[5] = (uint8_t)limit;
+    data[6] = (uint8_t)(limit >> 8);
+    data[7] = b->capEnergy;
+    SuperCapCanRxHandler(SUPERCAP_RX_ID_BASE, data);
+}
+
+static void sim_init(sim_t *s)
+{
+    memset(s, 0, sizeof(sim_t));
+    s->board.capEnergy = 255;
+    host_set_tick(0);
+    s->inst = SuperCapInstanceRegister(0, 2000.0f);
+    SuperCapEnable(&s->inst->tx);
+    SuperCapStandbyInit(&s->sb);
+    SuperCapRecoveryInit(&s->rec);
+}
+
+/**
+ * @brief 推进一个周期: 超电板回帧, 然后按发送任务的顺序更新待机和故障恢复
+ * @return 0=正常, -1=待机控制器在有错误时改写了使能位
+ */
+static int sim_step(sim_t *s, fp32 cmd)
+{
+    fp32 power;
+    uint8_t enable;
+
+    // 底盘功率滞后指令
+    power = s->cmdHistory[s->cmdHead];
+    s->cmdHistory[s->cmdHead] = cmd;
+    s->cmdHead = (uint8_t)((s->cmdHead + 1) % (SIM_CHASSIS_LAG / SIM_PERIOD));
+    power = power > 0.0f ? power * SIM_FULL_POWER : SIM_IDLE_POWER;
+
+    s->tick += SIM_PERIOD;
+    host_set_tick(s->tick);
+    sim_board_step(&s->board, s->inst->tx.enableDCDC, power, s->tick);
+    sim_board_send(&s->board, power);
+
+    enable = s->inst->tx.enableDCDC;
+    SuperCapStandbyUpdate(&s->sb, s->inst, cmd, s->tick);
+    if (SUPERCAP_GET_ERROR(s->inst->rx.errorCode) != 0 && s->inst->tx.enableDCDC != enable) {
+        return -1;
+    }
+    SuperCapRecoveryUpdate(&s->rec, s->inst, s->tick);
+
+    if (power > SIM_IDLE_POWER && !SuperCapStandbyAvailable(&s->sb)) {
+        s->unavailableMs += SIM_PERIOD;
+    }
+    return 0;
+}
+
+static void sim_report(const sim_t *s)
+{
+    printf("standby: %lu entries, %lu wakes (%lu late, %lu timeout), %lu ms standby, saved %.1f J\n",
+           (unsigned long)s->sb.entries, (unsigned long)s->sb.wakes, (unsigned long)s->sb.lateWakes,
+           (unsigned long)s->sb.wakeTimeouts, (unsigned long)s->sb.standbyMs, s->sb.savedEnergy);
+    printf("wake latency: worst %lu ms, mean %lu ms, lead %u ms, loaded without cap %lu ms of %lu ms\n",
+           (unsigned long)s->sb.wakeLatencyMax, (unsigned long)SuperCapStandbyMeanWakeLatency(&s->sb),
+           s->sb.lead, (unsigned long)s->unavailableMs, (unsigned long)s->tick);
+}
+
+/**
+ * @brief 工况仿真
+ */
+static uint32_t sim_drive_cycle(void)
+{
+    static sim_t s;
+    uint32_t failures = 0;
+    uint32_t i, t;
+
+    sim_init(&s);
+    for (i = 0; i < sizeof(sim_drive) / sizeof(sim_drive[0]); i++) {
+        const sim_segment_t *seg = &sim_drive[i];
+
+        for (t = 0; t < seg->duration; t += SIM_PERIOD) {
+            fp32 cmd = seg->from + (seg->to - seg->from) * (fp32)t / (fp32)seg->duration;
+
+            if (sim_step(&s, cmd) != 0) {
+                fprintf(stderr, "%lu ms: standby rewrote enableDCDC with an error present\n", (unsigned long)s.tick);
+                failures++;
+            }
+        }
+    }
+
+    sim_report(&s);
+    if (s.sb.entries == 0 || s.sb.savedEnergy <= 0.0f) {
+        fprintf(stderr, "drive cycle never entered standby\n");
+        failures++;
+    }
+    return failures;
+}
+
+/**
+ * @brief 待机中出现电容故障: 锁定后使能位保持为0, 故障清除后也不恢复
+ */
+static uint32_t sim_fault_in_standby(void)
+{
+    static sim_t s;
+    uint32_t failures = 0;
+    uint32_t t;
+
+    sim_init(&s);
+    for (t = 0; t < 10000 && s.sb.state != SUPERCAP_STANDBY_IDLE; t += SIM_PERIOD) {
+        sim_step(&s, 0.0f);
+    }
+    if (s.sb.state != SUPERCAP_STANDBY_IDLE) {
+        fprintf(stderr, "fault check: never entered standby\n");
+        return 1;
+    }
+
+    s.board.fault = SUPERCAP_ERROR_CAPACITOR;
+    for (t = 0; t < 500; t += SIM_PERIOD) {
+        if (sim_step(&s, 0.0f) != 0) {
+            fprintf(stderr, "fault check: standby rewrote enableDCDC with an error present\n");
+            failures++;
+        }
+    }
+    s.board.fault = 0;
+    for (t = 0; t < 3000; t += SIM_PERIOD) {
+        sim_step(&s, 0.0f);
+        if (s.inst->tx.enableDCDC != 0) {
+            fprintf(stderr, "fault check: %lu ms: DCDC re-enabled during lockout\n", (unsigned long)s.tick);
+            failures++;
+            break;
+        }
+    }
+    if (s.rec.state != SUPERCAP_RECOVERY_LOCKOUT) {
+        fprintf(stderr, "fault check: recovery not locked out\n");
+        failures++;
+    }
+    printf("fault in standby: recovery state %d, enableDCDC %u, %lu failures\n",
+           (int)s.rec.state, s.inst->tx.enableDCDC, (unsigned long)failures);
+    return failures;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+
+    failures += sim_drive_cycle();
+    failures += sim_fault_in_standby();
+    return failures != 0;
+}
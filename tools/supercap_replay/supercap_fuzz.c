@@ -0,0 +1,84 @@
+/**
+ * @file supercap_fuzz.c
+ * @brief 超电接收解析的覆盖率引导模糊测试入口 (libFuzzer)
+ * @note 输入为10字节记录序列, 格式见 replay_check.h, 每个输入从上电状态开始,
+ *       检查与回放相同的不变量, 失败时 abort 让 libFuzzer 保存触发输入.
+ *       对时应答要回显请求的序号和时刻, 靠 -fsanitize=fuzzer 的比较插桩找到.
+ *
+ *       clang:  make -C tools/supercap_replay fuzz, 然后
+ *               ./supercap_fuzz -max_len=4000 fuzz_corpus seeds
+ *       种子:   supercap_replay -s seeds/v2.bin corpus/v2_seq_sync.txt
+ *       未定义 SUPERCAP_FUZZ_LIBFUZZER 时 (gcc) 编译为独立程序, 依次执行参数中的输入文件,
+ *       用于复现libFuzzer保存的输入和在 make check 中运行种子.
+ */
+
+#include "replay_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static replay_state_t st;
+    uint32_t tick = 0;
+    size_t n;
+
+    replay_reset(&st, 0);
+    for (n = 0; n + REPLAY_FUZZ_RECORD_LEN <= size; n += REPLAY_FUZZ_RECORD_LEN) {
+        const uint8_t *rec = &data[n];
+        uint32_t std_id;
+        uint8_t frame[8];
+        uint8_t i;
+
+        tick += rec[0];
+        if (rec[1] >= REPLAY_FUZZ_TX_SEL && rec[1] < REPLAY_FUZZ_TX_SEL + REPLAY_BOARDS) {
+            replay_tx(&st, tick, rec[1] - REPLAY_FUZZ_TX_SEL);
+            continue;
+        }
+        for (i = 0; i < 8; i++) {
+            frame[i] = rec[2 + i];
+        }
+        if (rec[1] < REPLAY_FUZZ_ID_SPAN) {
+            std_id = (uint32_t)(SUPERCAP_RX_ID_BASE - 2 + rec[1]);
+        } else {
+            std_id = (uint32_t)rec[1] << 3;
+        }
+        replay_frame(&st, tick, std_id, frame);
+    }
+
+    if (st.failures != 0) {
+        abort();
+    }
+    return 0;
+}
+
+#ifndef SUPERCAP_FUZZ_LIBFUZZER
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[1 << 20];
+    int i;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <input>...\n", argv[0]);
+        return 2;
+    }
+
+    for (i = 1; i < argc; i++) {
+        FILE *fp = fopen(argv[i], "rb");
+        size_t size;
+
+        if (fp == NULL) {
+            perror(argv[i]);
+            return 2;
+        }
+        size = fread(buf, 1, sizeof(buf), fp);
+        fclose(fp);
+        LLVMFuzzerTestOneInput(buf, size);
+        printf("%s: %lu records ok\n", argv[i], (unsigned long)(size / REPLAY_FUZZ_RECORD_LEN));
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,223 @@
+/**
+ * @file supercap_replay.c
+ * @brief 超电接收解析的主机回放
+ * @note 直接编译固件的 super_cap.c 等源文件, 把语料或candump日志中的CAN帧按时间戳送入
+ *       SuperCapCanRxHandler, 两帧之间按周期运行 SuperCapLinkMonitor, 不变量见 replay_check.c.
+ *       任一不变量失败时打印帧号并返回非零. 结束时打印解析吞吐 (帧/s) 和单帧耗时分位数.
+ *
+ *       语料为文本, 每行一条, '#' 开头为注释:
+ *         <tick> <std_id> <b0> ... <b7>   接收帧, 十六进制字节
+ *         <tick> tx <board>               调用 SuperCapInstanceTxPrepare, 发出对时请求
+ *       也接受 candump 日志, 时间戳换算为相对首帧的ms, 扩展帧和非8字节帧跳过:
+ *         (1697712345.123456) can0 059#00BC0250C80A6CFF             candump -l
+ *         (1697712345.123456)  can0  059   [8]  00 BC 02 50 ...      candump -ta / -td
+ *
+ *       用法: supercap_replay <corpus|candump.log>...
+ *             supercap_replay -s <seed_out> <corpus|candump.log>   转为 supercap_fuzz 的种子
+ */
+
+#include "replay_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_LINE_MAX       256
+
+typedef struct
+{
+    FILE *seed;                  // 非NULL时把帧写为模糊测试种子
+    uint32_t seedTick;           // 种子上一条记录的时刻 (ms)
+    double firstStamp;           // candump 首帧时间戳 (s)
+    uint8_t haveStamp;
+    uint32_t skipped;            // 跳过的扩展帧/非8字节帧
+} replay_input_t;
+
+/**
+ * @brief 写一条种子记录, 格式见 replay_check.h
+ */
+static void replay_seed_write(replay_input_t *in, uint32_t tick, uint8_t sel, const uint8_t data[8])
+{
+    uint8_t rec[REPLAY_FUZZ_RECORD_LEN] = {0};
+
+    if (in->seed == NULL) {
+        return;
+    }
+    // 长时间静默用无关ID的空帧补齐时间
+    while (tick - in->seedTick > 0xFF && (int32_t)(tick - in->seedTick) > 0) {
+        rec[0] = 0xFF;
+        rec[1] = REPLAY_FUZZ_OTHER_SEL;
+        fwrite(rec, 1, sizeof(rec), in->seed);
+        in->seedTick += 0xFF;
+    }
+    rec[0] = (int32_t)(tick - in->seedTick) > 0 ? (uint8_t)(tick - in->seedTick) : 0;
+    rec[1] = sel;
+    if (data != NULL) {
+        memcpy(&rec[2], data, 8);
+    }
+    fwrite(rec, 1, sizeof(rec), in->seed);
+    in->seedTick += rec[0];
+}
+
+static void replay_input_frame(replay_state_t *st, replay_input_t *in, uint32_t tick, uint32_t id, uint8_t data[8])
+{
+    uint32_t offset = id - (SUPERCAP_RX_ID_BASE - 2);
+
+    replay_seed_write(in, tick, offset < REPLAY_FUZZ_ID_SPAN ? (uint8_t)offset : REPLAY_FUZZ_OTHER_SEL, data);
+    replay_frame(st, tick, id, data);
+}
+
+/**
+ * @brief 解析一行candump日志
+ * @return 1=得到一帧, 0=跳过, -1=不是candump格式
+ */
+static int replay_parse_candump(replay_input_t *in, const char *line, uint32_t *tick, uint32_t *id, uint8_t data[8])
+{
+    double stamp;
+    char iface[32];
+    char frame[64];
+    int used = 0;
+    unsigned int dlc;
+    unsigned int b[8];
+    char *hash;
+    uint8_t i;
+
+    if (sscanf(line, " (%lf) %31s %63s%n", &stamp, iface, frame, &used) != 3) {
+        return -1;
+    }
+    if (!in->haveStamp) {
+        in->firstStamp = stamp;
+        in->haveStamp = 1;
+    }
+    *tick = (uint32_t)((stamp - in->firstStamp) * 1000.0 + 0.5);
+
+    hash = strchr(frame, '#');
+    if (hash != NULL) {
+        // candump -l: ID#数据, 扩展帧ID为8位
+        if (hash - frame != 3 || strlen(hash + 1) != 16) {
+            in->skipped++;
+            return 0;
+        }
+        *id = (uint32_t)strtoul(frame, NULL, 16);
+        for (i = 0; i < 8; i++) {
+            char byte[3] = {hash[1 + 2 * i], hash[2 + 2 * i], 0};
+            data[i] = (uint8_t)strtoul(byte, NULL, 16);
+        }
+        return 1;
+    }
+
+    if (strlen(frame) != 3 ||
+        sscanf(line + used, " [%u] %x %x %x %x %x %x %x %x", &dlc,
+               &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7]) != 9 || dlc != 8) {
+        in->skipped++;
+        return 0;
+    }
+    *id = (uint32_t)strtoul(frame, NULL, 16);
+    for (i = 0; i < 8; i++) {
+        data[i] = (uint8_t)b[i];
+    }
+    return 1;
+}
+
+/**
+ * @brief 回放一个语料文件或candump日志
+ */
+static int replay_file(replay_state_t *st, replay_input_t *in, const char *path)
+{
+    char line[REPLAY_LINE_MAX];
+    FILE *fp = fopen(path, "r");
+    uint32_t line_no = 0;
+
+    if (fp == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        unsigned long tick, id;
+        unsigned int b[8];
+        uint32_t can_tick, can_id;
+        uint8_t data[8];
+        uint8_t i;
+        int ret;
+
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        ret = replay_parse_candump(in, line, &can_tick, &can_id, data);
+        if (ret == 1) {
+            replay_input_frame(st, in, can_tick, can_id, data);
+            continue;
+        }
+        if (ret == 0) {
+            continue;
+        }
+        if (sscanf(line, "%lu tx %lu", &tick, &id) == 2) {
+            if (id < REPLAY_BOARDS) {
+                replay_seed_write(in, (uint32_t)tick, (uint8_t)(REPLAY_FUZZ_TX_SEL + id), NULL);
+                replay_tx(st, (uint32_t)tick, (uint8_t)id);
+            }
+            continue;
+        }
+        if (sscanf(line, "%lu %lx %x %x %x %x %x %x %x %x", &tick, &id,
+                   &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7]) != 10) {
+            fprintf(stderr, "%s:%lu: bad line\n", path, (unsigned long)line_no);
+            fclose(fp);
+            return -1;
+        }
+        for (i = 0; i < 8; i++) {
+            data[i] = (uint8_t)b[i];
+        }
+        replay_input_frame(st, in, (uint32_t)tick, (uint32_t)id, data);
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    replay_state_t st = {0};
+    replay_input_t in;
+    uint32_t failures = 0;
+    int first = 1;
+    int i;
+
+    memset(&in, 0, sizeof(in));
+    if (argc >= 4 && strcmp(argv[1], "-s") == 0) {
+        in.seed = fopen(argv[2], "wb");
+        if (in.seed == NULL) {
+            perror(argv[2]);
+            return 2;
+        }
+        first = 3;
+    }
+
+    if (argc <= first) {
+        fprintf(stderr, "usage: %s [-s <seed_out>] <corpus|candump.log>...\n", argv[0]);
+        return 2;
+    }
+
+    // 每个文件从上电状态开始
+    for (i = first; i < argc; i++) {
+        replay_reset(&st, 1);
+        in.haveStamp = 0;
+        in.skipped = 0;
+        in.seedTick = 0;
+        if (replay_file(&st, &in, argv[i]) != 0) {
+            return 2;
+        }
+        printf("%s\n", argv[i]);
+        if (in.skipped != 0) {
+            printf("skipped %lu extended or short frames\n", (unsigned long)in.skipped);
+        }
+        replay_report(&st);
+        failures += st.failures;
+    }
+
+    replay_free(&st);
+    if (in.seed != NULL) {
+        fclose(in.seed);
+    }
+    return failures != 0;
+}
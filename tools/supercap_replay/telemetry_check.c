@@ -0,0 +1,287 @@
+/**
+ * @file telemetry_check.c
+ * @brief 历史遥测窗口统计的暴力检查与耗时对比
+ * @note 向 SuperCapTelemetryPush 送入 TEL_CHECK_FRAMES 帧伪随机数据 (功率随机游走加尖峰和限幅,
+ *       能量随机游走, 时间戳抖动和重复), 每帧后对 tel_check_windows 中的每个窗口
+ *       把均值、dE/dt、最小/最大值与影子缓冲上的逐帧扫描比较. 部分窗口先登记 (单调队列),
+ *       一个窗口在中途登记 (检查重建), 其余走扫描分支.
+ *       以 -D__ARM_FEATURE_SIMD32 编译时扫描走 SSUB16/SEL 分支 (host/main.h 中模拟).
+ *
+ *       耗时对比: TEL_BENCH_CONSUMERS 个使用者各自从packed帧读 chassisPower, 维护自己的窗口缓冲,
+ *       每帧扫描求均值/最小/最大值和dE/dt (原来各模块自带滤波的做法), 与一次写入遥测加
+ *       每个使用者三次窗口查询比较. 主机耗时只用于对比两种做法, 打开ASan时偏大.
+ *
+ *       用法: telemetry_check
+ */
+
+#include "main.h"
+#include "supercap_energy_table.h"
+#include "supercap_telemetry.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define TEL_CHECK_FRAMES      100000
+#define TEL_CHECK_REGISTER_AT 50000   // 中途登记窗口的帧号
+#define TEL_BENCH_CONSUMERS   4
+#define TEL_BENCH_WINDOW      32
+
+static const uint16_t tel_check_windows[] = {0, 1, 2, 3, 7, 31, 32, 64, 100, 127, 128, 129, 300};
+static const uint16_t tel_check_registered[] = {1, 32, SUPERCAP_TELEMETRY_SIZE};
+#define TEL_CHECK_LATE_WINDOW 100
+
+static uint32_t tel_rand_state = 12345;
+
+static uint32_t tel_rand(void)
+{
+    tel_rand_state = tel_rand_state * 1664525u + 1013904223u;
+    return tel_rand_state >> 8;
+}
+
+// 影子缓冲, 保存全部帧
+static int16_t shadow_power[TEL_CHECK_FRAMES];
+static uint16_t shadow_energy[TEL_CHECK_FRAMES];
+static uint32_t shadow_tick[TEL_CHECK_FRAMES];
+
+/**
+ * @brief 与 SuperCapTelemetryPush 相同的限幅取整
+ */
+static int16_t tel_power_dw(fp32 power)
+{
+    fp32 power_dw = power * 10.0f;
+
+    if (power_dw > 32767.0f) {
+        return 32767;
+    }
+    if (power_dw < -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)power_dw;
+}
+
+/**
+ * @brief 生成一帧
+ */
+static void tel_gen(SuperCap_Msg_get *cap, fp32 *power, uint8_t *energy, uint32_t *tick)
+{
+    uint32_t r = tel_rand();
+
+    *power += (fp32)((int32_t)(r % 401) - 200) * 0.1f;
+    if (*power < -100.0f || *power > 400.0f) {
+        *power = 50.0f;
+    }
+    if ((r >> 12) % 500 == 0) {
+        cap->chassisPower = (r >> 20) & 1 ? 5000.0f : -5000.0f;   // 超出int16, 限幅
+    } else if ((r >> 12) % 97 == 0) {
+        cap->chassisPower = *power * 3.0f;                          // 尖峰
+    } else {
+        cap->chassisPower = *power;
+    }
+    *energy = (uint8_t)(*energy + (int32_t)((r >> 4) % 5) - 2);
+    cap->capEnergy = *energy;
+    cap->chassisPowerLimit = (uint16_t)(40 + (r >> 16) % 80);
+    cap->errorCode = 0;
+    *tick += (r >> 8) % 16 == 0 ? 0 : 8 + (r >> 10) % 5;
+}
+
+static uint32_t tel_fail(uint32_t frame, uint16_t window, const char *what, double got, double expect)
+{
+    fprintf(stderr, "frame %lu window %u: %s %.4f, expected %.4f\n", (unsigned long)frame, window, what, got, expect);
+    return 1;
+}
+
+/**
+ * @brief 一个窗口与影子缓冲比较
+ */
+static uint32_t tel_check_window(const SuperCap_Telemetry *tel, uint32_t count, uint16_t window)
+{
+    uint32_t n = window;
+    uint32_t failures = 0;
+    uint32_t i;
+    double sum = 0.0;
+    int16_t lo = 32767;
+    int16_t hi = -32768;
+    fp32 avg, rate, min, max;
+
+    if (n > SUPERCAP_TELEMETRY_SIZE) {
+        n = SUPERCAP_TELEMETRY_SIZE;
+    }
+    if (n > count) {
+        n = count;
+    }
+
+    avg = SuperCapTelemetryAvgPower(tel, window);
+    rate = SuperCapTelemetryEnergyRate(tel, window);
+    if (SuperCapTelemetryPowerRange(tel, window, &min, &max) != (n != 0)) {
+        return tel_fail(count, window, "range return", 0.0, n != 0);
+    }
+    if (n == 0) {
+        return avg != 0.0f ? tel_fail(count, window, "avg", avg, 0.0) : 0;
+    }
+
+    for (i = count - n; i < count; i++) {
+        sum += shadow_power[i];
+        lo = shadow_power[i] < lo ? shadow_power[i] : lo;
+        hi = shadow_power[i] > hi ? shadow_power[i] : hi;
+    }
+    sum = sum * 0.1 / n;
+    if (fabs(avg - sum) > 1e-3 + fabs(sum) * 1e-5) {
+        failures += tel_fail(count, window, "avg", avg, sum);
+    }
+    if (min != (fp32)lo * 0.1f || max != (fp32)hi * 0.1f) {
+        failures += tel_fail(count, window, "min", min, lo * 0.1);
+        failures += tel_fail(count, window, "max", max, hi * 0.1);
+    }
+    if (n >= 2) {
+        uint32_t dt = shadow_tick[count - 1] - shadow_tick[count - n];
+        double expect = dt == 0 ? 0.0 :
+                        ((double)shadow_energy[count - 1] - (double)shadow_energy[count - n]) * 100.0 / dt;
+
+        if (fabs(rate - expect) > 1e-3 + fabs(expect) * 1e-5) {
+            failures += tel_fail(count, window, "dE/dt", rate, expect);
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief 暴力检查
+ */
+static uint32_t tel_check(void)
+{
+    const SuperCap_Telemetry *tel = SuperCapTelemetryGet(0);
+    SuperCap_Msg_get cap;
+    fp32 power = 50.0f;
+    uint8_t energy = 128;
+    uint32_t tick = 0;
+    uint32_t failures = 0;
+    uint32_t f;
+    uint8_t i;
+
+    memset(&cap, 0, sizeof(cap));
+    for (i = 0; i < sizeof(tel_check_registered) / sizeof(tel_check_registered[0]); i++) {
+        if (SuperCapTelemetryRangeRegister(tel_check_registered[i]) != 0) {
+            fprintf(stderr, "register window %u failed\n", tel_check_registered[i]);
+            failures++;
+        }
+    }
+    if (SuperCapTelemetryRangeRegister(0) == 0 || SuperCapTelemetryRangeRegister(SUPERCAP_TELEMETRY_SIZE + 1) == 0) {
+        fprintf(stderr, "out of range window registered\n");
+        failures++;
+    }
+
+    for (f = 0; f < TEL_CHECK_FRAMES && failures < 20; f++) {
+        tel_gen(&cap, &power, &energy, &tick);
+        shadow_power[f] = tel_power_dw(cap.chassisPower);
+        shadow_energy[f] = SUPERCAP_USABLE_ENERGY_DJ(cap.capEnergy);
+        shadow_tick[f] = tick;
+        SuperCapTelemetryPush(0, &cap, tick);
+
+        if (f == TEL_CHECK_REGISTER_AT && SuperCapTelemetryRangeRegister(TEL_CHECK_LATE_WINDOW) != 0) {
+            fprintf(stderr, "late register failed\n");
+            failures++;
+        }
+        for (i = 0; i < sizeof(tel_check_windows) / sizeof(tel_check_windows[0]); i++) {
+            failures += tel_check_window(tel, f + 1, tel_check_windows[i]);
+        }
+    }
+
+    printf("telemetry: %lu frames x %u windows, %lu failures\n", (unsigned long)f,
+           (unsigned)(sizeof(tel_check_windows) / sizeof(tel_check_windows[0])), (unsigned long)failures);
+    return failures;
+}
+
+static uint64_t tel_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// 使用者各自的窗口缓冲
+typedef struct
+{
+    fp32 power[TEL_BENCH_WINDOW];
+    uint16_t energy[TEL_BENCH_WINDOW];
+    uint32_t tick[TEL_BENCH_WINDOW];
+    uint32_t count;
+} tel_consumer_t;
+
+/**
+ * @brief 耗时对比
+ */
+static void tel_bench(void)
+{
+    static tel_consumer_t consumer[TEL_BENCH_CONSUMERS];
+    static SuperCap_Msg_get frames[4096];
+    const SuperCap_Telemetry *tel = SuperCapTelemetryGet(1);
+    volatile fp32 sink = 0.0f;
+    fp32 power = 50.0f;
+    uint8_t energy = 128;
+    uint32_t tick = 0;
+    uint64_t start, scalar_ns, tel_ns_total;
+    uint32_t f, i, k;
+
+    SuperCapTelemetryRangeRegister(TEL_BENCH_WINDOW);
+    for (f = 0; f < sizeof(frames) / sizeof(frames[0]); f++) {
+        tel_gen(&frames[f], &power, &energy, &tick);
+    }
+
+    start = tel_ns();
+    for (f = 0; f < TEL_CHECK_FRAMES; f++) {
+        const SuperCap_Msg_get *cap = &frames[f & 4095];
+
+        for (k = 0; k < TEL_BENCH_CONSUMERS; k++) {
+            tel_consumer_t *c = &consumer[k];
+            uint32_t pos = c->count % TEL_BENCH_WINDOW;
+            uint32_t n = c->count + 1 < TEL_BENCH_WINDOW ? c->count + 1 : TEL_BENCH_WINDOW;
+            uint32_t oldest = (c->count + 1 - n) % TEL_BENCH_WINDOW;
+            fp32 sum = 0.0f, lo = 1e9f, hi = -1e9f;
+
+            c->power[pos] = cap->chassisPower;
+            c->energy[pos] = SUPERCAP_USABLE_ENERGY_DJ(cap->capEnergy);
+            c->tick[pos] = f * 10;
+            c->count++;
+            for (i = 0; i < n; i++) {
+                fp32 p = c->power[i];
+                sum += p;
+                lo = p < lo ? p : lo;
+                hi = p > hi ? p : hi;
+            }
+            sink = sum / (fp32)n + lo + hi;
+            if (c->tick[pos] != c->tick[oldest]) {
+                sink = (fp32)(c->energy[pos] - c->energy[oldest]) * 100.0f / (fp32)(c->tick[pos] - c->tick[oldest]);
+            }
+        }
+    }
+    scalar_ns = tel_ns() - start;
+
+    start = tel_ns();
+    for (f = 0; f < TEL_CHECK_FRAMES; f++) {
+        fp32 lo, hi;
+
+        SuperCapTelemetryPush(1, &frames[f & 4095], f * 10);
+        for (k = 0; k < TEL_BENCH_CONSUMERS; k++) {
+            sink = SuperCapTelemetryAvgPower(tel, TEL_BENCH_WINDOW);
+            sink = SuperCapTelemetryEnergyRate(tel, TEL_BENCH_WINDOW);
+            SuperCapTelemetryPowerRange(tel, TEL_BENCH_WINDOW, &lo, &hi);
+            sink = lo + hi;
+        }
+    }
+    tel_ns_total = tel_ns() - start;
+    (void)sink;
+
+    printf("bench: %u consumers, window %u: per-consumer scalar %.0f ns/frame, telemetry %.0f ns/frame\n",
+           TEL_BENCH_CONSUMERS, TEL_BENCH_WINDOW, (double)scalar_ns / TEL_CHECK_FRAMES,
+           (double)tel_ns_total / TEL_CHECK_FRAMES);
+}
+
+int main(void)
+{
+    uint32_t failures = tel_check();
+
+    tel_bench();
+    return failures != 0;
+}